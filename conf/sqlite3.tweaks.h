@@ -1 +1,2 @@
 #define SQLITE_ENABLE_COLUMN_METADATA 1
+#define SQLITE_ENABLE_SNAPSHOT 1
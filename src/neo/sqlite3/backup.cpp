@@ -0,0 +1,78 @@
+#include "./backup.hpp"
+
+#include <neo/sqlite3/error.hpp>
+
+#include <neo/event.hpp>
+
+#include <sqlite3/sqlite3.h>
+
+#include <thread>
+
+using namespace neo::sqlite3;
+
+backup::~backup() {
+    if (_ptr) {
+        ::sqlite3_backup_finish(std::exchange(_ptr, nullptr));
+    }
+}
+
+errable<backup>
+backup::start(connection_ref dest, connection_ref source, backup_options opts) noexcept {
+    auto ptr = ::sqlite3_backup_init(dest.c_ptr(),
+                                     opts.dest_schema.data(),
+                                     source.c_ptr(),
+                                     opts.source_schema.data());
+    if (!ptr) {
+        // The error is recorded on the destination connection
+        return {errc{::sqlite3_extended_errcode(dest.c_ptr())}, "Failed to begin a backup", dest};
+    }
+    return backup{ptr, source.c_ptr(), std::move(opts)};
+}
+
+errable<backup>
+backup::start(neo::zstring_view dest_path, connection_ref source, backup_options opts) noexcept {
+    NEO_SQLITE3_AUTO(dest, connection::open(dest_path));
+    auto bk = start(dest, source, std::move(opts));
+    if (bk.is_error()) {
+        // The error cannot refer to the destination connection, which is closed on return
+        return {bk.errc(), "Failed to begin a backup"};
+    }
+    bk->_dest_owner.emplace(std::move(dest));
+    return bk;
+}
+
+errable<void> backup::step() noexcept {
+    auto rc = errc{::sqlite3_backup_step(_ptr, _opts.pages_per_step)};
+    if (rc != errc::ok && rc != errc::done) {
+        return {rc, "Failed to copy pages of a backup"};
+    }
+    return rc;
+}
+
+errable<void> backup::run() noexcept {
+    connection_ref source{_source};
+    while (true) {
+        auto res = step();
+        if (res.errc() == errc::done) {
+            neo::emit(event::backup_progress{source, remaining(), page_count()});
+            return errc::ok;
+        }
+        auto cond = error_code_condition(res.errc());
+        if (res.is_error() && cond != errcond::busy && cond != errcond::locked) {
+            return res;
+        }
+        if (!res.is_error()) {
+            neo::emit(event::backup_progress{source, remaining(), page_count()});
+        }
+        if (_opts.step_delay.count() > 0) {
+            std::this_thread::sleep_for(_opts.step_delay);
+        } else if (res.is_error()) {
+            // Give the connection that holds the lock a chance to finish
+            std::this_thread::sleep_for(std::chrono::milliseconds{1});
+        }
+    }
+}
+
+int backup::remaining() const noexcept { return ::sqlite3_backup_remaining(_ptr); }
+
+int backup::page_count() const noexcept { return ::sqlite3_backup_pagecount(_ptr); }
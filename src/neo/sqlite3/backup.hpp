@@ -0,0 +1,125 @@
+#pragma once
+
+#include <neo/sqlite3/connection.hpp>
+
+#include <chrono>
+#include <optional>
+#include <string>
+#include <utility>
+
+struct sqlite3_backup;
+
+namespace neo::sqlite3 {
+
+/**
+ * @brief Options for an online backup.
+ */
+struct backup_options {
+    /// The number of pages to copy in each step. If negative, copies every page in a single step
+    int pages_per_step = 256;
+    /**
+     * @brief The time to sleep between steps. The source database is only locked while a step is
+     * running, so this allows other connections to write to it during the backup, and caps the
+     * I/O bandwidth used by the backup at roughly (pages_per_step × page_size) / step_delay.
+     */
+    std::chrono::microseconds step_delay{0};
+    /// The database to copy from the source connection
+    std::string source_schema = "main";
+    /// The database to replace on the destination connection
+    std::string dest_schema = "main";
+};
+
+namespace event {
+
+/**
+ * @brief Fired by backup::run() after each step of a backup
+ */
+struct backup_progress {
+    connection_ref& source;
+    /// The number of pages that are yet to be copied
+    int remaining;
+    /// The total number of pages in the source database
+    int page_count;
+};
+
+}  // namespace event
+
+/**
+ * @brief An incremental online backup of a database, wrapping the sqlite3_backup_* APIs.
+ *
+ * The backup copies the source database into the destination in steps of a few pages at a
+ * time. The source is only read-locked during each step, so other connections may continue to
+ * use it between steps. If the source is modified by another connection, the backup restarts
+ * automatically. (Modifications made through the source connection itself are copied into the
+ * backup without restarting it.)
+ *
+ * The destination connection must not be used while the backup is in progress.
+ */
+class backup {
+    ::sqlite3_backup*         _ptr = nullptr;
+    std::optional<connection> _dest_owner;
+    ::sqlite3*                _source = nullptr;
+    backup_options            _opts;
+
+    backup(::sqlite3_backup* ptr, ::sqlite3* source, backup_options opts) noexcept
+        : _ptr(ptr)
+        , _source(source)
+        , _opts(std::move(opts)) {}
+
+public:
+    ~backup();
+
+    backup(backup&& o) noexcept
+        : _ptr(std::exchange(o._ptr, nullptr))
+        , _dest_owner(std::move(o._dest_owner))
+        , _source(o._source)
+        , _opts(std::move(o._opts)) {}
+
+    backup& operator=(backup&& o) noexcept {
+        std::swap(_ptr, o._ptr);
+        std::swap(_dest_owner, o._dest_owner);
+        std::swap(_source, o._source);
+        std::swap(_opts, o._opts);
+        return *this;
+    }
+
+    /**
+     * @brief Begin a backup of the source database into the database of another connection.
+     */
+    [[nodiscard]] static errable<backup>
+    start(connection_ref dest, connection_ref source, backup_options opts = {}) noexcept;
+
+    /**
+     * @brief Begin a backup of the source database into a file, which is created if it does not
+     * exist, and is replaced if it does.
+     */
+    [[nodiscard]] static errable<backup>
+    start(neo::zstring_view dest_path, connection_ref source, backup_options opts = {}) noexcept;
+
+    [[nodiscard]] ::sqlite3_backup* c_ptr() const noexcept { return _ptr; }
+
+    /**
+     * @brief Copy the next batch of pages.
+     *
+     * @return errc::ok if there are more pages to copy, errc::done if the backup is complete.
+     * If the source database is locked by another connection, returns an error of the `busy` or
+     * `locked` condition, and the step may be retried.
+     */
+    errable<void> step() noexcept;
+
+    /**
+     * @brief Run steps until the backup is complete, sleeping for `step_delay` between each step,
+     * and firing an event::backup_progress after each.
+     *
+     * If the source is busy or locked, the step is retried after sleeping. Returns the first
+     * other error.
+     */
+    errable<void> run() noexcept;
+
+    /// The number of pages that have yet to be copied, as of the most recent step
+    [[nodiscard]] int remaining() const noexcept;
+    /// The total number of pages in the source database, as of the most recent step
+    [[nodiscard]] int page_count() const noexcept;
+};
+
+}  // namespace neo::sqlite3
@@ -0,0 +1,62 @@
+#include <neo/sqlite3/backup.hpp>
+#include <neo/sqlite3/error.hpp>
+#include <neo/sqlite3/exec.hpp>
+
+#include "./tests.inl"
+
+TEST_CASE_METHOD(sqlite3_memory_db_fixture, "Back up a database in steps") {
+    db.exec(R"(
+        CREATE TABLE foo (a INTEGER PRIMARY KEY, b BLOB);
+        WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < 100)
+        INSERT INTO foo SELECT i, randomblob(1000) FROM n;
+    )")
+        .throw_if_error();
+    auto count_rows = [](neo::sqlite3::connection_ref c) {
+        return *neo::sqlite3::one_cell<int>(*c.prepare("SELECT count(*) FROM foo"));
+    };
+
+    SECTION("Into another connection") {
+        auto dest    = *neo::sqlite3::create_memory_db();
+        auto bk      = *neo::sqlite3::backup::start(dest, db, {.pages_per_step = 4});
+        int  n_steps = 0;
+        while (true) {
+            auto res = bk.step();
+            REQUIRE_FALSE(res.is_error());
+            ++n_steps;
+            CHECK(bk.remaining() < bk.page_count());
+            if (res.errc() == neo::sqlite3::errc::done) {
+                break;
+            }
+        }
+        CHECK(bk.remaining() == 0);
+        CHECK(n_steps == (bk.page_count() + 3) / 4);
+        CHECK(count_rows(dest) == 100);
+    }
+
+    SECTION("Into a file") {
+        sqlite3_temp_db_fixture tmp;
+        const auto&             path = tmp.path;
+        {
+            auto bk = *neo::sqlite3::backup::start(path.string(),
+                                                   db,
+                                                   {
+                                                       .pages_per_step = 8,
+                                                       .step_delay = std::chrono::microseconds{10},
+                                                   });
+            bk.run().throw_if_error();
+            CHECK(bk.remaining() == 0);
+        }
+        auto copy = *neo::sqlite3::open(path.string());
+        CHECK(count_rows(copy) == 100);
+    }
+
+    SECTION("Invalid backups") {
+        CHECK(neo::sqlite3::backup::start(db, db).is_error());
+        auto dest = *neo::sqlite3::create_memory_db();
+        CHECK(neo::sqlite3::backup::start(dest, db, {.source_schema = "nonesuch"}).is_error());
+        // The destination is closed when the backup fails to start
+        auto res = neo::sqlite3::backup::start(":memory:", db, {.source_schema = "nonesuch"});
+        REQUIRE(res.is_error());
+        CHECK_THROWS_AS(res.throw_error(), neo::sqlite3::error);
+    }
+}
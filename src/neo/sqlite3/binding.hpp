@@ -12,6 +12,8 @@
 #include <neo/zstring_view.hpp>
 
 #include <cstdint>
+#include <span>
+#include <string>
 #include <string_view>
 #include <tuple>
 
@@ -44,6 +46,55 @@ struct zeroblob {
     std::size_t size = 0;
 };
 
+/**
+ * @brief Binding placeholder that binds a contiguous array of values as a single parameter.
+ *
+ * The bound parameter must be passed to the `carray()` table-valued function (registered with
+ * `register_carray()`), e.g. `SELECT * FROM t WHERE id IN carray(?)`.
+ *
+ * The array is NOT copied: The referred-to elements must remain valid until the statement is reset
+ * or the parameter is re-bound.
+ */
+class carray {
+public:
+    enum class element_type {
+        int64,
+        real,
+        text_view,
+        text,
+    };
+
+private:
+    const void*  _data = nullptr;
+    std::size_t  _size = 0;
+    element_type _type = element_type::int64;
+
+public:
+    carray(std::span<const std::int64_t> s) noexcept
+        : _data(s.data())
+        , _size(s.size())
+        , _type(element_type::int64) {}
+
+    carray(std::span<const double> s) noexcept
+        : _data(s.data())
+        , _size(s.size())
+        , _type(element_type::real) {}
+
+    carray(std::span<const std::string_view> s) noexcept
+        : _data(s.data())
+        , _size(s.size())
+        , _type(element_type::text_view) {}
+
+    carray(std::span<const std::string> s) noexcept
+        : _data(s.data())
+        , _size(s.size())
+        , _type(element_type::text) {}
+
+    [[nodiscard]] const void*  data() const noexcept { return _data; }
+    [[nodiscard]] std::size_t  size() const noexcept { return _size; }
+    [[nodiscard]] element_type type() const noexcept { return _type; }
+};
+
 namespace detail {
 
 // clang-format off
@@ -54,6 +105,7 @@ concept base_bindable =
     alike<T, null_t> ||
     alike<T, zeroblob> ||
     alike<T, blob_view> ||
+    alike<T, carray> ||
     alike<T, const char*> ||
     neo::text_range<T>;
 
@@ -165,6 +217,9 @@ public:
         return rc;
     }
 
+    /// Bind an array for use with the carray() table-valued function. Implemented in carray.cpp
+    errable<void> bind_carray(carray arr) noexcept;
+
     template <bindable T>
     errable<void> bind(const T& value) noexcept {
         if constexpr (std::floating_point<T>) {
@@ -181,6 +236,8 @@ public:
             return bind_zeroblob(value);
         } else if constexpr (same_as<T, blob_view>) {
             return bind_blob_view(value);
+        } else if constexpr (same_as<T, carray>) {
+            return bind_carray(value);
         } else if constexpr (detail::detect_optional<T>) {
             if (!value.has_value()) {
                 return bind_null();
@@ -262,8 +319,12 @@ private:
     }
 
     template <typename Tuple, std::size_t... Is>
-    errable<void> _assign_tup(const Tuple& tup, std::index_sequence<Is...>) {
-        return bind_all(std::get<Is>(tup)...);
+    errable<void> _assign_tup(int first, const Tuple& tup, std::index_sequence<Is...>) {
+        if constexpr (sizeof...(Is)) {
+            return bind_next(first, std::get<Is>(tup)...);
+        } else {
+            return errc::ok;
+        }
     }
 
     template <typename H, typename... Tail>
@@ -308,7 +369,7 @@ public:
 
     template <bindable_tuple Tuple, std::size_t S = std::tuple_size_v<std::decay_t<Tuple>>>
     Tuple&& operator=(Tuple&& tup) {
-        _assign_tup(tup, std::make_index_sequence<S>()).throw_if_error();
+        _assign_tup(1, tup, std::make_index_sequence<S>()).throw_if_error();
         return NEO_FWD(tup);
     }
 
@@ -323,7 +384,16 @@ public:
 
     template <bindable_tuple Tuple, std::size_t S = std::tuple_size_v<std::decay_t<Tuple>>>
     errable<void> bind_tuple(const Tuple& tup) noexcept {
-        return _assign_tup(tup, std::make_index_sequence<S>());
+        return _assign_tup(1, tup, std::make_index_sequence<S>());
+    }
+
+    /**
+     * @brief Bind the elements of the tuple to consecutive parameters, beginning at the 1-based
+     * index 'first'
+     */
+    template <bindable_tuple Tuple, std::size_t S = std::tuple_size_v<std::decay_t<Tuple>>>
+    errable<void> bind_tuple(int first, const Tuple& tup) noexcept {
+        return _assign_tup(first, tup, std::make_index_sequence<S>());
     }
 };
 
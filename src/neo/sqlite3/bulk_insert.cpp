@@ -0,0 +1,112 @@
+#include "./bulk_insert.hpp"
+
+#include <sqlite3/sqlite3.h>
+
+#include <algorithm>
+#include <cctype>
+
+using namespace neo::sqlite3;
+
+namespace {
+
+bool is_space(char c) noexcept { return std::isspace(static_cast<unsigned char>(c)) != 0; }
+
+std::string_view trim(std::string_view s) noexcept {
+    while (!s.empty() && is_space(s.front())) {
+        s.remove_prefix(1);
+    }
+    while (!s.empty() && (is_space(s.back()) || s.back() == ';')) {
+        s.remove_suffix(1);
+    }
+    return s;
+}
+
+bool starts_with_keyword(std::string_view s, std::string_view kw) noexcept {
+    if (s.size() < kw.size()
+        || ::sqlite3_strnicmp(s.data(), kw.data(), static_cast<int>(kw.size())) != 0) {
+        return false;
+    }
+    return s.size() == kw.size() || !std::isalnum(static_cast<unsigned char>(s[kw.size()]));
+}
+
+/**
+ * @brief Count the parameters in a VALUES row of the form `(?, ?, ...)`, or return zero if the row
+ * contains anything else.
+ */
+int count_anonymous_params(std::string_view row) noexcept {
+    int  n_params     = 0;
+    bool expect_param = true;
+    for (auto c : row.substr(1, row.size() - 2)) {
+        if (is_space(c)) {
+            continue;
+        }
+        if (c != (expect_param ? '?' : ',')) {
+            return 0;
+        }
+        n_params += expect_param;
+        expect_param = !expect_param;
+    }
+    // A trailing comma is not valid
+    return expect_param ? 0 : n_params;
+}
+
+}  // namespace
+
+detail::bulk_insert_plan detail::plan_bulk_insert(connection_ref   db,
+                                                  std::string_view sql,
+                                                  int              n_columns,
+                                                  std::size_t      max_rows) {
+    bulk_insert_plan plan;
+    sql = trim(sql);
+    if (max_rows < 2 || n_columns < 1
+        || !(starts_with_keyword(sql, "INSERT") || starts_with_keyword(sql, "REPLACE"))
+        || !sql.ends_with(')')) {
+        return plan;
+    }
+    auto open = sql.rfind('(');
+    auto row  = sql.substr(open);
+    if (count_anonymous_params(row) != n_columns) {
+        return plan;
+    }
+    // The row must be the only row that follows VALUES
+    auto head = sql.substr(0, open);
+    while (!head.empty() && is_space(head.back())) {
+        head.remove_suffix(1);
+    }
+    constexpr std::string_view values_kw = "VALUES";
+    if (head.size() <= values_kw.size()) {
+        return plan;
+    }
+    auto kw_pos = head.size() - values_kw.size();
+    if (!starts_with_keyword(head.substr(kw_pos), values_kw)) {
+        return plan;
+    }
+    auto before_kw = head[kw_pos - 1];
+    if (!is_space(before_kw) && before_kw != ')') {
+        return plan;
+    }
+
+    auto c_db = db.c_ptr();
+    auto var_limit
+        = static_cast<std::size_t>(::sqlite3_limit(c_db, SQLITE_LIMIT_VARIABLE_NUMBER, -1));
+    auto len_limit = static_cast<std::size_t>(::sqlite3_limit(c_db, SQLITE_LIMIT_SQL_LENGTH, -1));
+    auto n_rows    = std::min(max_rows, var_limit / static_cast<std::size_t>(n_columns));
+    if (head.size() < len_limit) {
+        n_rows = std::min(n_rows, (len_limit - head.size()) / (row.size() + 1));
+    }
+    if (n_rows < 2) {
+        return plan;
+    }
+
+    plan.multi_row_sql.reserve(head.size() + 1 + n_rows * (row.size() + 1));
+    plan.multi_row_sql.append(head);
+    plan.multi_row_sql.push_back(' ');
+    for (auto i = 0u; i < n_rows; ++i) {
+        if (i != 0) {
+            plan.multi_row_sql.push_back(',');
+        }
+        plan.multi_row_sql.append(row);
+    }
+    plan.rows_per_statement = n_rows;
+    return plan;
+}
@@ -0,0 +1,176 @@
+#pragma once
+
+#include <neo/sqlite3/connection_ref.hpp>
+#include <neo/sqlite3/exec.hpp>
+#include <neo/sqlite3/statement.hpp>
+#include <neo/sqlite3/transaction.hpp>
+
+#include <neo/range_concepts.hpp>
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+namespace neo::sqlite3 {
+
+/**
+ * @brief Options for bulk_insert()
+ */
+struct bulk_insert_options {
+    /// The number of rows that are inserted by each transaction
+    std::size_t rows_per_transaction = 10'000;
+    /**
+     * @brief The maximum number of rows to insert with each execution of a statement. If greater
+     * than one, the statement is rewritten to insert multiple rows at once (if possible).
+     */
+    std::size_t rows_per_statement = 64;
+    /// The mode of each transaction
+    transaction_mode mode = transaction_mode::immediate;
+};
+
+namespace detail {
+
+struct bulk_insert_plan {
+    /// A statement that inserts `rows_per_statement` rows at once, if such a rewrite is possible
+    std::string multi_row_sql;
+    std::size_t rows_per_statement = 1;
+};
+
+/**
+ * @brief Attempt to rewrite an `INSERT ... VALUES (?, ...)` statement into a statement that
+ * inserts up to `max_rows` rows, while respecting the variable and length limits of the
+ * connection.
+ *
+ * The statement can only be rewritten if it ends with a single VALUES row that contains only
+ * anonymous `?` parameters, and the number of parameters is `n_columns`. Otherwise, the returned
+ * plan inserts one row per statement.
+ */
+[[nodiscard]] bulk_insert_plan
+plan_bulk_insert(connection_ref db, std::string_view sql, int n_columns, std::size_t max_rows);
+
+}  // namespace detail
+
+/**
+ * @brief Insert every tuple of bindings in the given range, in chunked transactions.
+ *
+ * Like exec_each(), executes the given statement once for each tuple in `rows`. Unlike
+ * exec_each(), every `rows_per_transaction` rows are wrapped in a transaction (If a transaction
+ * is already active, all rows are part of that transaction instead).
+ *
+ * If the statement is of the form `INSERT INTO ... VALUES (?, ?, ...)`, it will be rewritten as
+ * `INSERT INTO ... VALUES (?, ?, ...), (?, ?, ...), ...` to insert several rows with each
+ * execution, which greatly reduces per-row overhead. Rows are copied into a small buffer until
+ * there are enough to execute the multi-row statement, so any views within the tuples must remain
+ * valid until the whole range has been consumed.
+ *
+ * If an error occurs, the current transaction is rolled back (if this function began it), but
+ * transactions that were already committed are kept.
+ *
+ * @param db The connection on which to insert
+ * @param sql The statement to execute for each row
+ * @param rows A range of tuples. The tuple type must meet `bindable_tuple`
+ * @return The number of rows that were inserted
+ */
+template <ranges::input_range Rows>
+requires bindable_tuple<ranges::range_value_t<Rows>>  //
+    errable<std::size_t> bulk_insert(connection_ref             db,
+                                     std::string_view           sql,
+                                     Rows&&                     rows,
+                                     const bulk_insert_options& opts = {}) {
+    using tuple_type     = ranges::range_value_t<Rows>;
+    constexpr int n_cols = static_cast<int>(std::tuple_size_v<std::remove_cvref_t<tuple_type>>);
+
+    auto plan = detail::plan_bulk_insert(db, sql, n_cols, opts.rows_per_statement);
+    NEO_SQLITE3_AUTO(single, db.prepare(sql));
+    std::optional<statement> multi;
+    if (plan.rows_per_statement > 1) {
+        NEO_SQLITE3_AUTO(st, db.prepare(plan.multi_row_sql));
+        multi.emplace(std::move(st));
+    }
+
+    std::optional<recursive_transaction_guard> tr;
+    std::size_t                                n_inserted = 0;
+    std::size_t                                n_in_tr    = 0;
+
+    auto fail = [&](errable<void> err) {
+        if (tr) {
+            tr->rollback();
+        }
+        return err.error();
+    };
+    // Call before each execution of a statement
+    auto begin = [&] {
+        if (!tr) {
+            tr.emplace(db, opts.mode);
+        }
+    };
+    // Call after each execution of a statement
+    auto finish = [&](std::size_t n_rows) {
+        n_inserted += n_rows;
+        n_in_tr += n_rows;
+        if (n_in_tr >= opts.rows_per_transaction) {
+            tr->commit();
+            tr.reset();
+            n_in_tr = 0;
+        }
+    };
+
+    if (!multi) {
+        for (auto&& row : rows) {
+            begin();
+            auto res = exec(single, row);
+            if (res.is_error()) {
+                return fail(res);
+            }
+            finish(1);
+        }
+        if (tr) {
+            tr->commit();
+        }
+        return n_inserted;
+    }
+
+    std::vector<std::remove_cvref_t<tuple_type>> buffer;
+    buffer.reserve(plan.rows_per_statement);
+    for (auto&& row : rows) {
+        buffer.emplace_back(row);
+        if (buffer.size() < plan.rows_per_statement) {
+            continue;
+        }
+        begin();
+        multi->reset();
+        auto param = 1;
+        for (auto& buffered : buffer) {
+            auto res = multi->bindings().bind_tuple(param, buffered);
+            if (res.is_error()) {
+                return fail(res);
+            }
+            param += n_cols;
+        }
+        auto res = multi->run_to_completion();
+        if (res.is_error()) {
+            return fail(res);
+        }
+        finish(buffer.size());
+        buffer.clear();
+    }
+    // Insert the remainder one at a time
+    for (auto& buffered : buffer) {
+        begin();
+        auto res = exec(single, buffered);
+        if (res.is_error()) {
+            return fail(res);
+        }
+        finish(1);
+    }
+    if (tr) {
+        tr->commit();
+    }
+    return n_inserted;
+}
+
+}  // namespace neo::sqlite3
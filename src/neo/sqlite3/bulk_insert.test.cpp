@@ -0,0 +1,79 @@
+#include <neo/sqlite3/bulk_insert.hpp>
+
+#include "./tests.inl"
+
+#include <sqlite3/sqlite3.h>
+
+#include <string>
+#include <tuple>
+#include <vector>
+
+TEST_CASE_METHOD(sqlite3_memory_db_fixture, "Rewrite inserts into multi-row inserts") {
+    auto plan = neo::sqlite3::detail::plan_bulk_insert(db, "INSERT INTO foo VALUES (?, ?);", 2, 3);
+    CHECK(plan.rows_per_statement == 3);
+    CHECK(plan.multi_row_sql == "INSERT INTO foo VALUES (?, ?),(?, ?),(?, ?)");
+
+    plan = neo::sqlite3::detail::plan_bulk_insert(db, "insert into foo(a, b)values(?,?)", 2, 2);
+    CHECK(plan.multi_row_sql == "insert into foo(a, b)values (?,?),(?,?)");
+
+    auto not_rewritten = [&](std::string_view sql) {
+        return neo::sqlite3::detail::plan_bulk_insert(db, sql, 2, 64).rows_per_statement == 1;
+    };
+    CHECK(not_rewritten("INSERT INTO foo VALUES (?, ?) ON CONFLICT DO NOTHING"));
+    CHECK(not_rewritten("INSERT INTO foo VALUES (:a, :b)"));
+    CHECK(not_rewritten("INSERT INTO foo VALUES (?, 2)"));
+    CHECK(not_rewritten("INSERT INTO foo VALUES (?, ?, ?)"));
+    CHECK(not_rewritten("INSERT INTO foo VALUES (1, 2), (?, ?)"));
+    CHECK(not_rewritten("INSERT INTO foo SELECT * FROM bar WHERE baz IN (?, ?)"));
+    CHECK(not_rewritten("UPDATE foo SET (a, b) = (?, ?)"));
+
+    // The number of rows is limited by the number of variables per statement
+    ::sqlite3_limit(db.c_ptr(), SQLITE_LIMIT_VARIABLE_NUMBER, 10);
+    plan = neo::sqlite3::detail::plan_bulk_insert(db, "INSERT INTO foo VALUES (?, ?)", 2, 64);
+    CHECK(plan.rows_per_statement == 5);
+}
+
+TEST_CASE_METHOD(sqlite3_memory_db_fixture, "Bulk insert") {
+    db.exec("CREATE TABLE foo (a INTEGER UNIQUE, b TEXT)").throw_if_error();
+    std::vector<std::tuple<int, std::string>> rows;
+    for (auto i = 0; i < 1000; ++i) {
+        rows.emplace_back(i, std::to_string(i));
+    }
+    auto sum = [&] {
+        return *neo::sqlite3::one_cell<int>(*db.prepare("SELECT total(a) FROM foo"));
+    };
+    auto count = [&] {
+        return *neo::sqlite3::one_cell<int>(*db.prepare("SELECT count(*) FROM foo"));
+    };
+
+    std::string sql
+        = GENERATE("INSERT INTO foo VALUES (?, ?)", "INSERT INTO foo (b, a) SELECT ?2, ?1");
+    auto n = neo::sqlite3::bulk_insert(db, sql, rows, {.rows_per_transaction = 100});
+    CHECK(*n == 1000);
+    CHECK(count() == 1000);
+    CHECK(sum() == 499500);
+    CHECK(*neo::sqlite3::one_cell<std::string>(*db.prepare("SELECT b FROM foo WHERE a = 999"))
+          == "999");
+    CHECK_FALSE(db.is_transaction_active());
+
+    // A failure rolls back only the current transaction
+    db.exec("DELETE FROM foo").throw_if_error();
+    rows[150] = rows[0];
+    auto res  = neo::sqlite3::bulk_insert(db,
+                                         sql,
+                                         rows,
+                                         {.rows_per_transaction = 100, .rows_per_statement = 10});
+    CHECK(res.errc() == neo::sqlite3::errc::constraint_unique);
+    CHECK(count() == 100);
+    CHECK_FALSE(db.is_transaction_active());
+
+    // Within an existing transaction, nothing is committed
+    db.exec("DELETE FROM foo").throw_if_error();
+    {
+        neo::sqlite3::transaction_guard tr{db};
+        res = neo::sqlite3::bulk_insert(db, sql, rows, {.rows_per_transaction = 100});
+        CHECK(res.is_error());
+        tr.rollback();
+    }
+    CHECK(count() == 0);
+}
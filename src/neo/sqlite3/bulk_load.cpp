@@ -0,0 +1,201 @@
+#include "./bulk_load.hpp"
+
+#include <neo/sqlite3/connection_ref.hpp>
+#include <neo/sqlite3/error.hpp>
+#include <neo/sqlite3/exec.hpp>
+#include <neo/sqlite3/identifier.hpp>
+#include <neo/sqlite3/transaction.hpp>
+
+#include <neo/assert.hpp>
+#include <neo/event.hpp>
+#include <neo/ufmt.hpp>
+
+#include <cstdio>
+#include <exception>
+
+using namespace neo::sqlite3;
+
+namespace {
+
+void set_pragmas(connection_ref     db,
+                 const std::string& journal_mode,
+                 int                synchronous,
+                 std::int64_t       cache_size) {
+    // Neither can be changed within a transaction, so they are then left as-is
+    if (!db.is_transaction_active()) {
+        db.exec(neo::ufmt("PRAGMA journal_mode = {}", quote_identifier(journal_mode)))
+            .throw_if_error();
+        db.exec(neo::ufmt("PRAGMA synchronous = {}", synchronous)).throw_if_error();
+    }
+    db.exec(neo::ufmt("PRAGMA cache_size = {}", cache_size)).throw_if_error();
+}
+
+/// Records the indexes that have been dropped by a session, until they are re-created
+constexpr auto deferred_indexes_table = "neo_sqlite3_deferred_indexes";
+
+/// Re-create a dropped index, and remove its record in the same transaction
+void restore_index(connection_ref db, const std::string& name, const std::string& sql) {
+    recursive_transaction_guard tr{db};
+    db.exec(sql).throw_if_error();
+    auto del = *db.prepare(neo::ufmt("DELETE FROM main.{} WHERE name = ?", deferred_indexes_table));
+    exec(del, name).throw_if_error();
+    tr.commit();
+}
+
+/// Drop the table of records once every index has been re-created
+void drop_records_if_empty(connection_ref db) {
+    auto n_left = *one_cell<int>(
+        *db.prepare(neo::ufmt("SELECT count(*) FROM main.{}", deferred_indexes_table)));
+    if (n_left == 0) {
+        db.exec(neo::ufmt("DROP TABLE main.{}", deferred_indexes_table)).throw_if_error();
+    }
+}
+
+}  // namespace
+
+std::size_t bulk_load_session::restore_indexes(connection_ref db) {
+    auto find_records = *db.prepare(
+        "SELECT count(*) FROM main.sqlite_master WHERE type = 'table' AND name = ?");
+    if (*one_cell<int>(find_records, deferred_indexes_table) == 0) {
+        return 0;
+    }
+    auto list_records = *db.prepare(
+        neo::ufmt("SELECT name, sql FROM main.{} ORDER BY seq", deferred_indexes_table));
+    std::vector<std::pair<std::string, std::string>> records;
+    auto rows = *exec_tuples<std::string, std::string>(list_records);
+    for (auto [name, sql] : rows) {
+        records.emplace_back(std::move(name), std::move(sql));
+    }
+    list_records.reset();
+    for (auto& [name, sql] : records) {
+        restore_index(db, name, sql);
+    }
+    drop_records_if_empty(db);
+    return records.size();
+}
+
+bulk_load_session::bulk_load_session(connection_ref db, const bulk_load_options& opts)
+    : _db(db.c_ptr()) {
+    _n_uncaught_exceptions = std::uncaught_exceptions();
+    _journal_mode          = *one_cell<std::string>(*db.prepare("PRAGMA journal_mode"));
+    _synchronous           = *one_cell<int>(*db.prepare("PRAGMA synchronous"));
+    _cache_size            = *one_cell<std::int64_t>(*db.prepare("PRAGMA cache_size"));
+
+    if (!opts.defer_indexes_of.empty()) {
+        // Indexes that were dropped by a session that did not finish
+        restore_indexes(db);
+    }
+
+    // Table names are case-insensitive. Indexes without SQL are created by constraints, and
+    // cannot be dropped
+    auto find_table = *db.prepare(
+        "SELECT count(*) FROM main.sqlite_master WHERE type = 'table' AND name = ? COLLATE NOCASE");
+    auto find_indexes = *db.prepare(
+        "SELECT name, sql FROM main.sqlite_master "
+        "WHERE type = 'index' AND tbl_name = ? COLLATE NOCASE AND sql IS NOT NULL "
+        "ORDER BY name");
+    for (auto& table : opts.defer_indexes_of) {
+        if (*one_cell<int>(find_table, table) == 0) {
+            throw_error(make_error_code(errc::error),
+                        neo::ufmt("Cannot defer the indexes of table '{}'", table),
+                        "The table does not exist in the main schema");
+        }
+        auto rows = *exec_tuples<std::string, std::string>(find_indexes, table);
+        for (auto [name, sql] : rows) {
+            _dropped_indexes.emplace_back(std::move(name), std::move(sql));
+        }
+    }
+
+    try {
+        set_pragmas(db, opts.journal_mode, opts.synchronous, opts.cache_size);
+        if (!_dropped_indexes.empty()) {
+            // Record the indexes in the transaction that drops them, so that they can be restored
+            // if the session is never finished
+            recursive_transaction_guard tr{db};
+            db.exec(neo::ufmt("CREATE TABLE IF NOT EXISTS main.{} "
+                              "(seq INTEGER PRIMARY KEY, name TEXT NOT NULL, sql TEXT NOT NULL)",
+                              deferred_indexes_table))
+                .throw_if_error();
+            auto record = *db.prepare(
+                neo::ufmt("INSERT INTO main.{} (name, sql) VALUES (?, ?)", deferred_indexes_table));
+            for (auto& [name, sql] : _dropped_indexes) {
+                exec(record, name, sql).throw_if_error();
+                db.exec(neo::ufmt("DROP INDEX main.{}", quote_identifier(name))).throw_if_error();
+            }
+            tr.commit();
+        }
+    } catch (...) {
+        _dropped_indexes.clear();
+        set_pragmas(db, _journal_mode, _synchronous, _cache_size);
+        throw;
+    }
+    neo::emit(event::bulk_load_begin{db, _dropped_indexes.size()});
+}
+
+bulk_load_session::~bulk_load_session() noexcept(false) {
+    if (_db == nullptr) {
+        return;
+    }
+    bool is_failing = std::uncaught_exceptions() > _n_uncaught_exceptions;
+    if (is_failing) {
+        try {
+            finish();
+        } catch (const std::exception& e) {
+            std::fputs("An exception occurred while finishing a SQLite bulk load due to another "
+                       "exception. Indexes may be missing from the database!\n",
+                       stderr);
+            std::fputs("The exception message is '", stderr);
+            std::fputs(e.what(), stderr);
+            std::fputs("'\n", stderr);
+        }
+    } else {
+        finish();
+    }
+}
+
+void bulk_load_session::finish() {
+    neo_assert_always(expects,
+                      _db != nullptr,
+                      "bulk_load_session::finish() on an already-finished session");
+    connection_ref db{std::exchange(_db, nullptr)};
+    // Re-create every index that we can, and restore the settings, before throwing the first error
+    std::exception_ptr error;
+    for (auto& [name, sql] : _dropped_indexes) {
+        try {
+            restore_index(db, name, sql);
+        } catch (...) {
+            if (!error) {
+                error = std::current_exception();
+            }
+        }
+    }
+    if (!_dropped_indexes.empty()) {
+        try {
+            drop_records_if_empty(db);
+        } catch (...) {
+            if (!error) {
+                error = std::current_exception();
+            }
+        }
+    }
+    _dropped_indexes.clear();
+    try {
+        set_pragmas(db, _journal_mode, _synchronous, _cache_size);
+    } catch (...) {
+        if (!error) {
+            error = std::current_exception();
+        }
+    }
+    neo::emit(event::bulk_load_finish{db});
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+std::vector<std::string> bulk_load_session::deferred_indexes() const {
+    std::vector<std::string> ret;
+    for (auto& [name, sql] : _dropped_indexes) {
+        ret.push_back(name);
+    }
+    return ret;
+}
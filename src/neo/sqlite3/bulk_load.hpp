@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct sqlite3;
+
+namespace neo::sqlite3 {
+
+class connection_ref;
+
+/**
+ * @brief Options for a bulk_load_session
+ */
+struct bulk_load_options {
+    /**
+     * @brief The `journal_mode` for the duration of the load. Unlike `OFF`, `MEMORY` still
+     * permits ROLLBACK, but the database may be corrupted if the process crashes mid-transaction.
+     */
+    std::string journal_mode = "MEMORY";
+    /// The `synchronous` setting for the duration of the load. (0 = OFF)
+    int synchronous = 0;
+    /// The `cache_size` for the duration of the load. Negative values are in KiB.
+    std::int64_t cache_size = -256 * 1024;
+    /**
+     * @brief Tables in the "main" schema whose indexes will be dropped during the load, and
+     * rebuilt when the load finishes. Indexes that are created by UNIQUE and PRIMARY KEY
+     * constraints cannot be dropped. If a table does not exist, the session throws.
+     */
+    std::vector<std::string> defer_indexes_of;
+};
+
+namespace event {
+
+struct bulk_load_begin {
+    connection_ref& db;
+    /// The number of indexes that were dropped
+    std::size_t n_deferred_indexes;
+};
+
+struct bulk_load_finish {
+    connection_ref& db;
+};
+
+}  // namespace event
+
+/**
+ * @brief Scope-guard that configures a connection for a fast bulk import of data.
+ *
+ * When constructed, records the current `journal_mode`, `synchronous`, and `cache_size` of the
+ * connection, then applies the faster settings given in the bulk_load_options. If requested, the
+ * indexes of the target tables are dropped, so that they can be built in a single pass after the
+ * data has been loaded, rather than being updated for every row.
+ *
+ * When finish() is called or the session is destroyed, the dropped indexes are re-created, and
+ * the original settings are restored. Settings are restored even if re-creating an index fails.
+ *
+ * The dropped indexes are recorded in the table `neo_sqlite3_deferred_indexes`, in the same
+ * transaction that drops them, and each record is removed in the transaction that re-creates its
+ * index. If the process stops before the session finishes (or an index cannot be re-created),
+ * the indexes remain missing until restore_indexes() is called, which the next session that
+ * defers indexes does first. The table is dropped once it is empty.
+ *
+ * If destroyed due to an exception, errors while finishing are reported to stderr and discarded.
+ * Otherwise, errors are thrown as exceptions.
+ *
+ * @note If a transaction is active when the session is created, the indexes are dropped within
+ *       it. The journal mode and `synchronous` cannot be changed while a transaction is active, so
+ *       they are then left as-is. A database in WAL mode can only leave WAL mode if there are no
+ *       other connections to it. If the journal mode cannot be changed, it is silently left
+ *       as-is.
+ */
+class [[nodiscard]] bulk_load_session {
+    int        _n_uncaught_exceptions = 0;
+    ::sqlite3* _db                    = nullptr;
+
+    std::string                                      _journal_mode;
+    int                                              _synchronous = 0;
+    std::int64_t                                     _cache_size  = 0;
+    std::vector<std::pair<std::string, std::string>> _dropped_indexes;
+
+    void _restore();
+
+public:
+    explicit bulk_load_session(connection_ref db, const bulk_load_options& opts = {});
+    ~bulk_load_session() noexcept(false);
+
+    bulk_load_session(bulk_load_session&& other) noexcept
+        : _n_uncaught_exceptions(other._n_uncaught_exceptions)
+        , _db(std::exchange(other._db, nullptr))
+        , _journal_mode(std::move(other._journal_mode))
+        , _synchronous(other._synchronous)
+        , _cache_size(other._cache_size)
+        , _dropped_indexes(std::move(other._dropped_indexes)) {}
+
+    bulk_load_session& operator=(bulk_load_session&&) = delete;
+
+    /// Immediately rebuild the dropped indexes and restore the settings. (Expects: !finished())
+    void finish();
+
+    /// Check whether finish() has been called
+    [[nodiscard]] bool finished() const noexcept { return _db == nullptr; }
+
+    /// The names of the indexes that were dropped, in the order that they will be re-created
+    [[nodiscard]] std::vector<std::string> deferred_indexes() const;
+
+    /**
+     * @brief Re-create the indexes that were dropped by sessions that did not finish. Returns the
+     * number of indexes that were re-created.
+     */
+    static std::size_t restore_indexes(connection_ref db);
+};
+
+}  // namespace neo::sqlite3
@@ -0,0 +1,166 @@
+#include <neo/sqlite3/backup.hpp>
+#include <neo/sqlite3/bulk_load.hpp>
+#include <neo/sqlite3/connection.hpp>
+#include <neo/sqlite3/error.hpp>
+#include <neo/sqlite3/exec.hpp>
+#include <neo/sqlite3/transaction.hpp>
+
+#include "./tests.inl"
+
+#include <chrono>
+#include <filesystem>
+#include <optional>
+#include <ranges>
+#include <stdexcept>
+#include <tuple>
+
+TEST_CASE_METHOD(sqlite3_temp_db_fixture, "Bulk load sessions apply and restore settings") {
+    auto db = *neo::sqlite3::open(path.string());
+    db.exec(R"(
+        PRAGMA journal_mode = WAL;
+        PRAGMA synchronous = FULL;
+        CREATE TABLE foo (a INTEGER PRIMARY KEY, b TEXT UNIQUE, c INTEGER);
+        CREATE UNIQUE INDEX foo_c ON foo (c);
+        CREATE INDEX foo_bc ON foo (b, c);
+        CREATE TABLE bar (d INTEGER);
+        CREATE INDEX bar_d ON bar (d);
+    )")
+        .throw_if_error();
+
+    auto journal_mode = [&] {
+        return *neo::sqlite3::one_cell<std::string>(*db.prepare("PRAGMA journal_mode"));
+    };
+    auto synchronous
+        = [&] { return *neo::sqlite3::one_cell<int>(*db.prepare("PRAGMA synchronous")); };
+    auto indexes = [&] {
+        return *neo::sqlite3::one_cell<std::string>(*db.prepare(
+            "SELECT group_concat(name, ',') FROM "
+            "(SELECT name FROM sqlite_master WHERE type = 'index' ORDER BY name)"));
+    };
+    const auto all_indexes = "bar_d,foo_bc,foo_c,sqlite_autoindex_foo_1";
+
+    SECTION("Normal completion") {
+        {
+            neo::sqlite3::bulk_load_session session{db, {.defer_indexes_of = {"foo"}}};
+            CHECK(session.deferred_indexes() == std::vector<std::string>{"foo_bc", "foo_c"});
+            CHECK(journal_mode() == "memory");
+            CHECK(synchronous() == 0);
+            CHECK(indexes() == "bar_d,sqlite_autoindex_foo_1");
+            db.exec("INSERT INTO foo (b, c) VALUES ('x', 1), ('y', 2)").throw_if_error();
+        }
+        CHECK(journal_mode() == "wal");
+        CHECK(synchronous() == 2);
+        CHECK(indexes() == all_indexes);
+    }
+
+    SECTION("Exceptional completion") {
+        auto load = [&] {
+            neo::sqlite3::bulk_load_session session{db, {.defer_indexes_of = {"foo", "bar"}}};
+            throw std::runtime_error("oops");
+        };
+        CHECK_THROWS_AS(load(), std::runtime_error);
+        CHECK(journal_mode() == "wal");
+        CHECK(indexes() == all_indexes);
+    }
+
+    SECTION("Table names are case-insensitive") {
+        neo::sqlite3::bulk_load_session session{db, {.defer_indexes_of = {"FOO"}}};
+        CHECK(session.deferred_indexes() == std::vector<std::string>{"foo_bc", "foo_c"});
+    }
+
+    SECTION("Tables must exist") {
+        CHECK_THROWS_AS(neo::sqlite3::bulk_load_session(db, {.defer_indexes_of = {"baz"}}),
+                        neo::sqlite3::error);
+        CHECK(journal_mode() == "wal");
+        CHECK(indexes() == all_indexes);
+    }
+
+    SECTION("Rebuilding an index fails") {
+        neo::sqlite3::bulk_load_session session{db, {.defer_indexes_of = {"foo"}}};
+        db.exec("INSERT INTO foo (b, c) VALUES ('x', 1), ('y', 1)").throw_if_error();
+        CHECK_THROWS_AS(session.finish(), neo::sqlite3::error);
+        CHECK(session.finished());
+        // The other index was still rebuilt, and the settings were still restored
+        CHECK(indexes() == "bar_d,foo_bc,sqlite_autoindex_foo_1");
+        CHECK(journal_mode() == "wal");
+    }
+
+    SECTION("A session that does not finish") {
+        // Copy the database while the indexes are dropped, as if the process had stopped
+        auto copy = *neo::sqlite3::create_memory_db();
+        {
+            neo::sqlite3::bulk_load_session session{db, {.defer_indexes_of = {"foo", "bar"}}};
+            neo::sqlite3::backup::start(copy, db)->run().throw_if_error();
+        }
+        auto copy_indexes = [&] {
+            return *neo::sqlite3::one_cell<std::string>(*copy.prepare(
+                "SELECT group_concat(name, ',') FROM "
+                "(SELECT name FROM sqlite_master WHERE type = 'index' ORDER BY name)"));
+        };
+        CHECK(copy_indexes() == "sqlite_autoindex_foo_1");
+        CHECK(neo::sqlite3::bulk_load_session::restore_indexes(copy) == 3);
+        CHECK(copy_indexes() == all_indexes);
+        CHECK(neo::sqlite3::bulk_load_session::restore_indexes(copy) == 0);
+        // The records are removed with the last of them
+        CHECK(*neo::sqlite3::one_cell<int>(
+                  *copy.prepare("SELECT count(*) FROM sqlite_master WHERE type = 'table'"))
+              == 2);
+    }
+
+    SECTION("Within a transaction") {
+        db.exec("BEGIN").throw_if_error();
+        {
+            // Nothing is dropped, so no transaction is needed
+            neo::sqlite3::bulk_load_session session{db};
+            CHECK(session.deferred_indexes().empty());
+        }
+        {
+            neo::sqlite3::bulk_load_session session{db, {.defer_indexes_of = {"bar"}}};
+            CHECK(indexes() == "foo_bc,foo_c,sqlite_autoindex_foo_1");
+        }
+        db.exec("COMMIT").throw_if_error();
+        CHECK(indexes() == all_indexes);
+    }
+}
+
+// Run with `[.benchmark]` to compare a large import with and without a bulk_load_session. Each
+// import writes a few gigabytes to the temporary directory
+TEST_CASE_METHOD(sqlite3_temp_db_fixture, "Benchmark a bulk load", "[.benchmark]") {
+    constexpr std::int64_t n_rows = 50'000'000;
+
+    auto rows = std::views::iota(std::int64_t(0), n_rows) | std::views::transform([](auto i) {
+                    return std::tuple(i, (i * 7919) % n_rows, static_cast<double>(i) / 3);
+                });
+
+    auto run = [&](bool bulk) {
+        std::filesystem::remove(path);
+        std::filesystem::remove(path.string() + "-wal");
+        std::filesystem::remove(path.string() + "-shm");
+        auto db = *neo::sqlite3::open(path.string());
+        db.exec(R"(
+            PRAGMA journal_mode = WAL;
+            CREATE TABLE points (id INTEGER PRIMARY KEY, key INTEGER, value REAL);
+            CREATE INDEX points_key ON points (key);
+            CREATE INDEX points_value ON points (value);
+        )")
+            .throw_if_error();
+
+        const auto start = std::chrono::steady_clock::now();
+        {
+            std::optional<neo::sqlite3::bulk_load_session> session;
+            if (bulk) {
+                session.emplace(db,
+                                neo::sqlite3::bulk_load_options{.defer_indexes_of = {"points"}});
+            }
+            neo::sqlite3::transaction_guard tr{db};
+            neo::sqlite3::exec_each(*db.prepare("INSERT INTO points VALUES (?, ?, ?)"), rows)
+                .throw_if_error();
+            tr.commit();
+        }
+        const auto dur = std::chrono::duration<double>(std::chrono::steady_clock::now() - start);
+        WARN((bulk ? "bulk_load_session: " : "exec_each: ")
+             << static_cast<std::int64_t>(n_rows / dur.count()) << " rows/s");
+    };
+    run(false);
+    run(true);
+}
@@ -0,0 +1,101 @@
+#include "./busy_policy.hpp"
+
+#include <neo/sqlite3/connection_ref.hpp>
+#include <neo/sqlite3/connection_state.hpp>
+#include <neo/sqlite3/error.hpp>
+
+#include <sqlite3/sqlite3.h>
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+using namespace neo::sqlite3;
+
+namespace {
+
+using clock = std::chrono::steady_clock;
+
+std::chrono::nanoseconds sleep_duration(const busy_policy& policy, int n_sleeps) noexcept {
+    auto scale = std::pow(policy.multiplier, n_sleeps);
+    auto max   = std::chrono::duration<double, std::nano>(policy.max_sleep);
+    auto dur   = std::min(std::chrono::duration<double, std::nano>(policy.initial_sleep) * scale,
+                        max);
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(dur);
+}
+
+int busy_handler(void* ptr, int count) noexcept {
+    auto&      state = *static_cast<detail::busy_handler_state*>(ptr);
+    const auto now   = clock::now();
+    state.invocations.fetch_add(1, std::memory_order_relaxed);
+    if (count == 0) {
+        state.wait_start = now;
+        state.waits.fetch_add(1, std::memory_order_relaxed);
+    }
+    const auto remaining = state.wait_start + state.policy.timeout - now;
+    if (remaining <= clock::duration::zero()) {
+        state.timeouts.fetch_add(1, std::memory_order_relaxed);
+        return 0;
+    }
+    if (count < state.policy.spin_count) {
+        std::this_thread::yield();
+    } else {
+        auto dur = sleep_duration(state.policy, count - state.policy.spin_count);
+        std::this_thread::sleep_for(std::min<clock::duration>(dur, remaining));
+    }
+    auto blocked = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - now);
+    state.blocked_ns.fetch_add(blocked.count(), std::memory_order_relaxed);
+    return 1;
+}
+
+}  // namespace
+
+busy_policy busy_policy::spin_then_sleep(int                       spins,
+                                         std::chrono::microseconds sleep,
+                                         std::chrono::milliseconds timeout) noexcept {
+    return {
+        .spin_count    = spins,
+        .initial_sleep = sleep,
+        .max_sleep     = sleep,
+        .multiplier    = 1.0,
+        .timeout       = timeout,
+    };
+}
+
+busy_policy busy_policy::backoff(std::chrono::milliseconds deadline) noexcept {
+    return {.timeout = deadline};
+}
+
+busy_policy busy_policy::fail_immediately() noexcept {
+    return {.timeout = std::chrono::milliseconds{0}};
+}
+
+busy_stats detail::busy_handler_state::stats() const noexcept {
+    return {
+        .invocations  = invocations.load(std::memory_order_relaxed),
+        .waits        = waits.load(std::memory_order_relaxed),
+        .timeouts     = timeouts.load(std::memory_order_relaxed),
+        .time_blocked = std::chrono::nanoseconds{blocked_ns.load(std::memory_order_relaxed)},
+    };
+}
+
+void connection_ref::set_busy_policy(const busy_policy& policy) {
+    auto state = detail::get_connection_state(c_ptr());
+    if (!state) {
+        throw_error(make_error_code(errc::misuse),
+                    "Busy policies can only be set on connections opened by neo::sqlite3",
+                    "The connection has no library-managed state");
+    }
+    state->busy.policy = policy;
+    auto rc            = ::sqlite3_busy_handler(c_ptr(), &busy_handler, &state->busy);
+    auto ec            = to_error_code(rc);
+    if (ec) {
+        throw_error(ec, "Failed to install a busy handler", *this);
+    }
+    state->busy.installed = true;
+}
+
+busy_stats connection_ref::busy_statistics() const noexcept {
+    auto state = detail::get_connection_state(c_ptr());
+    return state ? state->busy.stats() : busy_stats{};
+}
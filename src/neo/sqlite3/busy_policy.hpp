@@ -0,0 +1,84 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace neo::sqlite3 {
+
+/**
+ * @brief Controls how a connection waits when it cannot obtain a database lock.
+ *
+ * When a lock is held by another connection, the waiting connection first yields its thread up to
+ * `spin_count` times, which is cheap when locks are held only briefly. After that it sleeps,
+ * starting at `initial_sleep` and multiplying the sleep duration by `multiplier` after each
+ * attempt, up to `max_sleep`. Once `timeout` has passed since the first attempt, the operation
+ * fails with SQLITE_BUSY.
+ *
+ * Install a policy on a connection with connection_ref::set_busy_policy().
+ */
+struct busy_policy {
+    int                       spin_count = 0;
+    std::chrono::microseconds initial_sleep{100};
+    std::chrono::microseconds max_sleep{std::chrono::milliseconds{50}};
+    double                    multiplier = 2.0;
+    std::chrono::milliseconds timeout{5000};
+
+    /**
+     * @brief Yield `spins` times, then sleep for a fixed duration between each attempt
+     */
+    static busy_policy spin_then_sleep(int                       spins,
+                                       std::chrono::microseconds sleep,
+                                       std::chrono::milliseconds timeout) noexcept;
+
+    /**
+     * @brief Sleep with exponentially increasing durations until the deadline is reached
+     */
+    static busy_policy backoff(std::chrono::milliseconds deadline) noexcept;
+
+    /**
+     * @brief Fail immediately when a lock is unavailable. Contention is still counted.
+     */
+    static busy_policy fail_immediately() noexcept;
+};
+
+/**
+ * @brief Lock contention counters for a connection, as returned by
+ * connection_ref::busy_statistics()
+ */
+struct busy_stats {
+    /// The number of times the busy handler was invoked
+    std::uint64_t invocations = 0;
+    /// The number of lock acquisitions that were blocked by another connection
+    std::uint64_t waits = 0;
+    /// The number of blocked lock acquisitions that gave up with SQLITE_BUSY
+    std::uint64_t timeouts = 0;
+    /// The total time that the connection has spent blocked waiting for locks
+    std::chrono::nanoseconds time_blocked{0};
+};
+
+namespace detail {
+
+/**
+ * @brief The busy handler state of a connection, stored in its connection_state.
+ *
+ * The policy is only accessed by the thread using the connection, but the counters may be read
+ * from any thread.
+ */
+struct busy_handler_state {
+    busy_policy                           policy;
+    std::chrono::steady_clock::time_point wait_start;
+    /// Set once the busy handler has been installed on the connection
+    bool installed = false;
+
+    std::atomic<std::uint64_t> invocations{0};
+    std::atomic<std::uint64_t> waits{0};
+    std::atomic<std::uint64_t> timeouts{0};
+    std::atomic<std::int64_t>  blocked_ns{0};
+
+    [[nodiscard]] busy_stats stats() const noexcept;
+};
+
+}  // namespace detail
+
+}  // namespace neo::sqlite3
@@ -0,0 +1,67 @@
+#include <neo/sqlite3/busy_policy.hpp>
+#include <neo/sqlite3/connection.hpp>
+#include <neo/sqlite3/error.hpp>
+#include <neo/sqlite3/exec.hpp>
+#include <neo/sqlite3/transaction.hpp>
+
+#include "./tests.inl"
+
+#include <thread>
+
+using namespace std::chrono_literals;
+
+TEST_CASE_METHOD(sqlite3_temp_db_fixture, "Busy policies wait for locks") {
+    auto db1 = *neo::sqlite3::open(path.string());
+    auto db2 = *neo::sqlite3::open(path.string());
+    db1.exec("CREATE TABLE foo (bar INTEGER)").throw_if_error();
+
+    SECTION("Until the deadline passes") {
+        db2.set_busy_policy(neo::sqlite3::busy_policy::spin_then_sleep(10, 1ms, 30ms));
+        neo::sqlite3::transaction_guard tr{db1, neo::sqlite3::transaction_mode::immediate};
+        CHECK_THROWS_AS(
+            neo::sqlite3::transaction_guard(db2, neo::sqlite3::transaction_mode::immediate),
+            neo::sqlite3::busy_error);
+        auto stats = db2.busy_statistics();
+        CHECK(stats.waits == 1);
+        CHECK(stats.timeouts == 1);
+        CHECK(stats.invocations > 10);
+        CHECK(stats.time_blocked >= 20ms);
+        CHECK(db1.busy_statistics().invocations == 0);
+    }
+
+    SECTION("Until the lock is released") {
+        db2.set_busy_policy(neo::sqlite3::busy_policy::backoff(5000ms));
+        auto tr = std::make_unique<neo::sqlite3::transaction_guard>(
+            db1, neo::sqlite3::transaction_mode::immediate);
+        std::thread releaser{[&] {
+            std::this_thread::sleep_for(30ms);
+            tr->commit();
+        }};
+        CHECK_NOTHROW(
+            neo::sqlite3::transaction_guard(db2, neo::sqlite3::transaction_mode::immediate));
+        releaser.join();
+        auto stats = db2.busy_statistics();
+        CHECK(stats.waits == 1);
+        CHECK(stats.timeouts == 0);
+        CHECK(stats.time_blocked >= 10ms);
+    }
+
+    SECTION("Failing immediately still counts contention") {
+        db2.set_busy_policy(neo::sqlite3::busy_policy::fail_immediately());
+        neo::sqlite3::transaction_guard tr{db1, neo::sqlite3::transaction_mode::immediate};
+        CHECK_THROWS_AS(
+            neo::sqlite3::transaction_guard(db2, neo::sqlite3::transaction_mode::immediate),
+            neo::sqlite3::busy_error);
+        auto stats = db2.busy_statistics();
+        CHECK(stats.invocations == 1);
+        CHECK(stats.timeouts == 1);
+    }
+
+    SECTION("Releasing a connection keeps its busy timeout") {
+        db2.exec("PRAGMA busy_timeout = 1234").throw_if_error();
+        neo::sqlite3::connection released{db2.release()};
+        CHECK(*neo::sqlite3::one_cell<int>(*released.prepare("PRAGMA busy_timeout")) == 1234);
+    }
+
+    // Close the connections before removing the file
+}
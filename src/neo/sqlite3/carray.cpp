@@ -0,0 +1,198 @@
+#include "./carray.hpp"
+
+#include <neo/sqlite3/connection_ref.hpp>
+#include <neo/sqlite3/error.hpp>
+
+#include <neo/ufmt.hpp>
+#include <sqlite3/sqlite3.h>
+
+#include <cstring>
+#include <string>
+#include <string_view>
+
+using namespace neo::sqlite3;
+
+namespace {
+
+/// The pointer type tag used with sqlite3_bind_pointer() and sqlite3_value_pointer()
+constexpr const char* carray_pointer_type = "neo::sqlite3::carray";
+
+/// Column indices of the carray() virtual table
+enum carray_column : int {
+    value_column   = 0,
+    pointer_column = 1,
+};
+
+struct carray_cursor {
+    ::sqlite3_vtab_cursor base{};
+    const carray*         array = nullptr;
+    std::size_t           pos   = 0;
+};
+
+int carray_connect(::sqlite3* db,
+                   void*,
+                   int,
+                   const char* const*,
+                   ::sqlite3_vtab** out,
+                   char**) noexcept {
+    auto rc = ::sqlite3_declare_vtab(db, "CREATE TABLE x(value, pointer HIDDEN)");
+    if (rc != SQLITE_OK) {
+        return rc;
+    }
+    auto vtab = static_cast<::sqlite3_vtab*>(::sqlite3_malloc(sizeof(::sqlite3_vtab)));
+    if (!vtab) {
+        return SQLITE_NOMEM;
+    }
+    std::memset(vtab, 0, sizeof *vtab);
+    *out = vtab;
+    return SQLITE_OK;
+}
+
+int carray_disconnect(::sqlite3_vtab* vtab) noexcept {
+    ::sqlite3_free(vtab);
+    return SQLITE_OK;
+}
+
+int carray_best_index(::sqlite3_vtab*, ::sqlite3_index_info* info) noexcept {
+    for (auto i = 0; i < info->nConstraint; ++i) {
+        auto& cons = info->aConstraint[i];
+        if (cons.iColumn != pointer_column || cons.op != SQLITE_INDEX_CONSTRAINT_EQ) {
+            continue;
+        }
+        if (!cons.usable) {
+            // The planner must find a plan in which the array is available
+            return SQLITE_CONSTRAINT;
+        }
+        info->aConstraintUsage[i].argvIndex = 1;
+        info->aConstraintUsage[i].omit      = 1;
+        info->idxNum                        = 1;
+        info->estimatedCost                 = 10;
+        info->estimatedRows                 = 100;
+        return SQLITE_OK;
+    }
+    // No array was given, so there are no rows. Discourage the planner from using this plan.
+    info->idxNum        = 0;
+    info->estimatedCost = 2147483647;
+    info->estimatedRows = 2147483647;
+    return SQLITE_OK;
+}
+
+int carray_open(::sqlite3_vtab*, ::sqlite3_vtab_cursor** out) noexcept {
+    auto cur = new (std::nothrow) carray_cursor{};
+    if (!cur) {
+        return SQLITE_NOMEM;
+    }
+    *out = &cur->base;
+    return SQLITE_OK;
+}
+
+int carray_close(::sqlite3_vtab_cursor* cur) noexcept {
+    delete reinterpret_cast<carray_cursor*>(cur);
+    return SQLITE_OK;
+}
+
+int carray_filter(::sqlite3_vtab_cursor* cur_,
+                  int                    idx_num,
+                  const char*,
+                  int,
+                  ::sqlite3_value** argv) noexcept {
+    auto& cur = *reinterpret_cast<carray_cursor*>(cur_);
+    cur.pos   = 0;
+    cur.array = nullptr;
+    if (idx_num == 1) {
+        // Yields null if the argument is not a carray bound with bind_carray()
+        cur.array
+            = static_cast<const carray*>(::sqlite3_value_pointer(argv[0], carray_pointer_type));
+    }
+    return SQLITE_OK;
+}
+
+int carray_next(::sqlite3_vtab_cursor* cur) noexcept {
+    ++reinterpret_cast<carray_cursor*>(cur)->pos;
+    return SQLITE_OK;
+}
+
+int carray_eof(::sqlite3_vtab_cursor* cur_) noexcept {
+    auto& cur = *reinterpret_cast<carray_cursor*>(cur_);
+    return !cur.array || cur.pos >= cur.array->size();
+}
+
+void set_text(::sqlite3_context* ctx, std::string_view str) noexcept {
+    // The caller guarantees the array outlives the statement, so no copy is needed
+    ::sqlite3_result_text64(ctx,
+                            str.data(),
+                            static_cast<::sqlite3_uint64>(str.size()),
+                            SQLITE_STATIC,
+                            SQLITE_UTF8);
+}
+
+int carray_column(::sqlite3_vtab_cursor* cur_, ::sqlite3_context* ctx, int col) noexcept {
+    auto& cur = *reinterpret_cast<carray_cursor*>(cur_);
+    if (col != value_column) {
+        // The hidden pointer column is never useful to read
+        ::sqlite3_result_null(ctx);
+        return SQLITE_OK;
+    }
+    auto& arr = *cur.array;
+    switch (arr.type()) {
+    case carray::element_type::int64:
+        ::sqlite3_result_int64(ctx, static_cast<const std::int64_t*>(arr.data())[cur.pos]);
+        break;
+    case carray::element_type::real:
+        ::sqlite3_result_double(ctx, static_cast<const double*>(arr.data())[cur.pos]);
+        break;
+    case carray::element_type::text_view:
+        set_text(ctx, static_cast<const std::string_view*>(arr.data())[cur.pos]);
+        break;
+    case carray::element_type::text:
+        set_text(ctx, static_cast<const std::string*>(arr.data())[cur.pos]);
+        break;
+    }
+    return SQLITE_OK;
+}
+
+int carray_rowid(::sqlite3_vtab_cursor* cur, ::sqlite3_int64* out) noexcept {
+    *out = static_cast<::sqlite3_int64>(reinterpret_cast<carray_cursor*>(cur)->pos) + 1;
+    return SQLITE_OK;
+}
+
+void destroy_carray(void* ptr) noexcept { delete static_cast<carray*>(ptr); }
+
+// xCreate is null, which makes this an eponymous-only virtual table
+constexpr ::sqlite3_module carray_module = {
+    .iVersion    = 0,
+    .xCreate     = nullptr,
+    .xConnect    = &carray_connect,
+    .xBestIndex  = &carray_best_index,
+    .xDisconnect = &carray_disconnect,
+    .xDestroy    = &carray_disconnect,
+    .xOpen       = &carray_open,
+    .xClose      = &carray_close,
+    .xFilter     = &carray_filter,
+    .xNext       = &carray_next,
+    .xEof        = &carray_eof,
+    .xColumn     = &carray_column,
+    .xRowid      = &carray_rowid,
+};
+
+}  // namespace
+
+errable<void> binding::bind_carray(carray arr) noexcept {
+    // Only the small descriptor is copied. The elements themselves are referred-to.
+    auto desc = new (std::nothrow) carray(arr);
+    if (!desc) {
+        return _make_error(errc::no_memory, "Failed to allocate a carray descriptor");
+    }
+    // sqlite3_bind_pointer() will call the destructor even if binding fails
+    auto rc
+        = errc{::sqlite3_bind_pointer(_owner, _index, desc, carray_pointer_type, &destroy_carray)};
+    return _maybe_make_error(rc, "sqlite3_bind_pointer() failed");
+}
+
+void neo::sqlite3::register_carray(connection_ref db, neo::zstring_view name) {
+    auto rc = ::sqlite3_create_module(db.c_ptr(), name.data(), &carray_module, nullptr);
+    auto ec = to_error_code(rc);
+    if (ec) {
+        throw_error(ec, ufmt("Error while registering carray() as '{}'", name), db);
+    }
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <neo/sqlite3/binding.hpp>
+
+#include <neo/zstring_view.hpp>
+
+namespace neo::sqlite3 {
+
+class connection_ref;
+
+/**
+ * @brief Register the `carray()` table-valued function with the given database connection.
+ *
+ * `carray()` takes a single argument, which must be a `carray` object bound to a statement
+ * parameter, and generates one row for each element of the array with a single column named
+ * `value`. This allows a single prepared statement to match against any number of values:
+ *
+ *      register_carray(db);
+ *      auto st = db.prepare("SELECT * FROM users WHERE id IN carray(?)");
+ *      std::vector<std::int64_t> ids = ...;
+ *      st.bindings()[1] = carray(ids);
+ *
+ * If `carray()` is passed anything other than a bound `carray`, it generates no rows.
+ *
+ * @param name The name of the table-valued function to register.
+ */
+void register_carray(connection_ref db, neo::zstring_view name = "carray");
+
+}  // namespace neo::sqlite3
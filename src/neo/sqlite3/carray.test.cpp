@@ -0,0 +1,57 @@
+#include <neo/sqlite3/carray.hpp>
+#include <neo/sqlite3/exec.hpp>
+
+#include "./tests.inl"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace neo::sqlite3;
+
+TEST_CASE_METHOD(sqlite3_memory_db_fixture, "Bind an array of integers for an IN-list") {
+    register_carray(db);
+    db.exec("CREATE TABLE stuff (id INTEGER PRIMARY KEY, name TEXT)").throw_if_error();
+    db.exec("INSERT INTO stuff VALUES (1, 'one'), (2, 'two'), (3, 'three'), (4, 'four')")
+        .throw_if_error();
+
+    auto st = *db.prepare("SELECT name FROM stuff WHERE id IN carray(?) ORDER BY id");
+
+    auto get_names = [&](std::span<const std::int64_t> ids) {
+        std::vector<std::string> names;
+        auto                     rows = *exec_tuples<std::string>(st, carray(ids));
+        for (auto [name] : rows) {
+            names.push_back(name);
+        }
+        return names;
+    };
+
+    std::vector<std::int64_t> ids = {4, 2, 9};
+    CHECK(get_names(ids) == std::vector<std::string>{"two", "four"});
+    // The same statement can be reused with an array of a different size
+    ids = {1, 2, 3};
+    CHECK(get_names(ids) == std::vector<std::string>{"one", "two", "three"});
+    CHECK(get_names({}).empty());
+}
+
+TEST_CASE_METHOD(sqlite3_memory_db_fixture, "Select from carray() directly") {
+    register_carray(db);
+    auto sum = *db.prepare("SELECT sum(value) FROM carray(?)");
+
+    std::vector<double> reals = {1.5, 2.5, 3};
+    CHECK(*one_cell<double>(sum, carray(reals)) == 7);
+
+    auto concat = *db.prepare("SELECT group_concat(value, '') FROM carray(?)");
+
+    std::vector<std::string_view> views = {"a", "b", "c"};
+    CHECK(*one_cell<std::string>(concat, carray(views)) == "abc");
+
+    std::vector<std::string> strings = {"foo", "bar"};
+    CHECK(*one_cell<std::string>(concat, carray(strings)) == "foobar");
+}
+
+TEST_CASE_METHOD(sqlite3_memory_db_fixture, "carray() ignores values that are not bound arrays") {
+    register_carray(db);
+    auto st = *db.prepare("SELECT count(*) FROM carray(?)");
+    CHECK(*one_cell<int>(st, 42) == 0);
+}
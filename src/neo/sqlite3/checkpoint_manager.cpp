@@ -0,0 +1,171 @@
+#include "./checkpoint_manager.hpp"
+
+#include <neo/sqlite3/busy_policy.hpp>
+#include <neo/sqlite3/error.hpp>
+#include <neo/sqlite3/pragma.hpp>
+
+#include <neo/event.hpp>
+
+#include <sqlite3/sqlite3.h>
+
+#include <algorithm>
+
+using namespace neo::sqlite3;
+
+namespace {
+
+using clock = std::chrono::steady_clock;
+
+/// The size of the header of a WAL file
+constexpr std::int64_t wal_header_size = 32;
+/// The size of the header of each frame in a WAL file
+constexpr std::int64_t wal_frame_header_size = 24;
+
+}  // namespace
+
+checkpoint_manager::checkpoint_manager(connection&& db, checkpoint_policy policy)
+    : _db(std::move(db))
+    , _policy(policy) {
+    if (pragma::set_journal_mode(_db, journal_mode::wal) != journal_mode::wal) {
+        throw_error(make_error_code(errc::misuse),
+                    "checkpoint_manager requires a database that supports WAL mode",
+                    _db);
+    }
+    // The manager's connection never writes, but it must not run checkpoints of its own accord
+    pragma::set_wal_autocheckpoint(_db, 0);
+    _db.set_busy_policy(busy_policy::backoff(_policy.blocking_timeout));
+    _frame_size = pragma::get_page_size(_db) + wal_frame_header_size;
+    _thread     = std::thread{[this] { _run(); }};
+}
+
+checkpoint_manager::~checkpoint_manager() {
+    // Installing a hook takes the mutex of the connection, which a committing writer holds while
+    // it runs the hook. The hook takes _mutex, so that must not be held here.
+    {
+        std::unique_lock lk{_attach_mutex};
+        for (auto db : _attached) {
+            ::sqlite3_wal_hook(db, nullptr, nullptr);
+        }
+        _attached.clear();
+    }
+    {
+        std::unique_lock lk{_mutex};
+        _stopping = true;
+    }
+    _cv.notify_one();
+    _thread.join();
+}
+
+void checkpoint_manager::attach(connection_ref writer) {
+    std::unique_lock lk{_attach_mutex};
+    // Installing a WAL hook replaces the hook that runs automatic checkpoints
+    ::sqlite3_wal_hook(writer.c_ptr(), &checkpoint_manager::_wal_hook, this);
+    if (std::ranges::find(_attached, writer.c_ptr()) == _attached.end()) {
+        _attached.push_back(writer.c_ptr());
+    }
+}
+
+void checkpoint_manager::detach(connection_ref writer) noexcept {
+    std::unique_lock lk{_attach_mutex};
+    auto             it = std::ranges::find(_attached, writer.c_ptr());
+    if (it != _attached.end()) {
+        ::sqlite3_wal_hook(writer.c_ptr(), nullptr, nullptr);
+        _attached.erase(it);
+    }
+}
+
+void checkpoint_manager::request_checkpoint() noexcept {
+    if (!_requested.exchange(true, std::memory_order_acq_rel)) {
+        // Taking the lock ensures that the thread is either waiting or has not yet checked
+        // for a request.
+        _mutex.lock();
+        _mutex.unlock();
+        _cv.notify_one();
+    }
+}
+
+checkpoint_stats checkpoint_manager::stats() const noexcept {
+    return {
+        .n_checkpoints      = _n_checkpoints.load(std::memory_order_relaxed),
+        .n_busy             = _n_busy.load(std::memory_order_relaxed),
+        .wal_frames         = _wal_frames.load(std::memory_order_relaxed),
+        .time_checkpointing = std::chrono::nanoseconds{_checkpoint_ns.load()},
+    };
+}
+
+int checkpoint_manager::_wal_hook(void* ptr, ::sqlite3*, const char*, int n_frames) noexcept {
+    // Called by a writer after each commit, with the number of frames now in the WAL
+    auto& self = *static_cast<checkpoint_manager*>(ptr);
+    self._wal_frames.store(n_frames, std::memory_order_relaxed);
+    if (n_frames >= self._policy.passive_frames) {
+        self.request_checkpoint();
+    }
+    return SQLITE_OK;
+}
+
+void checkpoint_manager::_run() noexcept {
+    while (true) {
+        {
+            std::unique_lock lk{_mutex};
+            _cv.wait_for(lk, _policy.interval, [&] {
+                return _stopping || _requested.load(std::memory_order_acquire);
+            });
+            if (_stopping) {
+                return;
+            }
+        }
+        _requested.store(false, std::memory_order_release);
+        const auto n_frames = _wal_frames.load(std::memory_order_relaxed);
+        if (n_frames >= _policy.truncate_frames) {
+            _checkpoint(checkpoint_mode::truncate);
+        } else if (n_frames >= _policy.restart_frames) {
+            _checkpoint(checkpoint_mode::restart);
+        } else {
+            _checkpoint(checkpoint_mode::passive);
+        }
+    }
+}
+
+void checkpoint_manager::_checkpoint(checkpoint_mode mode) noexcept {
+    using std::chrono::duration_cast;
+    using std::chrono::nanoseconds;
+
+    const auto start  = clock::now();
+    int        n_log  = -1;
+    int        n_ckpt = -1;
+    // A null schema name checkpoints every attached database
+    int rc = ::sqlite3_wal_checkpoint_v2(_db.c_ptr(),
+                                         nullptr,
+                                         static_cast<int>(mode),
+                                         &n_log,
+                                         &n_ckpt);
+    const auto duration = duration_cast<nanoseconds>(clock::now() - start);
+
+    _n_checkpoints.fetch_add(1, std::memory_order_relaxed);
+    _checkpoint_ns.fetch_add(duration.count(), std::memory_order_relaxed);
+    if (n_log >= 0) {
+        _wal_frames.store(n_log, std::memory_order_relaxed);
+    }
+    auto ec = static_cast<errc>(rc);
+    if (ec == errc::ok && n_ckpt < n_log) {
+        // Readers prevented some frames from being copied into the database
+        ec = errc::busy;
+    }
+    if (ec != errc::ok) {
+        _n_busy.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    try {
+        neo::emit(event::wal_checkpoint{
+            .db                  = _db,
+            .mode                = mode,
+            .ec                  = ec,
+            .wal_frames          = std::max(n_log, 0),
+            .wal_bytes           = n_log > 0 ? wal_header_size + n_log * _frame_size : 0,
+            .checkpointed_frames = std::max(n_ckpt, 0),
+            .duration            = duration,
+        });
+    } catch (...) {
+        // There is nobody to report the error to
+    }
+}
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <neo/sqlite3/connection.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace neo::sqlite3 {
+
+/**
+ * @brief The modes of a WAL checkpoint. See https://sqlite.org/c3ref/wal_checkpoint_v2.html
+ */
+enum class checkpoint_mode {
+    /// Checkpoint as many frames as possible without waiting for readers or writers
+    passive = 0,
+    /// Wait for writers, then checkpoint every frame, waiting for readers as needed
+    full = 1,
+    /// Like `full`, then wait for readers to finish so that the WAL can be restarted from the start
+    restart = 2,
+    /// Like `restart`, then truncate the WAL file to zero bytes
+    truncate = 3,
+};
+
+/**
+ * @brief Controls when a checkpoint_manager runs checkpoints, and which mode it uses.
+ */
+struct checkpoint_policy {
+    /// Run a PASSIVE checkpoint once the WAL contains this many frames
+    int passive_frames = 1000;
+    /// If the WAL contains this many frames, use RESTART instead, to stop the WAL from growing
+    int restart_frames = 10'000;
+    /// If the WAL contains this many frames, use TRUNCATE, to also release the disk space
+    int truncate_frames = 100'000;
+    /// Also run a PASSIVE checkpoint at this interval, even if no writes have been observed
+    std::chrono::milliseconds interval{std::chrono::seconds{1}};
+    /// The longest that a RESTART or TRUNCATE checkpoint will wait for readers and writers
+    std::chrono::milliseconds blocking_timeout{std::chrono::seconds{1}};
+};
+
+/**
+ * @brief Counters of the checkpoints run by a checkpoint_manager
+ */
+struct checkpoint_stats {
+    /// The number of checkpoints that were attempted
+    std::uint64_t n_checkpoints = 0;
+    /// The number of checkpoints that failed, or could not complete due to other connections
+    std::uint64_t n_busy = 0;
+    /// The size of the WAL, in frames, after the most recent checkpoint
+    std::int64_t wal_frames = 0;
+    /// The total time spent in checkpoints
+    std::chrono::nanoseconds time_checkpointing{0};
+};
+
+namespace event {
+
+/**
+ * @brief Fired by the thread of a checkpoint_manager after each checkpoint
+ */
+struct wal_checkpoint {
+    connection_ref& db;
+    checkpoint_mode mode;
+    /// The result of the checkpoint. `errc::busy` if other connections prevented its completion
+    errc ec;
+    /// The size of the WAL after the checkpoint, in frames
+    int wal_frames;
+    /// The number of bytes of the WAL file that are in use after the checkpoint
+    std::int64_t wal_bytes;
+    /// The number of frames that have been copied into the database
+    int checkpointed_frames;
+    /// The time taken by the checkpoint
+    std::chrono::nanoseconds duration;
+};
+
+}  // namespace event
+
+/**
+ * @brief Runs WAL checkpoints on a background thread, so that writers do not pay for them.
+ *
+ * The manager owns a dedicated connection to a WAL-mode database, and runs checkpoints using that
+ * connection on its own thread. Connections that write to the database should be attach()'d to the
+ * manager: This replaces their automatic checkpoints with a WAL hook that informs the manager of
+ * the size of the WAL after each commit, and wakes the manager's thread when a checkpoint is due.
+ *
+ * Checkpoints are PASSIVE, unless the WAL has grown past the thresholds of the checkpoint_policy,
+ * in which case RESTART or TRUNCATE is used to allow the WAL to be reset or truncated. These wait
+ * (up to `blocking_timeout`) for other connections to finish their transactions, and hold the
+ * write lock while they run, so writers should have a busy handler (see busy_policy).
+ *
+ * Each checkpoint fires an event::wal_checkpoint on the manager's thread.
+ */
+class checkpoint_manager {
+    connection        _db;
+    checkpoint_policy _policy;
+    std::int64_t      _frame_size = 0;
+
+    /// The size of the WAL, as last reported by a WAL hook or checkpoint
+    std::atomic<int> _wal_frames{0};
+    /// Set when a checkpoint has been requested, to avoid redundant wake-ups
+    std::atomic<bool> _requested{false};
+
+    std::atomic<std::uint64_t> _n_checkpoints{0};
+    std::atomic<std::uint64_t> _n_busy{0};
+    std::atomic<std::int64_t>  _checkpoint_ns{0};
+
+    /// Guards _stopping and wakes the thread. Taken by the WAL hook, so while this is held, no
+    /// connection mutex may be taken.
+    std::mutex              _mutex;
+    std::condition_variable _cv;
+    bool                    _stopping = false;
+
+    /// Guards _attached, and serializes the installation of WAL hooks
+    std::mutex              _attach_mutex;
+    std::vector<::sqlite3*> _attached;
+
+    std::thread _thread;
+
+    static int _wal_hook(void*, ::sqlite3*, const char*, int) noexcept;
+    void       _run() noexcept;
+    void       _checkpoint(checkpoint_mode mode) noexcept;
+
+public:
+    /**
+     * @brief Begin managing checkpoints of the database opened by the given connection. The
+     * database is put into WAL mode, if it is not already.
+     */
+    explicit checkpoint_manager(connection&& db, checkpoint_policy policy = {});
+    /// Detaches all attached connections, then stops the background thread
+    ~checkpoint_manager();
+
+    checkpoint_manager(const checkpoint_manager&) = delete;
+    checkpoint_manager& operator=(const checkpoint_manager&) = delete;
+
+    /**
+     * @brief Install a WAL hook on the given connection, which must write to the same database as
+     * the manager. This disables its automatic checkpoints.
+     *
+     * The connection must be detach()'d before it is closed, or must outlive the manager.
+     */
+    void attach(connection_ref writer);
+
+    /**
+     * @brief Remove the WAL hook from the given connection. Its automatic checkpoints remain
+     * disabled.
+     */
+    void detach(connection_ref writer) noexcept;
+
+    /// Wake the manager's thread to run a checkpoint as soon as possible
+    void request_checkpoint() noexcept;
+
+    /// Obtain the counters of the checkpoints run by this manager
+    [[nodiscard]] checkpoint_stats stats() const noexcept;
+};
+
+}  // namespace neo::sqlite3
@@ -0,0 +1,118 @@
+#include <neo/sqlite3/busy_policy.hpp>
+#include <neo/sqlite3/checkpoint_manager.hpp>
+#include <neo/sqlite3/exec.hpp>
+#include <neo/sqlite3/pragma.hpp>
+
+#include "./tests.inl"
+
+#include <atomic>
+#include <filesystem>
+#include <thread>
+
+namespace {
+
+/// Wait until the predicate holds, for at most a few seconds
+template <typename Pred>
+bool wait_for(Pred&& pred) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{5};
+    while (!pred()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds{5});
+    }
+    return true;
+}
+
+}  // namespace
+
+TEST_CASE_METHOD(sqlite3_temp_db_fixture, "Checkpoint a WAL in the background") {
+    auto wal_path = path.string() + "-wal";
+
+    auto writer = *neo::sqlite3::open(path.string());
+    neo::sqlite3::pragma::set_journal_mode(writer, neo::sqlite3::journal_mode::wal);
+    // RESTART and TRUNCATE checkpoints briefly block writers
+    writer.set_busy_policy(neo::sqlite3::busy_policy::backoff(std::chrono::seconds{5}));
+    writer.exec("CREATE TABLE foo (a INTEGER PRIMARY KEY, b BLOB)").throw_if_error();
+
+    auto insert_rows = [&](int n) {
+        for (auto i = 0; i < n; ++i) {
+            writer.exec("INSERT INTO foo (b) VALUES (randomblob(2000))").throw_if_error();
+        }
+    };
+
+    SECTION("Passive checkpoints when the WAL reaches a size") {
+        neo::sqlite3::checkpoint_manager mgr{*neo::sqlite3::open(path.string()),
+                                             {
+                                                 .passive_frames = 20,
+                                                 .interval       = std::chrono::hours{1},
+                                             }};
+        mgr.attach(writer);
+        insert_rows(5);
+        std::this_thread::sleep_for(std::chrono::milliseconds{20});
+        // Not enough frames have been written to trigger a checkpoint
+        CHECK(mgr.stats().n_checkpoints == 0);
+        insert_rows(20);
+        CHECK(wait_for([&] { return mgr.stats().n_checkpoints > 0; }));
+        // The WAL is never truncated by a passive checkpoint
+        CHECK(std::filesystem::file_size(wal_path) > 0);
+        mgr.detach(writer);
+    }
+
+    SECTION("Escalate to TRUNCATE when the WAL grows large") {
+        neo::sqlite3::checkpoint_manager mgr{*neo::sqlite3::open(path.string()),
+                                             {
+                                                 .passive_frames  = 10,
+                                                 .restart_frames  = 10,
+                                                 .truncate_frames = 10,
+                                                 .interval        = std::chrono::hours{1},
+                                             }};
+        mgr.attach(writer);
+        // Write in a single commit, so that no writes follow the checkpoint
+        writer
+            .exec(R"(
+                WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < 20)
+                INSERT INTO foo (b) SELECT randomblob(2000) FROM n
+            )")
+            .throw_if_error();
+        CHECK(wait_for([&] { return mgr.stats().n_checkpoints > 0; }));
+        CHECK(wait_for([&] { return mgr.stats().wal_frames == 0; }));
+        CHECK(std::filesystem::file_size(wal_path) == 0);
+    }
+
+    SECTION("Attached connections do not checkpoint") {
+        neo::sqlite3::checkpoint_manager mgr{*neo::sqlite3::open(path.string()),
+                                             {
+                                                 .passive_frames = 1'000'000,
+                                                 .interval       = std::chrono::hours{1},
+                                             }};
+        mgr.attach(writer);
+        // Enough to pass the default automatic checkpoint of 1000 pages
+        insert_rows(1200);
+        CHECK(mgr.stats().wal_frames >= 1200);
+        mgr.request_checkpoint();
+        CHECK(wait_for([&] { return mgr.stats().n_checkpoints == 1; }));
+    }
+
+    SECTION("Detach while the writer commits on another thread") {
+        neo::sqlite3::checkpoint_manager mgr{*neo::sqlite3::open(path.string()),
+                                             {
+                                                 .passive_frames = 1,
+                                                 .interval       = std::chrono::hours{1},
+                                             }};
+        std::atomic<bool> done{false};
+        std::thread       thr{[&] {
+            while (!done.load()) {
+                writer.exec("INSERT INTO foo (b) VALUES (randomblob(10))").throw_if_error();
+            }
+        }};
+        for (auto i = 0; i < 1000; ++i) {
+            mgr.attach(writer);
+            mgr.detach(writer);
+        }
+        mgr.attach(writer);
+        done = true;
+        thr.join();
+        // The manager is destroyed while the writer is attached
+    }
+}
@@ -0,0 +1,117 @@
+#include "./collation.hpp"
+
+#include <neo/sqlite3/error.hpp>
+
+#include <neo/ufmt.hpp>
+#include <sqlite3/sqlite3.h>
+
+#include <algorithm>
+
+using namespace neo::sqlite3;
+
+namespace {
+
+constexpr char ascii_fold(char c) noexcept {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+constexpr bool is_digit(char c) noexcept { return c >= '0' && c <= '9'; }
+
+struct no_fold {
+    constexpr char operator()(char c) const noexcept { return c; }
+};
+
+struct fold_case {
+    constexpr char operator()(char c) const noexcept { return ascii_fold(c); }
+};
+
+/// Compare bytes as unsigned values, as memcmp() (and thus SQLite's BINARY) would
+template <typename Fold>
+int compare_byte(char left, char right, Fold fold) noexcept {
+    auto l = static_cast<unsigned char>(fold(left));
+    auto r = static_cast<unsigned char>(fold(right));
+    return l < r ? -1 : (r < l ? 1 : 0);
+}
+
+template <typename Fold>
+int compare_natural_impl(std::string_view left, std::string_view right, Fold fold) noexcept {
+    std::size_t li = 0, ri = 0;
+    while (li < left.size() && ri < right.size()) {
+        if (!is_digit(left[li]) || !is_digit(right[ri])) {
+            auto c = compare_byte(left[li], right[ri], fold);
+            if (c != 0) {
+                return c;
+            }
+            ++li;
+            ++ri;
+            continue;
+        }
+        // Both strings have a run of digits here. Skip leading zeros:
+        while (li < left.size() && left[li] == '0') {
+            ++li;
+        }
+        while (ri < right.size() && right[ri] == '0') {
+            ++ri;
+        }
+        // Find the extent of the significant digits
+        auto l_end = li;
+        auto r_end = ri;
+        while (l_end < left.size() && is_digit(left[l_end])) {
+            ++l_end;
+        }
+        while (r_end < right.size() && is_digit(right[r_end])) {
+            ++r_end;
+        }
+        // A longer run of significant digits is a larger number
+        auto l_len = l_end - li;
+        auto r_len = r_end - ri;
+        if (l_len != r_len) {
+            return l_len < r_len ? -1 : 1;
+        }
+        // Equal length: The first differing digit decides
+        auto c = left.substr(li, l_len).compare(right.substr(ri, r_len));
+        if (c != 0) {
+            return c < 0 ? -1 : 1;
+        }
+        li = l_end;
+        ri = r_end;
+    }
+    // One string is a prefix of the other (or they are equal)
+    auto l_rest = left.size() - li;
+    auto r_rest = right.size() - ri;
+    return l_rest < r_rest ? -1 : (r_rest < l_rest ? 1 : 0);
+}
+
+}  // namespace
+
+int neo::sqlite3::compare_ascii_nocase(std::string_view left, std::string_view right) noexcept {
+    const auto len = std::min(left.size(), right.size());
+    for (std::size_t i = 0; i < len; ++i) {
+        auto c = compare_byte(left[i], right[i], fold_case{});
+        if (c != 0) {
+            return c;
+        }
+    }
+    return left.size() < right.size() ? -1 : (right.size() < left.size() ? 1 : 0);
+}
+
+int neo::sqlite3::compare_natural(std::string_view left, std::string_view right) noexcept {
+    return compare_natural_impl(left, right, no_fold{});
+}
+
+int neo::sqlite3::compare_natural_nocase(std::string_view left, std::string_view right) noexcept {
+    return compare_natural_impl(left, right, fold_case{});
+}
+
+void detail::register_collation(::sqlite3*         db,
+                                neo::zstring_view  name,
+                                void*              data,
+                                collation_callback cmp,
+                                void (*destroy)(void*)) {
+    auto rc = ::sqlite3_create_collation_v2(db, name.data(), SQLITE_UTF8, data, cmp, destroy);
+    // NOTE: Unlike other registration functions, SQLite does not call the destructor upon failure
+    auto ec = to_error_code(rc);
+    if (ec) {
+        throw_error(ec, ufmt("Error while creating collation '{}'", name), connection_ref(db));
+    }
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <neo/sqlite3/connection.hpp>
+
+#include <neo/fwd.hpp>
+
+#include <compare>
+#include <concepts>
+#include <functional>
+#include <memory>
+#include <string_view>
+#include <type_traits>
+
+namespace neo::sqlite3 {
+
+namespace detail {
+
+/// The signature of the comparison callback given to sqlite3_create_collation_v2()
+using collation_callback = int (*)(void*, int, const void*, int, const void*);
+
+template <typename Compare>
+int invoke_collation(void* self, int llen, const void* lptr, int rlen, const void* rptr) noexcept {
+    auto&                  cmp = *static_cast<Compare*>(self);
+    const std::string_view left{static_cast<const char*>(lptr), static_cast<std::size_t>(llen)};
+    const std::string_view right{static_cast<const char*>(rptr), static_cast<std::size_t>(rlen)};
+    auto                   result = std::invoke(cmp, left, right);
+    // Works for both integers and std::weak_ordering/std::strong_ordering
+    return result < 0 ? -1 : (result > 0 ? 1 : 0);
+}
+
+template <typename Compare>
+void destroy_collation(void* self) noexcept {
+    delete static_cast<Compare*>(self);
+}
+
+void register_collation(::sqlite3*         db,
+                        neo::zstring_view  name,
+                        void*              data,
+                        collation_callback cmp,
+                        void (*destroy)(void*));
+
+}  // namespace detail
+
+/**
+ * @brief Compare two strings, ignoring the case of ASCII letters. Other bytes compare by value.
+ *
+ * Equivalent to SQLite's built-in NOCASE.
+ */
+[[nodiscard]] int compare_ascii_nocase(std::string_view left, std::string_view right) noexcept;
+
+/**
+ * @brief Compare two strings in "natural" order, in which runs of decimal digits are compared
+ * by their numeric value, e.g. "file9" sorts before "file10".
+ *
+ * Digit runs with the same value but differing leading zeros (e.g. "07" and "7") compare equal.
+ * All other bytes compare by value.
+ */
+[[nodiscard]] int compare_natural(std::string_view left, std::string_view right) noexcept;
+
+/**
+ * @brief Natural ordering (as with `compare_natural`) that ignores the case of ASCII letters.
+ */
+[[nodiscard]] int compare_natural_nocase(std::string_view left, std::string_view right) noexcept;
+
+/**
+ * @brief Register a collating sequence implemented by a C++ comparator.
+ *
+ * The comparator is invoked with two `std::string_view`s of UTF-8 text, and must return an integer
+ * (negative, zero, or positive) or a `std::weak_ordering`/`std::strong_ordering`. It is called
+ * directly through a function pointer specialized for its type, with no virtual dispatch or
+ * copying of the strings. The comparator must not throw, and must implement a consistent total
+ * order, or any index using the collation will be corrupted.
+ *
+ * Example:
+ *
+ *      db.register_collation("natsort", compare_natural);
+ *      db.exec("CREATE INDEX files_by_name ON files (name COLLATE natsort)");
+ */
+template <typename Compare>
+void connection_ref::register_collation(neo::zstring_view name, Compare&& cmp) {
+    using compare_type = std::decay_t<Compare>;
+    static_assert(std::invocable<compare_type&, std::string_view, std::string_view>,
+                  "Collations must be invocable with two std::string_view arguments");
+    using result_type = std::invoke_result_t<compare_type&, std::string_view, std::string_view>;
+    static_assert(std::integral<result_type>
+                      || std::convertible_to<result_type, std::weak_ordering>,
+                  "Collations must return an integer (<0, 0, or >0) or a std::weak_ordering");
+    auto ptr = std::make_unique<compare_type>(NEO_FWD(cmp));
+    detail::register_collation(_ptr,
+                               name,
+                               ptr.get(),
+                               &detail::invoke_collation<compare_type>,
+                               &detail::destroy_collation<compare_type>);
+    // SQLite now owns the comparator, and will call destroy_collation when it is no longer needed
+    ptr.release();
+}
+
+}  // namespace neo::sqlite3
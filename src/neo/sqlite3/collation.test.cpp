@@ -0,0 +1,94 @@
+#include <neo/sqlite3/collation.hpp>
+#include <neo/sqlite3/exec.hpp>
+
+#include "./tests.inl"
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+using namespace neo::sqlite3;
+
+namespace {
+
+std::vector<std::string> sorted_names(statement& st) {
+    std::vector<std::string> names;
+    auto                     rows = *exec_tuples<std::string>(st);
+    for (auto [name] : rows) {
+        names.push_back(name);
+    }
+    return names;
+}
+
+}  // namespace
+
+TEST_CASE("Natural comparison") {
+    CHECK(compare_natural("file9", "file10") < 0);
+    CHECK(compare_natural("file10", "file9") > 0);
+    CHECK(compare_natural("file10", "file10") == 0);
+    CHECK(compare_natural("file010", "file10") == 0);
+    CHECK(compare_natural("file1", "file1a") < 0);
+    CHECK(compare_natural("a2b3", "a2b21") < 0);
+    CHECK(compare_natural("a", "B") > 0);
+    CHECK(compare_natural_nocase("a", "B") < 0);
+    CHECK(compare_natural_nocase("FILE9", "file10") < 0);
+    CHECK(compare_ascii_nocase("Hello", "hELLO") == 0);
+    CHECK(compare_ascii_nocase("abc", "ABCD") < 0);
+    CHECK(compare_ascii_nocase("\xff", "a") > 0);
+}
+
+TEST_CASE_METHOD(sqlite3_memory_db_fixture, "Order by a custom collation") {
+    db.register_collation("natsort", compare_natural);
+    db.exec("CREATE TABLE files (name TEXT)").throw_if_error();
+    db.exec("INSERT INTO files VALUES ('file10'), ('file9'), ('file1'), ('file100')")
+        .throw_if_error();
+
+    auto st = *db.prepare("SELECT name FROM files ORDER BY name COLLATE natsort");
+    CHECK(sorted_names(st) == std::vector<std::string>{"file1", "file9", "file10", "file100"});
+
+    // An index using the collation will be used to satisfy the ORDER BY
+    db.exec("CREATE INDEX files_natural ON files (name COLLATE natsort)").throw_if_error();
+    auto plan
+        = *db.prepare("EXPLAIN QUERY PLAN SELECT name FROM files ORDER BY name COLLATE natsort");
+    auto [id, parent, unused, detail] = *one_row<int, int, int, std::string>(plan);
+    CHECK(detail.find("files_natural") != std::string::npos);
+    CHECK(sorted_names(st) == std::vector<std::string>{"file1", "file9", "file10", "file100"});
+}
+
+TEST_CASE_METHOD(sqlite3_memory_db_fixture, "Collation from a lambda returning an ordering") {
+    int n_calls = 0;
+    db.register_collation("REVERSE", [&](std::string_view a, std::string_view b) {
+        ++n_calls;
+        return b <=> a;
+    });
+    auto st = *db.prepare(
+        "SELECT column1 FROM (VALUES ('a'), ('c'), ('b')) ORDER BY column1 COLLATE REVERSE");
+    CHECK(sorted_names(st) == std::vector<std::string>{"c", "b", "a"});
+    CHECK(n_calls > 0);
+}
+
+// Run with `[.benchmark]` to compare index builds using a custom collation against NOCASE
+TEST_CASE_METHOD(sqlite3_memory_db_fixture,
+                 "Benchmark index builds with custom collations",
+                 "[.benchmark]") {
+    db.register_collation("ascii_nocase", compare_ascii_nocase);
+    db.register_collation("natsort", compare_natural_nocase);
+    db.exec(R"(
+        CREATE TABLE files (name TEXT);
+        WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < 500000)
+        INSERT INTO files SELECT printf('File-%s-%d', hex(randomblob(4)), random() % 100000)
+          FROM n;
+    )")
+        .throw_if_error();
+
+    for (auto coll : {"NOCASE", "ascii_nocase", "natsort"}) {
+        const auto start = std::chrono::steady_clock::now();
+        db.exec(std::string("CREATE INDEX files_idx ON files (name COLLATE ") + coll + ")")
+            .throw_if_error();
+        const auto dur = std::chrono::steady_clock::now() - start;
+        db.exec("DROP INDEX files_idx").throw_if_error();
+        WARN("CREATE INDEX of 500000 rows with COLLATE "
+             << coll << ": "
+             << std::chrono::duration_cast<std::chrono::milliseconds>(dur).count() << "ms");
+    }
+}
@@ -1,5 +1,7 @@
 #include "./connection.hpp"
 
+#include "./connection_state.hpp"
+
 #include <neo/event.hpp>
 #include <sqlite3/sqlite3.h>
 
@@ -7,10 +9,11 @@ using namespace neo;
 using namespace neo::sqlite3;
 using std::string_view;
 
-errable<connection> connection::open(zstring_view db_name, openmode mode) noexcept {
+errable<connection>
+connection::_open(zstring_view db_name, openmode mode, const char* vfs) noexcept {
     neo::emit(event::open_before{db_name, mode});
     ::sqlite3* new_db = nullptr;
-    auto rc = errc{::sqlite3_open_v2(db_name.data(), &new_db, static_cast<int>(mode), nullptr)};
+    auto rc = errc{::sqlite3_open_v2(db_name.data(), &new_db, static_cast<int>(mode), vfs)};
     if (rc != errc::ok) {
         if (new_db) {
             rc = errc{::sqlite3_extended_errcode(new_db)};
@@ -24,6 +27,21 @@ errable<connection> connection::open(zstring_view db_name, openmode mode) noexce
     ::sqlite3_extended_result_codes(new_db, 1);
 
     auto db = connection(std::move(new_db));
+    try {
+        detail::create_connection_state(db.c_ptr());
+    } catch (const std::bad_alloc&) {
+        return {errc::no_memory, "Failed to allocate connection state"};
+    }
     neo::emit(event::open_after{db_name, db});
     return db;
 }
+
+void connection::_close() noexcept {
+    detail::drop_connection_state(c_ptr());
+    ::sqlite3_close(_exchange_ptr(nullptr));
+}
+
+::sqlite3* connection::release() noexcept {
+    detail::drop_connection_state(c_ptr());
+    return _exchange_ptr(nullptr);
+}
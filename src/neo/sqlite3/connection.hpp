@@ -14,7 +14,8 @@ struct sqlite3;
 
 namespace neo::sqlite3 {
 
-extern "C" namespace c_api { int sqlite3_close(::sqlite3*); }
+struct pragma_profile;
+struct open_options;
 
 /**
  * @brief Bit flag options for opening a database connection.
@@ -60,6 +61,8 @@ struct open_before {
 struct open_error {
     std::string_view filename;
     errc             ec;
+    /// A description of the failure, if there is one beyond the error code
+    std::string_view message = {};
 };
 
 struct open_after {
@@ -77,7 +80,12 @@ struct open_after {
 class connection : public connection_ref {
     connection() = default;
 
-    void _close() noexcept { c_api::sqlite3_close(_exchange_ptr(nullptr)); }
+    /// Destroy library-managed connection state, then close the connection
+    void _close() noexcept;
+
+    /// Open a connection using the named VFS (or the default VFS, if null)
+    [[nodiscard]] static errable<connection>
+    _open(neo::zstring_view s, openmode mode, const char* vfs) noexcept;
 
 public:
     /// Constructing from a null pointer is illegal
@@ -88,13 +96,13 @@ public:
 
     /// We are move-only
     connection(connection&& other) noexcept
-        : connection_ref(other.release()) {}
+        : connection_ref(other._exchange_ptr(nullptr)) {}
 
     connection& operator=(connection&& other) noexcept {
         if (c_ptr()) {
             _close();
         }
-        _exchange_ptr(other.release());
+        _exchange_ptr(other._exchange_ptr(nullptr));
         return *this;
     }
 
@@ -104,8 +112,14 @@ public:
         }
     }
 
-    /// Relinquish ownership of the SQLite connection object, and return the pointer.
-    [[nodiscard]] ::sqlite3* release() noexcept { return _exchange_ptr(nullptr); }
+    /**
+     * @brief Relinquish ownership of the SQLite connection object, and return the pointer.
+     *
+     * Statements cached internally by the library are finalized, so the returned pointer may be
+     * passed to sqlite3_close(). A busy handler installed by set_busy_policy() is removed, since
+     * it refers to library-managed state. Other busy handlers and timeouts are kept.
+     */
+    [[nodiscard]] ::sqlite3* release() noexcept;
 
     /**
      * @brief Open a new SQLite connection.
@@ -115,10 +129,27 @@ public:
      * @return errable<connection> Returns nullopt if opening failed, otherwise a new
      * connection
      */
-    [[nodiscard]] static errable<connection> open(neo::zstring_view s, openmode mode) noexcept;
+    [[nodiscard]] static errable<connection> open(neo::zstring_view s, openmode mode) noexcept {
+        return _open(s, mode, nullptr);
+    }
     [[nodiscard]] static errable<connection> open(neo::zstring_view s) noexcept {
         return open(s, openmode::readwrite | openmode::create);
     }
+    // To use: #include <neo/sqlite3/pragma.hpp>
+    /**
+     * @brief Open a new SQLite connection, then apply the given pragma profile with
+     * apply_profile(). If applying the profile fails, the connection is closed and the error is
+     * returned, so a connection is never returned with only some of the settings applied.
+     */
+    [[nodiscard]] static errable<connection>
+    open(neo::zstring_view s, openmode mode, const pragma_profile& profile) noexcept;
+    // To use: #include <neo/sqlite3/open_options.hpp>
+    /**
+     * @brief Open a new SQLite connection, and prepare it for use according to the given options.
+     * If any step fails, the connection is closed and the error is returned.
+     */
+    [[nodiscard]] static errable<connection> open(neo::zstring_view   s,
+                                                  const open_options& opts) noexcept;
     /// Create a new in-memory database
     [[nodiscard]] static errable<connection> create_memory_db() noexcept {
         return open(":memory:");
@@ -131,4 +162,14 @@ public:
 
 [[nodiscard]] inline auto open(neo::zstring_view path) { return connection::open(path); }
 
+// To use: #include <neo/sqlite3/pragma.hpp>
+[[nodiscard]] inline auto open(neo::zstring_view path, const pragma_profile& profile) {
+    return connection::open(path, openmode::readwrite | openmode::create, profile);
+}
+
+// To use: #include <neo/sqlite3/open_options.hpp>
+[[nodiscard]] inline auto open(neo::zstring_view path, const open_options& opts) {
+    return connection::open(path, opts);
+}
+
 }  // namespace neo::sqlite3
@@ -0,0 +1,54 @@
+#include "./connection_pool.hpp"
+
+#include <neo/assert.hpp>
+
+using namespace neo::sqlite3;
+
+connection_pool::connection_pool(std::vector<connection> conns) noexcept
+    : _idle(std::move(conns))
+    , _size(_idle.size()) {}
+
+connection_pool::~connection_pool() {
+    neo_assert_always(expects,
+                      _idle.size() == _size,
+                      "connection_pool was destroyed while connections were still leased",
+                      _idle.size(),
+                      _size);
+}
+
+void connection_pool::_return(connection&& db) noexcept {
+    {
+        std::unique_lock lk{_mutex};
+        // Cannot fail: The vector has already held every connection of the pool
+        _idle.push_back(std::move(db));
+    }
+    _cv.notify_one();
+}
+
+connection_pool::lease connection_pool::acquire() {
+    std::unique_lock lk{_mutex};
+    _cv.wait(lk, [&] { return !_idle.empty(); });
+    lease ret{*this, std::move(_idle.back())};
+    _idle.pop_back();
+    return ret;
+}
+
+std::optional<connection_pool::lease> connection_pool::try_acquire() {
+    return try_acquire_for(std::chrono::milliseconds{0});
+}
+
+std::optional<connection_pool::lease>
+connection_pool::try_acquire_for(std::chrono::milliseconds timeout) {
+    std::unique_lock lk{_mutex};
+    if (!_cv.wait_for(lk, timeout, [&] { return !_idle.empty(); })) {
+        return std::nullopt;
+    }
+    lease ret{*this, std::move(_idle.back())};
+    _idle.pop_back();
+    return ret;
+}
+
+std::size_t connection_pool::available() noexcept {
+    std::unique_lock lk{_mutex};
+    return _idle.size();
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <neo/sqlite3/connection.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace neo::sqlite3 {
+
+/**
+ * @brief A fixed set of connections that are leased to threads one at a time.
+ *
+ * A connection must only be used by one thread at a time. The pool hands out each of its
+ * connections as a lease, which returns the connection to the pool when it is destroyed.
+ *
+ * Every lease must be returned before the pool is destroyed.
+ */
+class connection_pool {
+    std::mutex              _mutex;
+    std::condition_variable _cv;
+    std::vector<connection> _idle;
+    std::size_t             _size = 0;
+
+    void _return(connection&& db) noexcept;
+
+public:
+    /**
+     * @brief Exclusive use of a connection of a connection_pool. Returns the connection to the
+     * pool when destroyed.
+     */
+    class lease {
+        connection_pool*          _pool = nullptr;
+        std::optional<connection> _db;
+
+        friend class connection_pool;
+        lease(connection_pool& pool, connection&& db) noexcept
+            : _pool(&pool)
+            , _db(std::move(db)) {}
+
+    public:
+        lease(lease&& o) noexcept
+            : _pool(o._pool)
+            , _db(std::exchange(o._db, std::nullopt)) {}
+
+        lease& operator=(lease&& o) noexcept {
+            std::swap(_pool, o._pool);
+            std::swap(_db, o._db);
+            return *this;
+        }
+
+        ~lease() {
+            if (_db) {
+                _pool->_return(std::move(*_db));
+            }
+        }
+
+        [[nodiscard]] connection& operator*() noexcept { return *_db; }
+        [[nodiscard]] connection* operator->() noexcept { return &*_db; }
+    };
+
+    /// Create a pool of the given connections
+    explicit connection_pool(std::vector<connection> conns) noexcept;
+    ~connection_pool();
+
+    connection_pool(const connection_pool&) = delete;
+    connection_pool& operator=(const connection_pool&) = delete;
+
+    /// Lease a connection, waiting until one is available
+    [[nodiscard]] lease acquire();
+    /// Lease a connection if one is available immediately
+    [[nodiscard]] std::optional<lease> try_acquire();
+    /// Lease a connection, waiting at most the given duration for one to become available
+    [[nodiscard]] std::optional<lease> try_acquire_for(std::chrono::milliseconds timeout);
+
+    /// The number of connections owned by the pool, whether leased or not
+    [[nodiscard]] std::size_t size() const noexcept { return _size; }
+    /// The number of connections that are not currently leased
+    [[nodiscard]] std::size_t available() noexcept;
+};
+
+}  // namespace neo::sqlite3
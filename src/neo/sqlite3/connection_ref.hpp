@@ -5,6 +5,9 @@
 
 #include <neo/zstring_view.hpp>
 
+#include <cstddef>
+#include <initializer_list>
+#include <span>
 #include <string_view>
 
 struct sqlite3;
@@ -28,6 +31,11 @@ extern "C" namespace c_api {
 class statement;
 class blob_io;
 enum class fn_flags;
+struct busy_policy;
+struct busy_stats;
+class statement_cache;
+class snapshot;
+class serialized_database;
 
 class connection_ref;
 
@@ -179,12 +187,105 @@ public:
     errable<void> attach(std::string_view db_name, std::string_view db_filename_or_uri) noexcept;
     errable<void> detach(std::string_view db_name) noexcept;
 
+    // To use: #include <neo/sqlite3/statement_cache.hpp>
+    /**
+     * @brief Obtain the statement cache that is owned by this connection. Statements may be
+     * prepared into this cache when the connection is opened (see open_options::warmup).
+     *
+     * The connection must have been opened by neo::sqlite3.
+     */
+    [[nodiscard]] statement_cache& statements();
+
+    // To use: #include <neo/sqlite3/busy_policy.hpp>
+    /**
+     * @brief Install a busy handler that waits for locks held by other connections according to
+     * the given policy. Replaces any existing busy handler or busy timeout.
+     *
+     * The connection must have been opened by neo::sqlite3.
+     */
+    void set_busy_policy(const busy_policy& policy);
+    /**
+     * @brief Obtain the lock contention counters of the busy handler of this connection.
+     *
+     * This function is safe to call from any thread while the connection is open.
+     */
+    [[nodiscard]] busy_stats busy_statistics() const noexcept;
+
+    // To use: #include <neo/sqlite3/snapshot.hpp>
+    /**
+     * @brief Take a snapshot of the current state of the given schema, which must be in WAL mode.
+     *
+     * The connection must have an open read transaction, and must not have written to the
+     * database within that transaction.
+     */
+    [[nodiscard]] errable<snapshot> get_snapshot(neo::zstring_view schema = "main") noexcept;
+    /**
+     * @brief Begin reading the given schema at the point in time of a snapshot taken from
+     * another connection to the same database.
+     *
+     * The connection must be within a transaction (e.g. a deferred transaction_guard) that has
+     * not yet read from the database. Until that transaction ends, reads on this connection
+     * will see the database as it was when the snapshot was taken.
+     */
+    [[nodiscard]] errable<void> open_snapshot(const snapshot&   snap,
+                                              neo::zstring_view schema = "main") noexcept;
+
+    // To use: #include <neo/sqlite3/serialize.hpp>
+    /**
+     * @brief Copy the content of the given schema into a new buffer. The copy has the same
+     * format as the database file.
+     *
+     * @return errc::error if the schema does not exist, or errc::no_memory if the buffer cannot
+     * be allocated.
+     */
+    [[nodiscard]] errable<serialized_database>
+    serialize(neo::zstring_view schema = "main") const noexcept;
+    /**
+     * @brief Obtain a view of the content of the given schema without copying it.
+     *
+     * This is only possible if the schema is an in-memory database that was created by
+     * deserialize() or deserialize_readonly(), or uses the "memdb" VFS. Otherwise, returns an
+     * empty span. The view is invalidated by any modification of the database.
+     */
+    [[nodiscard]] std::span<const std::byte>
+    serialized_view(neo::zstring_view schema = "main") const noexcept;
+    /**
+     * @brief Replace the given schema with an in-memory database holding the given content. The
+     * connection takes ownership of the buffer, and the database may be modified and grown.
+     *
+     * The database must not be in WAL mode, and the connection must not be in a transaction.
+     */
+    errable<void> deserialize(serialized_database&& data,
+                              neo::zstring_view     schema = "main") noexcept;
+    /**
+     * @brief Replace the given schema with a read-only in-memory database that reads directly
+     * from the given buffer, without copying it (e.g. from a mapped_file).
+     *
+     * The buffer must remain valid and unmodified until the schema is closed or replaced.
+     */
+    errable<void> deserialize_readonly(std::span<const std::byte> data,
+                                       neo::zstring_view          schema = "main") noexcept;
+
     // To use: #include <neo/sqlite3/function.hpp>
     template <typename Func>
     void register_function(neo::zstring_view, Func&& fn);
     template <typename Func>
     void register_function(neo::zstring_view, fn_flags, Func&& fn);
 
+    // To use: #include <neo/sqlite3/table_function.hpp>
+    template <typename Func>
+    void register_table_function(neo::zstring_view                       name,
+                                 std::initializer_list<std::string_view> columns,
+                                 Func&&                                  fn);
+
+    // To use: #include <neo/sqlite3/range_table.hpp>
+    template <typename Range, typename... Columns>
+    void register_range_table(neo::zstring_view name, Range&& range, Columns... columns);
+
+    // To use: #include <neo/sqlite3/collation.hpp>
+    template <typename Compare>
+    void register_collation(neo::zstring_view name, Compare&& cmp);
+
     /**
      * @brief Interupt any currently in-progress database operation.
      *
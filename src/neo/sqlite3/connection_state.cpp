@@ -0,0 +1,92 @@
+#include "./connection_state.hpp"
+
+#include <neo/sqlite3/connection_ref.hpp>
+#include <neo/sqlite3/errable.hpp>
+#include <neo/sqlite3/error.hpp>
+#include <neo/sqlite3/statement.hpp>
+
+#include <sqlite3/sqlite3.h>
+
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+using namespace neo::sqlite3;
+
+namespace {
+
+struct state_registry {
+    std::shared_mutex                                                              mutex;
+    std::unordered_map<::sqlite3*, std::unique_ptr<detail::connection_state>> states;
+};
+
+state_registry& registry() noexcept {
+    // Intentionally leaked, so that connections closed during static destruction are safe
+    static auto& reg = *new state_registry;
+    return reg;
+}
+
+}  // namespace
+
+detail::connection_state::connection_state(connection_ref db) noexcept
+    : _db(db.c_ptr())
+    , statements(db) {}
+
+detail::connection_state::~connection_state() {
+    // The busy handler refers to our state, so it must not outlive us. Other busy handlers and
+    // timeouts of the connection are left as they are
+    if (busy.installed) {
+        ::sqlite3_busy_handler(_db, nullptr, nullptr);
+    }
+}
+
+void detail::create_connection_state(::sqlite3* db) {
+    auto  state = std::make_unique<connection_state>(connection_ref(db));
+    auto& reg   = registry();
+
+    std::unique_lock lk{reg.mutex};
+    reg.states[db] = std::move(state);
+}
+
+void detail::drop_connection_state(::sqlite3* db) noexcept {
+    std::unique_ptr<connection_state> state;
+    auto&                             reg = registry();
+    {
+        std::unique_lock lk{reg.mutex};
+        auto             it = reg.states.find(db);
+        if (it == reg.states.end()) {
+            return;
+        }
+        state = std::move(it->second);
+        reg.states.erase(it);
+    }
+    // The state (and its statements) are destroyed outside of the lock
+}
+
+detail::connection_state* detail::get_connection_state(::sqlite3* db) noexcept {
+    auto&            reg = registry();
+    std::shared_lock lk{reg.mutex};
+    auto             it = reg.states.find(db);
+    return it == reg.states.end() ? nullptr : it->second.get();
+}
+
+statement_cache& connection_ref::statements() {
+    auto state = detail::get_connection_state(c_ptr());
+    if (!state) {
+        throw_error(make_error_code(errc::misuse),
+                    "Only connections opened by neo::sqlite3 have a statement cache",
+                    "The connection has no library-managed state");
+    }
+    return state->statements;
+}
+
+errable<void> detail::exec_cached(connection_ref db, sql_string_literal sql) {
+    auto state = get_connection_state(db.c_ptr());
+    if (!state) {
+        return db.prepare(sql.string())->run_to_completion();
+    }
+    auto& st  = state->statements(sql);
+    auto  rst = st.auto_reset();
+    return st.run_to_completion();
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <neo/sqlite3/busy_policy.hpp>
+#include <neo/sqlite3/literal.hpp>
+#include <neo/sqlite3/statement_cache.hpp>
+
+struct sqlite3;
+
+namespace neo::sqlite3 {
+
+class connection_ref;
+
+template <typename T>
+class errable;
+
+namespace detail {
+
+/**
+ * @brief Library-managed state that is associated with a connection.
+ *
+ * State is created for every connection opened with connection::open(), and is destroyed
+ * just before the connection is closed (or released). Connections that were adopted from a
+ * raw pointer have no associated state, so users of this state must have a fallback.
+ *
+ * Like the connection itself, this state must only be used by one thread at a time, except where
+ * noted otherwise.
+ */
+class connection_state {
+    ::sqlite3* _db;
+
+public:
+    explicit connection_state(connection_ref db) noexcept;
+    ~connection_state();
+
+    /// Statements prepared for internal use by the library (e.g. BEGIN and COMMIT)
+    statement_cache statements;
+    /// The state of the busy handler installed by connection_ref::set_busy_policy()
+    busy_handler_state busy;
+};
+
+/// Create the state for a newly opened connection
+void create_connection_state(::sqlite3* db);
+
+/// Destroy the state associated with the given connection, if it has any
+void drop_connection_state(::sqlite3* db) noexcept;
+
+/// Obtain the state associated with a connection, or nullptr if there is none
+[[nodiscard]] connection_state* get_connection_state(::sqlite3* db) noexcept;
+
+/**
+ * @brief Execute a statement from a string literal to completion, discarding any results.
+ *
+ * If the connection has state, the prepared statement will be cached in that state and reused by
+ * subsequent calls. Otherwise, the statement is prepared every time.
+ *
+ * @throws neo::sqlite3::error if the statement cannot be prepared. Errors from executing the
+ * statement are returned.
+ */
+errable<void> exec_cached(connection_ref db, sql_string_literal sql);
+
+}  // namespace detail
+
+}  // namespace neo::sqlite3
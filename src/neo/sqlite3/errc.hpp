@@ -115,6 +115,7 @@ enum class errc : int {
     constraint_unique           = 2067,
     constraint_vtab             = 2323,
     corrupt_vtab                = 267,
+    error_snapshot              = 769,
     ioerr_access                = 3338,
     ioerr_blocked               = 2826,
     ioerr_check_reserved_lock   = 3594,
@@ -108,6 +108,7 @@ void neo::sqlite3::throw_error(const std::error_code& ec,
         CASE(constraint_unique);
         CASE(constraint_vtab);
         CASE(corrupt_vtab);
+        CASE(error_snapshot);
         CASE(ioerr_access);
         CASE(ioerr_blocked);
         CASE(ioerr_check_reserved_lock);
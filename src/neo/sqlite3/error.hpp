@@ -111,6 +111,9 @@ inline void set_error_code(std::error_code& ec, int sqlite_errc) {
     case errc::corrupt:
     case errc::corrupt_vtab:
         return errcond::corrupt;
+    case errc::error:
+    case errc::error_snapshot:
+        return errcond::error;
     case errc::locked:
     case errc::locked_vtab:
     case errc::locked_sharedcache:
@@ -136,8 +139,6 @@ inline void set_error_code(std::error_code& ec, int sqlite_errc) {
         return errcond::done;
     case errc::empty:
         return errcond::empty;
-    case errc::error:
-        return errcond::error;
     case errc::format:
         return errcond::format;
     case errc::full:
@@ -33,27 +33,31 @@ void invoke_fn_wrapper_shared_ptr(::sqlite3_context* context,
 
 }  // namespace
 
-void detail::fn_wrapper_base::set_result(sqlite3_context* ctx, null_t) noexcept {
+void detail::set_result(sqlite3_context* ctx, null_t) noexcept {
     ::sqlite3_result_null(ctx);
 }
 
-void detail::fn_wrapper_base::set_result(sqlite3_context* ctx, int n) noexcept {
+void detail::set_result(sqlite3_context* ctx, int n) noexcept {
     ::sqlite3_result_int(ctx, n);
 }
 
-void detail::fn_wrapper_base::set_result(sqlite3_context* ctx, std::int64_t i) noexcept {
+void detail::set_result(sqlite3_context* ctx, std::int64_t i) noexcept {
     ::sqlite3_result_int64(ctx, i);
 }
 
-void detail::fn_wrapper_base::set_result(sqlite3_context* ctx, double d) noexcept {
+void detail::set_result(sqlite3_context* ctx, double d) noexcept {
     ::sqlite3_result_double(ctx, d);
 }
 
-void detail::fn_wrapper_base::set_result(sqlite3_context* ctx, std::string_view str) noexcept {
+void detail::set_result(sqlite3_context* ctx, std::string_view str) noexcept {
     ::sqlite3_result_text64(ctx, str.data(), str.size(), SQLITE_TRANSIENT, SQLITE_UTF8);
 }
 
-void detail::fn_wrapper_base::set_result(sqlite3_context* ctx, value_ref value) noexcept {
+void detail::set_result(sqlite3_context* ctx, blob_view blob) noexcept {
+    ::sqlite3_result_blob64(ctx, blob.data(), blob.size(), SQLITE_TRANSIENT);
+}
+
+void detail::set_result(sqlite3_context* ctx, value_ref value) noexcept {
     ::sqlite3_result_value(ctx, value.c_ptr());
 }
 
@@ -8,7 +8,9 @@
 #include <neo/function_traits.hpp>
 #include <neo/fwd.hpp>
 
+#include <concepts>
 #include <memory>
+#include <string_view>
 #include <tuple>
 #include <type_traits>
 #include <utility>
@@ -19,6 +21,55 @@ namespace neo::sqlite3 {
 
 namespace detail {
 
+void set_result(sqlite3_context* ctx, null_t) noexcept;
+void set_result(sqlite3_context* ctx, int) noexcept;
+void set_result(sqlite3_context* ctx, std::int64_t) noexcept;
+void set_result(sqlite3_context* ctx, double) noexcept;
+void set_result(sqlite3_context* ctx, std::string_view) noexcept;
+void set_result(sqlite3_context* ctx, blob_view) noexcept;
+void set_result(sqlite3_context* ctx, value_ref) noexcept;
+
+/**
+ * @brief Set the result of a function (or virtual table column) from an arbitrary C++ value.
+ *
+ * Normalizes the value to one of the `set_result` overloads: Integers (including `bool`) become
+ * 64-bit integers, floats become doubles, strings become text, and empty optionals become NULL.
+ */
+template <typename T>
+void assign_result(sqlite3_context* ctx, const T& value) noexcept {
+    if constexpr (std::same_as<T, null_t> || std::same_as<T, value_ref>
+                  || std::same_as<T, blob_view>) {
+        set_result(ctx, value);
+    } else if constexpr (std::integral<T>) {
+        set_result(ctx, static_cast<std::int64_t>(value));
+    } else if constexpr (std::floating_point<T>) {
+        set_result(ctx, static_cast<double>(value));
+    } else if constexpr (std::convertible_to<const T&, std::string_view>) {
+        set_result(ctx, std::string_view(value));
+    } else if constexpr (requires { value.has_value(); *value; }) {
+        if (value.has_value()) {
+            assign_result(ctx, *value);
+        } else {
+            set_result(ctx, null);
+        }
+    } else {
+        static_assert(std::same_as<T, void>,
+                      "Unable to convert the given type to a SQLite result value");
+    }
+}
+
+/**
+ * @brief Convert a SQLite function argument to the given type.
+ */
+template <typename T>
+T get_arg(sqlite3_value* ptr) {
+    if constexpr (std::same_as<T, value_ref>) {
+        return value_ref(ptr);
+    } else {
+        return value_ref(ptr).as<T>();
+    }
+}
+
 class fn_wrapper_base {
 public:
     void invoke(sqlite3_context* ctx, int argc, sqlite3_value** argv) noexcept;
@@ -28,13 +79,6 @@ public:
 protected:
     virtual void do_invoke(sqlite3_context* ctx, int argc, sqlite3_value** argv) = 0;
     virtual int  arg_count() const noexcept                                      = 0;
-
-    void set_result(sqlite3_context* ctx, null_t) noexcept;
-    void set_result(sqlite3_context* ctx, int) noexcept;
-    void set_result(sqlite3_context* ctx, std::int64_t) noexcept;
-    void set_result(sqlite3_context* ctx, double) noexcept;
-    void set_result(sqlite3_context* ctx, std::string_view) noexcept;
-    void set_result(sqlite3_context* ctx, value_ref) noexcept;
 };
 
 template <typename Func, typename ArgTypesTag>
@@ -50,18 +94,9 @@ public:
 private:
     Func _fn;
 
-    template <typename T>
-    T _get_arg(sqlite3_value* ptr) {
-        if constexpr (std::same_as<T, value_ref>) {
-            return value_ref(ptr);
-        } else {
-            return value_ref(ptr).as<T>();
-        }
-    }
-
     template <std::size_t... Is>
     std::tuple<ArgTypes...> _get_args(sqlite3_value** argv, std::index_sequence<Is...>) {
-        return std::tuple<ArgTypes...>(_get_arg<ArgTypes>(argv[Is])...);
+        return std::tuple<ArgTypes...>(get_arg<ArgTypes>(argv[Is])...);
     }
 
     void do_invoke(sqlite3_context* ctx, int argc, sqlite3_value** argv) override {
@@ -79,7 +114,7 @@ private:
             set_result(ctx, null);
         } else {
             auto result = std::apply(_fn, args_tup);
-            set_result(ctx, result);
+            assign_result(ctx, result);
         }
     }
 
@@ -0,0 +1,764 @@
+#include "./hybrid_vfs.hpp"
+
+#include <neo/event.hpp>
+
+#include <sqlite3/sqlite3.h>
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace neo::sqlite3;
+
+namespace {
+
+using clock = std::chrono::steady_clock;
+
+constexpr auto block_size = static_cast<std::int64_t>(hybrid_vfs::block_size);
+
+/// The header of a redo log
+struct redo_header {
+    char          magic[16];
+    std::uint32_t version;
+    std::uint32_t block_size;
+    std::uint64_t n_blocks;
+    std::uint64_t file_size;
+};
+
+constexpr char          redo_magic[16] = {'n', 'e', 'o', '-', 's', 'q', 'l', 'i',
+                                          't', 'e', '3', '-', 'r', 'e', 'd', 'o'};
+constexpr std::uint32_t redo_version   = 1;
+
+/// The size of each entry of a redo log: the block index, followed by the block
+constexpr std::int64_t redo_entry_size = sizeof(std::uint64_t) + block_size;
+
+/// An FNV-1a hash, which detects a redo log that was not completely written
+struct checksum {
+    std::uint64_t value = 0xcbf29ce484222325;
+
+    void update(const void* data, std::size_t size) noexcept {
+        auto bytes = static_cast<const unsigned char*>(data);
+        for (auto i = 0u; i < size; ++i) {
+            value = (value ^ bytes[i]) * 0x100000001b3;
+        }
+    }
+};
+
+std::string redo_path(std::string_view db_path) { return std::string(db_path) + "-hybrid-redo"; }
+
+#ifndef _WIN32
+
+bool pread_all(int fd, void* buf, std::size_t size, std::int64_t offset) noexcept {
+    auto out = static_cast<char*>(buf);
+    while (size) {
+        auto n = ::pread(fd, out, size, offset);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        } else if (n <= 0) {
+            return false;
+        }
+        out += n;
+        size -= static_cast<std::size_t>(n);
+        offset += n;
+    }
+    return true;
+}
+
+bool pwrite_all(int fd, const void* buf, std::size_t size, std::int64_t offset) noexcept {
+    auto in = static_cast<const char*>(buf);
+    while (size) {
+        auto n = ::pwrite(fd, in, size, offset);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        } else if (n <= 0) {
+            return false;
+        }
+        in += n;
+        size -= static_cast<std::size_t>(n);
+        offset += n;
+    }
+    return true;
+}
+
+/// Sync the directory that contains the given file, so that its creation or removal is durable
+void sync_parent_dir(const std::string& path) noexcept {
+    auto slash = path.rfind('/');
+    auto dir   = slash == std::string::npos ? std::string(".") : path.substr(0, slash + 1);
+    auto fd    = ::open(dir.data(), O_RDONLY | O_CLOEXEC);
+    if (fd >= 0) {
+        ::fsync(fd);
+        ::close(fd);
+    }
+}
+
+#endif
+
+/// The state of an in-memory rollback journal
+struct journal_state : vfs_shim::file_state {
+    std::vector<std::byte> data;
+
+    static journal_state* of(vfs_shim::file& f) noexcept {
+        return dynamic_cast<journal_state*>(f.state());
+    }
+};
+
+}  // namespace
+
+/**
+ * @brief The in-memory content of a database that is open through a hybrid_vfs, shared by every
+ * connection to it.
+ */
+class neo::sqlite3::hybrid_image {
+public:
+    const std::string path;
+    const int         fd;
+    const bool        writable;
+
+    /// The number of files that refer to this image. Guarded by the mutex of the VFS
+    std::size_t n_files = 1;
+
+    /// Guards the content of the image
+    std::mutex mutex;
+    /// Notified when the last write transaction finishes
+    std::condition_variable cv;
+    /// The blocks of the database. A null block is all zeros
+    std::vector<std::unique_ptr<std::byte[]>> blocks;
+    /// Blocks that have been written since the last flush
+    std::vector<bool> dirty;
+    std::int64_t      size = 0;
+    /// Set if the database was truncated since the last flush
+    bool size_changed = false;
+    /// The number of files that hold an EXCLUSIVE lock, i.e. are writing a transaction
+    int n_writers = 0;
+
+    /// Serializes flushes
+    std::mutex flush_mutex;
+    /**
+     * @brief Set when the last file that refers to the image is closed. After that, the
+     * descriptor may not be used by flushes that started earlier. Guarded by flush_mutex
+     */
+    bool closed = false;
+
+    hybrid_image(std::string p, int fd, bool writable)
+        : path(std::move(p))
+        , fd(fd)
+        , writable(writable) {}
+
+    int read(void* buf, int amount, std::int64_t offset) noexcept {
+        std::lock_guard lk{mutex};
+        auto            out = static_cast<std::byte*>(buf);
+        const auto n_avail  = std::clamp(size - offset, std::int64_t(0), std::int64_t(amount));
+        for (std::int64_t done = 0; done < n_avail;) {
+            const auto pos   = offset + done;
+            const auto idx   = static_cast<std::size_t>(pos / block_size);
+            const auto inner = pos % block_size;
+            const auto n     = (std::min)(n_avail - done, block_size - inner);
+            if (blocks[idx]) {
+                std::memcpy(out + done, blocks[idx].get() + inner, static_cast<std::size_t>(n));
+            } else {
+                std::memset(out + done, 0, static_cast<std::size_t>(n));
+            }
+            done += n;
+        }
+        if (n_avail < amount) {
+            std::memset(out + n_avail, 0, static_cast<std::size_t>(amount - n_avail));
+            return SQLITE_IOERR_SHORT_READ;
+        }
+        return SQLITE_OK;
+    }
+
+    int write(const void* buf, int amount, std::int64_t offset) noexcept {
+        std::lock_guard lk{mutex};
+        auto            in = static_cast<const std::byte*>(buf);
+        try {
+            const auto n_blocks = static_cast<std::size_t>((offset + amount + block_size - 1)
+                                                           / block_size);
+            if (blocks.size() < n_blocks) {
+                blocks.resize(n_blocks);
+                dirty.resize(n_blocks);
+            }
+            for (std::int64_t done = 0; done < amount;) {
+                const auto pos   = offset + done;
+                const auto idx   = static_cast<std::size_t>(pos / block_size);
+                const auto inner = pos % block_size;
+                const auto n     = (std::min)(std::int64_t(amount) - done, block_size - inner);
+                if (!blocks[idx]) {
+                    blocks[idx].reset(new std::byte[block_size]());
+                }
+                std::memcpy(blocks[idx].get() + inner, in + done, static_cast<std::size_t>(n));
+                dirty[idx] = true;
+                done += n;
+            }
+        } catch (const std::bad_alloc&) {
+            return SQLITE_IOERR_NOMEM;
+        }
+        size = (std::max)(size, offset + amount);
+        return SQLITE_OK;
+    }
+
+    int truncate(std::int64_t new_size) noexcept {
+        std::lock_guard lk{mutex};
+        const auto n_blocks = static_cast<std::size_t>((new_size + block_size - 1) / block_size);
+        try {
+            blocks.resize(n_blocks);
+            dirty.resize(n_blocks);
+        } catch (const std::bad_alloc&) {
+            return SQLITE_IOERR_NOMEM;
+        }
+        if (new_size >= size) {
+            // Growing a file leaves a hole of zeros
+            size         = new_size;
+            size_changed = true;
+            return SQLITE_OK;
+        }
+        if (const auto inner = new_size % block_size; inner && blocks.back()) {
+            // Later reads of the truncated part of the last block must see zeros
+            std::memset(blocks.back().get() + inner,
+                        0,
+                        static_cast<std::size_t>(block_size - inner));
+        }
+        size         = new_size;
+        size_changed = true;
+        return SQLITE_OK;
+    }
+
+    /**
+     * @brief Replay the redo log of an interrupted flush, if it is complete, and then delete it.
+     */
+    int recover() noexcept {
+#ifndef _WIN32
+        std::string log_path;
+        try {
+            log_path = redo_path(path);
+        } catch (const std::bad_alloc&) {
+            return SQLITE_NOMEM;
+        }
+        auto log_fd = ::open(log_path.data(), O_RDONLY | O_CLOEXEC);
+        if (log_fd < 0) {
+            return errno == ENOENT ? SQLITE_OK : SQLITE_CANTOPEN;
+        }
+        int         rc = SQLITE_OK;
+        redo_header header;
+        bool        valid = pread_all(log_fd, &header, sizeof header, 0)
+            && std::memcmp(header.magic, redo_magic, sizeof redo_magic) == 0
+            && header.version == redo_version && header.block_size == block_size;
+        std::unique_ptr<std::byte[]> entry;
+        if (valid) {
+            entry.reset(new (std::nothrow) std::byte[redo_entry_size]);
+            valid = entry != nullptr;
+        }
+        // First check that the log was completely written
+        const auto trailer_offset = std::int64_t(sizeof header)
+            + static_cast<std::int64_t>(header.n_blocks) * redo_entry_size;
+        if (valid) {
+            checksum sum;
+            sum.update(&header, sizeof header);
+            for (auto i = 0u; valid && i < header.n_blocks; ++i) {
+                valid = pread_all(log_fd,
+                                  entry.get(),
+                                  redo_entry_size,
+                                  std::int64_t(sizeof header) + i * redo_entry_size);
+                sum.update(entry.get(), redo_entry_size);
+            }
+            std::uint64_t expected = 0;
+            valid = valid && pread_all(log_fd, &expected, sizeof expected, trailer_offset)
+                && expected == sum.value;
+        }
+        // Then apply it
+        if (valid) {
+            if (!writable) {
+                ::close(log_fd);
+                return SQLITE_READONLY_ROLLBACK;
+            }
+            for (auto i = 0u; rc == SQLITE_OK && i < header.n_blocks; ++i) {
+                std::uint64_t idx = 0;
+                if (!pread_all(log_fd,
+                               entry.get(),
+                               redo_entry_size,
+                               std::int64_t(sizeof header) + i * redo_entry_size)) {
+                    rc = SQLITE_IOERR_READ;
+                    break;
+                }
+                std::memcpy(&idx, entry.get(), sizeof idx);
+                const auto offset = static_cast<std::int64_t>(idx * block_size);
+                const auto n      = std::clamp(std::int64_t(header.file_size) - offset,
+                                          std::int64_t(0),
+                                          std::int64_t(block_size));
+                const auto data   = entry.get() + sizeof idx;
+                if (!pwrite_all(fd, data, static_cast<std::size_t>(n), offset)) {
+                    rc = SQLITE_IOERR_WRITE;
+                }
+            }
+            if (rc == SQLITE_OK
+                && (::ftruncate(fd, static_cast<::off_t>(header.file_size)) != 0
+                    || ::fsync(fd) != 0)) {
+                rc = SQLITE_IOERR_FSYNC;
+            }
+        }
+        ::close(log_fd);
+        if (rc == SQLITE_OK) {
+            ::unlink(log_path.data());
+            sync_parent_dir(log_path);
+        }
+        return rc;
+#else
+        return SQLITE_OK;
+#endif
+    }
+
+    /// Read the database file into memory
+    int load(std::atomic<std::uint64_t>& bytes_loaded) noexcept {
+#ifndef _WIN32
+        struct ::stat st;
+        if (::fstat(fd, &st) != 0) {
+            return SQLITE_IOERR_FSTAT;
+        }
+        std::lock_guard lk{mutex};
+        try {
+            const auto n_blocks = static_cast<std::size_t>((st.st_size + block_size - 1)
+                                                           / block_size);
+            blocks.resize(n_blocks);
+            dirty.resize(n_blocks);
+            size = st.st_size;
+            for (auto i = 0u; i < n_blocks; ++i) {
+                blocks[i].reset(new std::byte[block_size]());
+                const auto offset = std::int64_t(i) * block_size;
+                const auto n      = (std::min)(size - offset, block_size);
+                if (!pread_all(fd, blocks[i].get(), static_cast<std::size_t>(n), offset)) {
+                    return SQLITE_IOERR_READ;
+                }
+            }
+        } catch (const std::bad_alloc&) {
+            return SQLITE_NOMEM;
+        }
+        bytes_loaded.fetch_add(static_cast<std::uint64_t>(size), std::memory_order_relaxed);
+        // Bytes 18 and 19 of the database header are 2 in WAL mode. Switch to rollback-journal mode
+        if (size >= 20 && blocks[0][18] == std::byte{2} && blocks[0][19] == std::byte{2}) {
+            blocks[0][18] = blocks[0][19] = std::byte{1};
+            dirty[0]                      = true;
+        }
+        return SQLITE_OK;
+#else
+        return SQLITE_CANTOPEN;
+#endif
+    }
+};
+
+namespace {
+
+/// The state of a database file opened through a hybrid_vfs
+struct main_db_state : vfs_shim::file_state {
+    std::shared_ptr<hybrid_image> image;
+    int                           lock_level = SQLITE_LOCK_NONE;
+
+    static main_db_state* of(vfs_shim::file& f) noexcept {
+        return dynamic_cast<main_db_state*>(f.state());
+    }
+};
+
+}  // namespace
+
+hybrid_vfs::hybrid_vfs(hybrid_vfs_options opts)
+    : vfs_shim(opts.name, opts.base)
+    , _opts(std::move(opts)) {
+    if (_opts.flush_interval.count() > 0) {
+        _thread = std::thread{[this] { _run(); }};
+    }
+}
+
+hybrid_vfs::~hybrid_vfs() {
+    if (_thread.joinable()) {
+        {
+            std::unique_lock lk{_mutex};
+            _stopping = true;
+        }
+        _cv.notify_one();
+        _thread.join();
+    }
+}
+
+hybrid_vfs_stats hybrid_vfs::stats() const noexcept {
+    return {
+        .n_flushes        = _n_flushes.load(std::memory_order_relaxed),
+        .n_failed_flushes = _n_failed_flushes.load(std::memory_order_relaxed),
+        .blocks_flushed   = _blocks_flushed.load(std::memory_order_relaxed),
+        .bytes_loaded     = _bytes_loaded.load(std::memory_order_relaxed),
+    };
+}
+
+void hybrid_vfs::_run() noexcept {
+    while (true) {
+        {
+            std::unique_lock lk{_mutex};
+            _cv.wait_for(lk, _opts.flush_interval, [&] { return _stopping; });
+            if (_stopping) {
+                return;
+            }
+        }
+        // Errors are reported by events, and the blocks are written by the next flush
+        static_cast<void>(flush());
+    }
+}
+
+errable<void> hybrid_vfs::flush() noexcept {
+    std::vector<std::shared_ptr<hybrid_image>> images;
+    try {
+        std::lock_guard lk{_images_mutex};
+        images = _images;
+    } catch (const std::bad_alloc&) {
+        return {errc::no_memory, "Failed to flush a hybrid database"};
+    }
+    auto rc = errc::ok;
+    for (auto& img : images) {
+        auto img_rc = _flush(*img);
+        if (rc == errc::ok) {
+            rc = img_rc;
+        }
+    }
+    if (rc != errc::ok) {
+        return {rc, "Failed to flush a hybrid database"};
+    }
+    return errc::ok;
+}
+
+errc hybrid_vfs::_flush(hybrid_image& img) noexcept {
+#ifndef _WIN32
+    if (!img.writable) {
+        return errc::ok;
+    }
+    std::lock_guard flush_lk{img.flush_mutex};
+    if (img.closed) {
+        // The last connection was closed, and has already flushed the database
+        return errc::ok;
+    }
+    const auto start = clock::now();
+
+    // Copy the dirty blocks between transactions
+    std::vector<std::pair<std::uint64_t, std::unique_ptr<std::byte[]>>> copies;
+    std::int64_t                                                         size = 0;
+    {
+        std::unique_lock lk{img.mutex};
+        if (!img.cv.wait_for(lk, _opts.busy_timeout, [&] { return img.n_writers == 0; })) {
+            return errc::busy;
+        }
+        const auto n_dirty = std::ranges::count(img.dirty, true);
+        if (n_dirty == 0 && !img.size_changed) {
+            return errc::ok;
+        }
+        try {
+            copies.reserve(static_cast<std::size_t>(n_dirty));
+            for (auto i = 0u; i < img.dirty.size(); ++i) {
+                if (!img.dirty[i]) {
+                    continue;
+                }
+                auto& copy = copies.emplace_back(i, new std::byte[block_size]()).second;
+                if (img.blocks[i]) {
+                    std::memcpy(copy.get(), img.blocks[i].get(), block_size);
+                }
+            }
+        } catch (const std::bad_alloc&) {
+            return errc::no_memory;
+        }
+        std::fill(img.dirty.begin(), img.dirty.end(), false);
+        img.size_changed = false;
+        size             = img.size;
+    }
+
+    // Write the redo log, then the database, then delete the log
+    auto rc = errc::ok;
+    try {
+        const auto log_path = redo_path(img.path);
+        const auto log_fd
+            = ::open(log_path.data(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (log_fd < 0) {
+            rc = errc::cant_open;
+        } else {
+            redo_header header{};
+            std::memcpy(header.magic, redo_magic, sizeof redo_magic);
+            header.version    = redo_version;
+            header.block_size = static_cast<std::uint32_t>(block_size);
+            header.n_blocks   = copies.size();
+            header.file_size  = static_cast<std::uint64_t>(size);
+            checksum sum;
+            sum.update(&header, sizeof header);
+            bool ok = pwrite_all(log_fd, &header, sizeof header, 0);
+            auto pos = std::int64_t(sizeof header);
+            for (auto& [idx, data] : copies) {
+                sum.update(&idx, sizeof idx);
+                sum.update(data.get(), block_size);
+                ok = ok && pwrite_all(log_fd, &idx, sizeof idx, pos)
+                    && pwrite_all(log_fd, data.get(), block_size, pos + sizeof idx);
+                pos += redo_entry_size;
+            }
+            ok = ok && pwrite_all(log_fd, &sum.value, sizeof sum.value, pos)
+                && ::fsync(log_fd) == 0;
+            ::close(log_fd);
+            if (!ok) {
+                rc = errc::ioerr_write;
+            }
+        }
+        if (rc == errc::ok) {
+            // The log is durable. The flush is now certain to take effect, even after a crash
+            sync_parent_dir(log_path);
+            for (auto& [idx, data] : copies) {
+                const auto offset = static_cast<std::int64_t>(idx * block_size);
+                const auto n = std::clamp(size - offset, std::int64_t(0), std::int64_t(block_size));
+                if (!pwrite_all(img.fd, data.get(), static_cast<std::size_t>(n), offset)) {
+                    rc = errc::ioerr_write;
+                    break;
+                }
+            }
+            if (rc == errc::ok
+                && (::ftruncate(img.fd, static_cast<::off_t>(size)) != 0
+                    || ::fsync(img.fd) != 0)) {
+                rc = errc::ioerr_fsync;
+            }
+            if (rc == errc::ok) {
+                ::unlink(log_path.data());
+                sync_parent_dir(log_path);
+            }
+        }
+    } catch (const std::bad_alloc&) {
+        rc = errc::no_memory;
+    }
+
+    if (rc != errc::ok) {
+        // Write the blocks again in the next flush
+        std::lock_guard lk{img.mutex};
+        for (auto& [idx, data] : copies) {
+            if (idx < img.dirty.size()) {
+                img.dirty[idx] = true;
+            }
+        }
+        img.size_changed = true;
+        _n_failed_flushes.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        _n_flushes.fetch_add(1, std::memory_order_relaxed);
+        _blocks_flushed.fetch_add(copies.size(), std::memory_order_relaxed);
+    }
+
+    try {
+        neo::emit(event::hybrid_flush{
+            .path     = img.path,
+            .ec       = rc,
+            .n_blocks = copies.size(),
+            .size     = size,
+            .duration = clock::now() - start,
+        });
+    } catch (...) {
+        // The flush has already finished
+    }
+    return rc;
+#else
+    return errc::ok;
+#endif
+}
+
+int hybrid_vfs::on_open(file& f) noexcept {
+    if (f.kind() == file_kind::journal) {
+        try {
+            f.set_state(std::make_unique<journal_state>());
+        } catch (const std::bad_alloc&) {
+            return SQLITE_NOMEM;
+        }
+        return SQLITE_OK;
+    } else if (f.kind() != file_kind::main_db) {
+        return SQLITE_OK;
+    }
+    const auto fd = f.path() ? f.posix_fd() : -1;
+    if (fd < 0) {
+        return SQLITE_CANTOPEN;
+    }
+    try {
+        auto            st = std::make_unique<main_db_state>();
+        std::lock_guard lk{_images_mutex};
+        auto it = std::ranges::find_if(_images, [&](auto& img) { return img->path == f.path(); });
+        if (it != _images.end()) {
+            st->image = *it;
+            ++st->image->n_files;
+        } else {
+#ifndef _WIN32
+            // Loading would discard the transactions that are only in the WAL
+            struct ::stat wal_st;
+            if (::stat((std::string(f.path()) + "-wal").data(), &wal_st) == 0
+                && wal_st.st_size > 0) {
+                return SQLITE_CANTOPEN;
+            }
+#endif
+            auto img = std::make_shared<hybrid_image>(f.path(), fd, f.posix_fd_writable());
+            if (auto rc = img->recover()) {
+                return rc;
+            }
+            if (auto rc = img->load(_bytes_loaded)) {
+                return rc;
+            }
+            _images.push_back(img);
+            st->image = std::move(img);
+        }
+        f.set_state(std::move(st));
+    } catch (const std::bad_alloc&) {
+        return SQLITE_NOMEM;
+    }
+    return SQLITE_OK;
+}
+
+int hybrid_vfs::close(file& f) noexcept {
+    auto st = main_db_state::of(f);
+    if (!st) {
+        return f.close();
+    }
+    if (st->lock_level == SQLITE_LOCK_EXCLUSIVE) {
+        std::lock_guard lk{st->image->mutex};
+        --st->image->n_writers;
+        st->image->cv.notify_all();
+    }
+    bool last = false;
+    {
+        std::lock_guard lk{_images_mutex};
+        last = --st->image->n_files == 0;
+        if (last) {
+            std::erase(_images, st->image);
+        }
+    }
+    auto rc = SQLITE_OK;
+    if (last) {
+        // Nothing else will flush the database
+        rc = static_cast<int>(_flush(*st->image));
+        // A flush that started before the image was removed (e.g. on the VFS's thread) must not
+        // write to the file after it is closed
+        std::lock_guard flush_lk{st->image->flush_mutex};
+        st->image->closed = true;
+    }
+    auto close_rc = f.close();
+    return rc ? rc : close_rc;
+}
+
+int hybrid_vfs::read(file& f, void* buf, int amount, std::int64_t offset) noexcept {
+    if (auto st = main_db_state::of(f)) {
+        return st->image->read(buf, amount, offset);
+    } else if (auto j = journal_state::of(f)) {
+        const auto n = std::clamp(std::int64_t(j->data.size()) - offset,
+                                  std::int64_t(0),
+                                  std::int64_t(amount));
+        if (n > 0) {
+            std::memcpy(buf, j->data.data() + offset, static_cast<std::size_t>(n));
+        }
+        if (n < amount) {
+            std::memset(static_cast<std::byte*>(buf) + n, 0, static_cast<std::size_t>(amount - n));
+            return SQLITE_IOERR_SHORT_READ;
+        }
+        return SQLITE_OK;
+    }
+    return f.read(buf, amount, offset);
+}
+
+int hybrid_vfs::write(file& f, const void* buf, int amount, std::int64_t offset) noexcept {
+    if (auto st = main_db_state::of(f)) {
+        return st->image->write(buf, amount, offset);
+    } else if (auto j = journal_state::of(f)) {
+        try {
+            const auto end = static_cast<std::size_t>(offset + amount);
+            if (j->data.size() < end) {
+                j->data.resize(end);
+            }
+        } catch (const std::bad_alloc&) {
+            return SQLITE_IOERR_NOMEM;
+        }
+        std::memcpy(j->data.data() + offset, buf, static_cast<std::size_t>(amount));
+        return SQLITE_OK;
+    }
+    return f.write(buf, amount, offset);
+}
+
+int hybrid_vfs::truncate(file& f, std::int64_t size) noexcept {
+    if (auto st = main_db_state::of(f)) {
+        return st->image->truncate(size);
+    } else if (auto j = journal_state::of(f)) {
+        if (static_cast<std::size_t>(size) < j->data.size()) {
+            j->data.resize(static_cast<std::size_t>(size));
+        }
+        return SQLITE_OK;
+    }
+    return f.truncate(size);
+}
+
+int hybrid_vfs::sync(file& f, int flags) noexcept {
+    if (f.state()) {
+        // Durability comes from flushes
+        return SQLITE_OK;
+    }
+    return f.sync(flags);
+}
+
+int hybrid_vfs::file_size(file& f, std::int64_t& size) noexcept {
+    if (auto st = main_db_state::of(f)) {
+        std::lock_guard lk{st->image->mutex};
+        size = st->image->size;
+        return SQLITE_OK;
+    } else if (auto j = journal_state::of(f)) {
+        size = static_cast<std::int64_t>(j->data.size());
+        return SQLITE_OK;
+    }
+    return f.file_size(size);
+}
+
+int hybrid_vfs::lock(file& f, int level) noexcept {
+    auto rc = f.lock(level);
+    auto st = main_db_state::of(f);
+    if (rc == SQLITE_OK && st) {
+        if (level == SQLITE_LOCK_EXCLUSIVE && st->lock_level != SQLITE_LOCK_EXCLUSIVE) {
+            // The connection is about to write a transaction
+            std::lock_guard lk{st->image->mutex};
+            ++st->image->n_writers;
+        }
+        st->lock_level = (std::max)(st->lock_level, level);
+    }
+    return rc;
+}
+
+int hybrid_vfs::unlock(file& f, int level) noexcept {
+    auto st = main_db_state::of(f);
+    if (st) {
+        if (st->lock_level == SQLITE_LOCK_EXCLUSIVE && level < SQLITE_LOCK_EXCLUSIVE) {
+            // The transaction has been committed (or rolled back)
+            std::lock_guard lk{st->image->mutex};
+            --st->image->n_writers;
+            st->image->cv.notify_all();
+        }
+        st->lock_level = (std::min)(st->lock_level, level);
+    }
+    return f.unlock(level);
+}
+
+int hybrid_vfs::file_control(file& f, int op, void* arg) noexcept {
+    if (!main_db_state::of(f)) {
+        return f.file_control(op, arg);
+    }
+    if (op == SQLITE_FCNTL_PRAGMA) {
+        auto args = static_cast<char**>(arg);
+        if (::sqlite3_stricmp(args[1], "journal_mode") == 0 && args[2]
+            && ::sqlite3_stricmp(args[2], "wal") == 0) {
+            args[0] = ::sqlite3_mprintf("WAL mode is not supported by a hybrid_vfs");
+            return SQLITE_ERROR;
+        }
+    } else if (op == SQLITE_FCNTL_SIZE_HINT) {
+        // The size of the file on disk is only changed by flushes
+        return SQLITE_OK;
+    }
+    return f.file_control(op, arg);
+}
+
+int hybrid_vfs::fetch(file& f, std::int64_t offset, int amount, void** pp) noexcept {
+    if (main_db_state::of(f)) {
+        // Memory-mapping the file would bypass the in-memory database
+        *pp = nullptr;
+        return SQLITE_OK;
+    }
+    return f.fetch(offset, amount, pp);
+}
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <neo/sqlite3/errable.hpp>
+#include <neo/sqlite3/errc.hpp>
+#include <neo/sqlite3/vfs.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace neo::sqlite3 {
+
+class hybrid_image;
+
+/**
+ * @brief Options for a hybrid_vfs
+ */
+struct hybrid_vfs_options {
+    /// The name with which to register the VFS
+    std::string name = "neo-hybrid";
+    /// The name of the VFS to wrap. If empty, wraps the default VFS
+    std::string base;
+    /**
+     * @brief Flush the dirty pages of each database to disk at this interval. If zero, databases
+     * are only flushed by hybrid_vfs::flush(), and when their last connection is closed.
+     */
+    std::chrono::milliseconds flush_interval{std::chrono::seconds{1}};
+    /// The longest that a flush will wait for a write transaction to finish
+    std::chrono::milliseconds busy_timeout{std::chrono::seconds{5}};
+};
+
+/**
+ * @brief Counters of the flushes run by a hybrid_vfs
+ */
+struct hybrid_vfs_stats {
+    /// The number of flushes that wrote to disk
+    std::uint64_t n_flushes = 0;
+    /// The number of flushes that failed. Their blocks are written by the next flush
+    std::uint64_t n_failed_flushes = 0;
+    /// The total number of blocks written by flushes
+    std::uint64_t blocks_flushed = 0;
+    /// The total number of bytes read from disk when databases were loaded
+    std::uint64_t bytes_loaded = 0;
+};
+
+namespace event {
+
+/**
+ * @brief Fired by a hybrid_vfs after it flushes a database to disk, on the thread that ran the
+ * flush (the VFS's thread, the thread that called hybrid_vfs::flush(), or the thread that closed
+ * the last connection to the database).
+ */
+struct hybrid_flush {
+    /// The path of the database file
+    std::string_view path;
+    errc             ec;
+    /// The number of blocks that were written
+    std::size_t n_blocks;
+    /// The size of the database file after the flush
+    std::int64_t size;
+    /// The time taken by the flush
+    std::chrono::nanoseconds duration;
+};
+
+}  // namespace event
+
+/**
+ * @brief A VFS that keeps each database entirely in memory, and writes its dirty pages back to the
+ * database file from a background thread.
+ *
+ * When the first connection opens a database, the file is read sequentially into memory. After
+ * that, reads and writes of the database only touch memory, and syncs do nothing. Rollback
+ * journals are also kept in memory, so transactions can still be rolled back.
+ *
+ * Every `flush_interval`, and when flush() is called or the last connection to a database is
+ * closed, the blocks that have changed since the previous flush are written back to the file.
+ * A flush copies the blocks while no write transaction is in progress, so the file always holds
+ * the result of a whole number of transactions. Each flush is made atomic with a redo log
+ * (`<database>-hybrid-redo`): the blocks are first written and synced to the log, then written
+ * into the database file, which is then synced before the log is deleted. If the process stops
+ * during a flush, the log is replayed (if it is complete) or discarded (if not) when the database
+ * is next opened through the VFS.
+ *
+ * This trades durability for speed: transactions committed since the last flush are lost if the
+ * process stops. Other constraints:
+ *
+ * - WAL mode is not supported. `PRAGMA journal_mode = WAL` fails, and a database file in WAL mode
+ *   is converted to rollback-journal mode when it is loaded. Opening the database fails with
+ *   errc::cant_open if its WAL is not empty (i.e. it was not checkpointed with `TRUNCATE`).
+ * - The VFS is only available on POSIX platforms. On Windows, opening a database through it fails
+ *   with errc::cant_open.
+ * - Only one process may use the database file while it is open through the VFS, and every
+ *   connection in the process must use the same hybrid_vfs.
+ * - A connection in exclusive locking mode prevents flushes until it is closed.
+ */
+class hybrid_vfs : public vfs_shim {
+    hybrid_vfs_options _opts;
+
+    std::mutex                                 _images_mutex;
+    std::vector<std::shared_ptr<hybrid_image>> _images;
+
+    std::atomic<std::uint64_t> _n_flushes{0};
+    std::atomic<std::uint64_t> _n_failed_flushes{0};
+    std::atomic<std::uint64_t> _blocks_flushed{0};
+    std::atomic<std::uint64_t> _bytes_loaded{0};
+
+    std::mutex              _mutex;
+    std::condition_variable _cv;
+    bool                    _stopping = false;
+    std::thread             _thread;
+
+    void _run() noexcept;
+    errc _flush(hybrid_image& img) noexcept;
+
+protected:
+    int on_open(file& f) noexcept override;
+    int close(file& f) noexcept override;
+    int read(file& f, void* buf, int amount, std::int64_t offset) noexcept override;
+    int write(file& f, const void* buf, int amount, std::int64_t offset) noexcept override;
+    int truncate(file& f, std::int64_t size) noexcept override;
+    int sync(file& f, int flags) noexcept override;
+    int file_size(file& f, std::int64_t& size) noexcept override;
+    int lock(file& f, int level) noexcept override;
+    int unlock(file& f, int level) noexcept override;
+    int file_control(file& f, int op, void* arg) noexcept override;
+    int fetch(file& f, std::int64_t offset, int amount, void** pp) noexcept override;
+
+public:
+    /// The unit in which changes are tracked and flushed
+    constexpr static std::size_t block_size = 4096;
+
+    explicit hybrid_vfs(hybrid_vfs_options opts = {});
+    /// Stops the background thread. Every connection using the VFS must already be closed
+    ~hybrid_vfs();
+
+    [[nodiscard]] const hybrid_vfs_options& options() const noexcept { return _opts; }
+
+    /**
+     * @brief Flush every open database to disk now. Waits for write transactions in progress to
+     * finish (for up to `busy_timeout`).
+     */
+    errable<void> flush() noexcept;
+
+    [[nodiscard]] hybrid_vfs_stats stats() const noexcept;
+};
+
+}  // namespace neo::sqlite3
@@ -0,0 +1,107 @@
+#include <neo/sqlite3/exec.hpp>
+#include <neo/sqlite3/hybrid_vfs.hpp>
+#include <neo/sqlite3/open_options.hpp>
+
+#include "./tests.inl"
+
+#include <filesystem>
+#include <thread>
+
+// The VFS is only available on POSIX platforms
+#ifndef _WIN32
+
+namespace {
+
+/// Count the rows of the table, as seen by a connection that reads the database file directly
+int count_on_disk(const std::filesystem::path& path) {
+    auto db   = *neo::sqlite3::connection::open(path.string(), neo::sqlite3::openmode::readonly);
+    auto stmt = db.prepare("SELECT count(*) FROM foo");
+    return stmt.is_error() ? -1 : *neo::sqlite3::one_cell<int>(*stmt);
+}
+
+}  // namespace
+
+TEST_CASE_METHOD(sqlite3_temp_db_fixture, "Keep a database in memory, and flush it to disk") {
+    neo::sqlite3::hybrid_vfs vfs{{.name = "neo-hybrid-test", .flush_interval = {}}};
+    {
+        auto db = *neo::sqlite3::connection::open(path.string(),
+                                                  neo::sqlite3::open_options{.vfs = vfs.name()});
+        db.exec(R"(
+            CREATE TABLE foo (a INTEGER PRIMARY KEY, b BLOB);
+            WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < 1000)
+            INSERT INTO foo (b) SELECT randomblob(100) FROM n;
+        )")
+            .throw_if_error();
+        // Nothing has been written to the file yet
+        CHECK(count_on_disk(path) == -1);
+
+        vfs.flush().throw_if_error();
+        CHECK(count_on_disk(path) == 1000);
+        CHECK(vfs.stats().n_flushes == 1);
+        CHECK_FALSE(std::filesystem::exists(path.string() + "-hybrid-redo"));
+
+        // Transactions can be rolled back
+        db.exec("BEGIN; DELETE FROM foo; ROLLBACK").throw_if_error();
+        CHECK(*neo::sqlite3::one_cell<int>(*db.prepare("SELECT count(*) FROM foo")) == 1000);
+
+        // WAL mode is not supported
+        CHECK(db.exec("PRAGMA journal_mode = WAL").is_error());
+
+        // A second connection shares the in-memory database
+        auto db2 = *neo::sqlite3::connection::open(path.string(),
+                                                   neo::sqlite3::open_options{.vfs = vfs.name()});
+        db2.exec("DELETE FROM foo WHERE a > 500").throw_if_error();
+        CHECK(*neo::sqlite3::one_cell<int>(*db.prepare("SELECT count(*) FROM foo")) == 500);
+        CHECK(count_on_disk(path) == 1000);
+    }
+    // Closing the last connection flushes the database
+    CHECK(count_on_disk(path) == 500);
+
+    // Opening the database again loads it from disk
+    auto db = *neo::sqlite3::connection::open(path.string(),
+                                              neo::sqlite3::open_options{.vfs = vfs.name()});
+    CHECK(*neo::sqlite3::one_cell<int>(*db.prepare("SELECT count(*) FROM foo")) == 500);
+    CHECK(vfs.stats().bytes_loaded > 0);
+    CHECK(*neo::sqlite3::one_cell<std::string>(*db.prepare("PRAGMA integrity_check")) == "ok");
+}
+
+TEST_CASE_METHOD(sqlite3_temp_db_fixture, "Flush a hybrid database on a timer") {
+    neo::sqlite3::hybrid_vfs vfs{
+        {.name = "neo-hybrid-timer-test", .flush_interval = std::chrono::milliseconds{10}}};
+    auto db = *neo::sqlite3::connection::open(path.string(),
+                                              neo::sqlite3::open_options{.vfs = vfs.name()});
+    db.exec("CREATE TABLE foo (a); INSERT INTO foo VALUES (1), (2), (3)").throw_if_error();
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{5};
+    while (count_on_disk(path) != 3 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{5});
+    }
+    CHECK(count_on_disk(path) == 3);
+}
+
+TEST_CASE_METHOD(sqlite3_temp_db_fixture,
+                 "A hybrid database cannot be opened with a WAL that was not checkpointed") {
+    // While a connection is open, the WAL holds its transactions
+    auto other = *neo::sqlite3::open(path.string());
+    other.exec(R"(
+        PRAGMA journal_mode = WAL;
+        PRAGMA wal_autocheckpoint = 0;
+        CREATE TABLE foo (a);
+        INSERT INTO foo VALUES (1), (2), (3);
+    )")
+        .throw_if_error();
+
+    neo::sqlite3::hybrid_vfs vfs{{.name = "neo-hybrid-wal-test", .flush_interval = {}}};
+    auto db = neo::sqlite3::connection::open(path.string(),
+                                             neo::sqlite3::open_options{.vfs = vfs.name()});
+    CHECK(db.errc() == neo::sqlite3::errc::cant_open);
+
+    // Once the WAL is checkpointed and truncated, the database is loaded in rollback-journal mode
+    other.exec("PRAGMA wal_checkpoint(TRUNCATE)").throw_if_error();
+    auto db2 = *neo::sqlite3::connection::open(path.string(),
+                                               neo::sqlite3::open_options{.vfs = vfs.name()});
+    CHECK(*neo::sqlite3::one_cell<int>(*db2.prepare("SELECT count(*) FROM foo")) == 3);
+    CHECK(*neo::sqlite3::one_cell<std::string>(*db2.prepare("PRAGMA journal_mode")) == "delete");
+}
+
+#endif
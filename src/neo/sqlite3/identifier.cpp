@@ -0,0 +1,15 @@
+#include "./identifier.hpp"
+
+std::string neo::sqlite3::quote_identifier(std::string_view name) {
+    std::string ret;
+    ret.reserve(name.size() + 2);
+    ret.push_back('"');
+    for (char c : name) {
+        ret.push_back(c);
+        if (c == '"') {
+            ret.push_back(c);
+        }
+    }
+    ret.push_back('"');
+    return ret;
+}
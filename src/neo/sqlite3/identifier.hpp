@@ -0,0 +1,16 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+namespace neo::sqlite3 {
+
+/**
+ * @brief Quote the given string as an SQL identifier.
+ *
+ * The result is wrapped in double-quotes, and any embedded double-quotes are doubled. The result is
+ * safe to paste into SQL code as the name of a table, column, index, or schema.
+ */
+[[nodiscard]] std::string quote_identifier(std::string_view name);
+
+}  // namespace neo::sqlite3
@@ -0,0 +1,230 @@
+#include "./io_stats_vfs.hpp"
+
+#include <neo/event.hpp>
+
+#include <sqlite3/sqlite3.h>
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+using namespace neo::sqlite3;
+
+namespace {
+
+using clock = std::chrono::steady_clock;
+
+constexpr auto relaxed = std::memory_order_relaxed;
+
+void add(std::atomic<std::uint64_t>& c, std::uint64_t n = 1) noexcept { c.fetch_add(n, relaxed); }
+
+template <typename Histogram>
+void load_histogram(latency_histogram& out, const Histogram& h) noexcept {
+    for (auto i = 0u; i < latency_histogram::n_buckets; ++i) {
+        out.buckets[i] = h.buckets[i].load(relaxed);
+    }
+}
+
+}  // namespace
+
+std::string_view neo::sqlite3::to_string(io_op op) noexcept {
+    switch (op) {
+    case io_op::read:
+        return "read";
+    case io_op::write:
+        return "write";
+    case io_op::sync:
+        return "sync";
+    case io_op::lock:
+        return "lock";
+    }
+    return "<invalid io_op>";
+}
+
+std::size_t latency_histogram::bucket_of(std::chrono::nanoseconds dur) noexcept {
+    auto usec = std::chrono::duration_cast<std::chrono::microseconds>(dur).count();
+    if (usec <= 0) {
+        return 0;
+    }
+    auto n = static_cast<std::size_t>(std::bit_width(static_cast<std::uint64_t>(usec)));
+    return (std::min)(n, n_buckets - 1);
+}
+
+std::chrono::microseconds latency_histogram::bucket_limit(std::size_t bucket) noexcept {
+    return std::chrono::microseconds{std::int64_t(1) << bucket};
+}
+
+std::uint64_t latency_histogram::count() const noexcept {
+    std::uint64_t n = 0;
+    for (auto b : buckets) {
+        n += b;
+    }
+    return n;
+}
+
+std::chrono::microseconds latency_histogram::percentile(double p) const noexcept {
+    const auto total = count();
+    if (total == 0) {
+        return std::chrono::microseconds{0};
+    }
+    const auto    rank = static_cast<std::uint64_t>(std::ceil(total * (std::clamp)(p, 0.0, 100.0)
+                                                           / 100.0));
+    std::uint64_t seen = 0;
+    for (auto i = 0u; i < n_buckets; ++i) {
+        seen += buckets[i];
+        if (seen >= rank && seen != 0) {
+            return bucket_limit(i);
+        }
+    }
+    return bucket_limit(n_buckets - 1);
+}
+
+latency_histogram& latency_histogram::operator+=(const latency_histogram& other) noexcept {
+    for (auto i = 0u; i < n_buckets; ++i) {
+        buckets[i] += other.buckets[i];
+    }
+    return *this;
+}
+
+io_stats& io_stats::operator+=(const io_stats& other) noexcept {
+    n_reads += other.n_reads;
+    n_writes += other.n_writes;
+    n_syncs += other.n_syncs;
+    n_locks += other.n_locks;
+    bytes_read += other.bytes_read;
+    bytes_written += other.bytes_written;
+    n_short_reads += other.n_short_reads;
+    n_errors += other.n_errors;
+    read_latency += other.read_latency;
+    write_latency += other.write_latency;
+    sync_latency += other.sync_latency;
+    return *this;
+}
+
+io_stats_vfs::io_stats_vfs(std::string_view name, std::string_view base)
+    : vfs_shim(name, base) {}
+
+void io_stats_vfs::_record(file&                    f,
+                           io_op                    op,
+                           std::int64_t             offset,
+                           int                      amount,
+                           int                      rc,
+                           std::chrono::nanoseconds dur) noexcept {
+    auto& c = _counters[static_cast<std::size_t>(f.kind())];
+    // A short read has still read (and zero-filled) the whole buffer
+    const bool ok = rc == SQLITE_OK || rc == SQLITE_IOERR_SHORT_READ;
+    if (rc == SQLITE_IOERR_SHORT_READ) {
+        add(c.n_short_reads);
+    } else if ((rc & 0xff) == SQLITE_IOERR) {
+        add(c.n_errors);
+    }
+    const auto bucket = latency_histogram::bucket_of(dur);
+    switch (op) {
+    case io_op::read:
+        add(c.n_reads);
+        if (ok) {
+            add(c.bytes_read, static_cast<std::uint64_t>(amount));
+        }
+        add(c.read_latency.buckets[bucket]);
+        break;
+    case io_op::write:
+        add(c.n_writes);
+        if (ok) {
+            add(c.bytes_written, static_cast<std::uint64_t>(amount));
+        }
+        add(c.write_latency.buckets[bucket]);
+        break;
+    case io_op::sync:
+        add(c.n_syncs);
+        add(c.sync_latency.buckets[bucket]);
+        break;
+    case io_op::lock:
+        add(c.n_locks);
+        break;
+    }
+    try {
+        neo::emit(event::vfs_io{f.path(), f.kind(), op, offset, amount, rc, dur});
+    } catch (...) {
+        // Exceptions must not propagate into SQLite
+    }
+}
+
+int io_stats_vfs::read(file& f, void* buf, int amount, std::int64_t offset) noexcept {
+    const auto start = clock::now();
+    const auto rc    = f.read(buf, amount, offset);
+    _record(f, io_op::read, offset, amount, rc, clock::now() - start);
+    return rc;
+}
+
+int io_stats_vfs::write(file& f, const void* buf, int amount, std::int64_t offset) noexcept {
+    const auto start = clock::now();
+    const auto rc    = f.write(buf, amount, offset);
+    _record(f, io_op::write, offset, amount, rc, clock::now() - start);
+    return rc;
+}
+
+int io_stats_vfs::sync(file& f, int flags) noexcept {
+    const auto start = clock::now();
+    const auto rc    = f.sync(flags);
+    _record(f, io_op::sync, 0, 0, rc, clock::now() - start);
+    return rc;
+}
+
+int io_stats_vfs::lock(file& f, int level) noexcept {
+    const auto start = clock::now();
+    const auto rc    = f.lock(level);
+    _record(f, io_op::lock, 0, level, rc, clock::now() - start);
+    return rc;
+}
+
+int io_stats_vfs::unlock(file& f, int level) noexcept {
+    const auto start = clock::now();
+    const auto rc    = f.unlock(level);
+    _record(f, io_op::lock, 0, level, rc, clock::now() - start);
+    return rc;
+}
+
+io_stats io_stats_vfs::stats(file_kind kind) const noexcept {
+    auto&    c = _counters[static_cast<std::size_t>(kind)];
+    io_stats ret;
+    ret.n_reads       = c.n_reads.load(relaxed);
+    ret.n_writes      = c.n_writes.load(relaxed);
+    ret.n_syncs       = c.n_syncs.load(relaxed);
+    ret.n_locks       = c.n_locks.load(relaxed);
+    ret.bytes_read    = c.bytes_read.load(relaxed);
+    ret.bytes_written = c.bytes_written.load(relaxed);
+    ret.n_short_reads = c.n_short_reads.load(relaxed);
+    ret.n_errors      = c.n_errors.load(relaxed);
+    load_histogram(ret.read_latency, c.read_latency);
+    load_histogram(ret.write_latency, c.write_latency);
+    load_histogram(ret.sync_latency, c.sync_latency);
+    return ret;
+}
+
+io_stats io_stats_vfs::total() const noexcept {
+    io_stats ret;
+    for (auto i = 0u; i < n_file_kinds; ++i) {
+        ret += stats(static_cast<file_kind>(i));
+    }
+    return ret;
+}
+
+void io_stats_vfs::reset() noexcept {
+    for (auto& c : _counters) {
+        for (auto* n : {&c.n_reads,
+                        &c.n_writes,
+                        &c.n_syncs,
+                        &c.n_locks,
+                        &c.bytes_read,
+                        &c.bytes_written,
+                        &c.n_short_reads,
+                        &c.n_errors}) {
+            n->store(0, relaxed);
+        }
+        for (auto* h : {&c.read_latency, &c.write_latency, &c.sync_latency}) {
+            for (auto& b : h->buckets) {
+                b.store(0, relaxed);
+            }
+        }
+    }
+}
@@ -0,0 +1,171 @@
+#pragma once
+
+#include <neo/sqlite3/vfs.hpp>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string_view>
+
+namespace neo::sqlite3 {
+
+/**
+ * @brief The I/O operations counted by an io_stats_vfs
+ */
+enum class io_op {
+    read,
+    write,
+    sync,
+    /// A call to xLock or xUnlock
+    lock,
+};
+
+[[nodiscard]] std::string_view to_string(io_op op) noexcept;
+
+/**
+ * @brief A histogram of operation latencies, with power-of-two buckets of microseconds.
+ *
+ * Bucket zero counts operations that took less than one microsecond, and bucket `N` counts
+ * operations that took [2^(N-1), 2^N) microseconds. The last bucket also counts anything longer.
+ */
+struct latency_histogram {
+    constexpr static std::size_t n_buckets = 32;
+
+    std::array<std::uint64_t, n_buckets> buckets{};
+
+    /// The bucket that counts the given duration
+    [[nodiscard]] static std::size_t bucket_of(std::chrono::nanoseconds dur) noexcept;
+    /// The exclusive upper bound of the durations counted by the given bucket
+    [[nodiscard]] static std::chrono::microseconds bucket_limit(std::size_t bucket) noexcept;
+
+    /// The total number of operations in the histogram
+    [[nodiscard]] std::uint64_t count() const noexcept;
+
+    /**
+     * @brief Estimate the given percentile (in [0, 100]) of the latencies, as the upper bound of
+     * the bucket that contains it. Returns zero if the histogram is empty.
+     */
+    [[nodiscard]] std::chrono::microseconds percentile(double p) const noexcept;
+
+    latency_histogram& operator+=(const latency_histogram& other) noexcept;
+};
+
+/**
+ * @brief A snapshot of the I/O statistics of an io_stats_vfs, for one kind of file or in total
+ */
+struct io_stats {
+    std::uint64_t n_reads         = 0;
+    std::uint64_t n_writes        = 0;
+    std::uint64_t n_syncs         = 0;
+    std::uint64_t n_locks         = 0;
+    std::uint64_t bytes_read      = 0;
+    std::uint64_t bytes_written   = 0;
+    /// The number of reads that returned SQLITE_IOERR_SHORT_READ (e.g. reading past the EOF)
+    std::uint64_t n_short_reads   = 0;
+    /// The number of operations that failed with an I/O error
+    std::uint64_t n_errors        = 0;
+
+    latency_histogram read_latency;
+    latency_histogram write_latency;
+    latency_histogram sync_latency;
+
+    io_stats& operator+=(const io_stats& other) noexcept;
+};
+
+namespace event {
+
+/**
+ * @brief Fired by an io_stats_vfs after each read, write, sync, and lock operation, on the thread
+ * that performed the operation.
+ */
+struct vfs_io {
+    /// The path of the file, or null for a temporary file with no name
+    const char* path;
+    file_kind   kind;
+    io_op       op;
+    /// The offset of a read or write
+    std::int64_t offset;
+    /// The size of a read or write. The lock level of a lock operation
+    int amount;
+    /// The SQLite result code of the operation
+    int result;
+    /// The time taken by the operation
+    std::chrono::nanoseconds duration;
+};
+
+}  // namespace event
+
+/**
+ * @brief A pass-through VFS that counts the I/O performed on each kind of file, and records
+ * the latency of reads, writes, and syncs.
+ *
+ * Open connections with open_options::vfs set to the name() of the shim (or pass the name as the
+ * `vfs` to connection::open()). The statistics are shared by every connection using the shim, and
+ * are updated with relaxed atomic operations, so they can be read from any thread while the
+ * connections are in use.
+ *
+ * Reads of memory-mapped pages (see pragma_profile::mmap_size) do not go through the VFS, and
+ * are not counted.
+ *
+ * ```
+ * io_stats_vfs io;
+ * auto db = *connection::open("app.db", open_options{.vfs = io.name()});
+ * // ...
+ * auto wal = io.stats(file_kind::wal);
+ * ```
+ */
+class io_stats_vfs : public vfs_shim {
+    struct atomic_histogram {
+        std::array<std::atomic<std::uint64_t>, latency_histogram::n_buckets> buckets{};
+    };
+
+    struct counters {
+        std::atomic<std::uint64_t> n_reads{0};
+        std::atomic<std::uint64_t> n_writes{0};
+        std::atomic<std::uint64_t> n_syncs{0};
+        std::atomic<std::uint64_t> n_locks{0};
+        std::atomic<std::uint64_t> bytes_read{0};
+        std::atomic<std::uint64_t> bytes_written{0};
+        std::atomic<std::uint64_t> n_short_reads{0};
+        std::atomic<std::uint64_t> n_errors{0};
+        atomic_histogram           read_latency;
+        atomic_histogram           write_latency;
+        atomic_histogram           sync_latency;
+    };
+
+    std::array<counters, n_file_kinds> _counters;
+
+    void _record(file&                    f,
+                 io_op                    op,
+                 std::int64_t             offset,
+                 int                      amount,
+                 int                      rc,
+                 std::chrono::nanoseconds dur) noexcept;
+
+protected:
+    int read(file& f, void* buf, int amount, std::int64_t offset) noexcept override;
+    int write(file& f, const void* buf, int amount, std::int64_t offset) noexcept override;
+    int sync(file& f, int flags) noexcept override;
+    int lock(file& f, int level) noexcept override;
+    int unlock(file& f, int level) noexcept override;
+
+public:
+    /// The name used by a default-constructed io_stats_vfs
+    constexpr static std::string_view default_name = "neo-io-stats";
+
+    /**
+     * @brief Register an I/O statistics VFS with the given name, wrapping the named VFS (or the
+     * default VFS, if `base` is empty).
+     */
+    explicit io_stats_vfs(std::string_view name = default_name, std::string_view base = {});
+
+    /// Get the statistics of the files of the given kind
+    [[nodiscard]] io_stats stats(file_kind kind) const noexcept;
+    /// Get the statistics of every file opened through the VFS
+    [[nodiscard]] io_stats total() const noexcept;
+    /// Reset all statistics to zero
+    void reset() noexcept;
+};
+
+}  // namespace neo::sqlite3
@@ -0,0 +1,54 @@
+#include <neo/sqlite3/exec.hpp>
+#include <neo/sqlite3/io_stats_vfs.hpp>
+#include <neo/sqlite3/open_options.hpp>
+
+#include "./tests.inl"
+
+TEST_CASE_METHOD(sqlite3_temp_db_fixture, "Count the I/O of a database") {
+    neo::sqlite3::io_stats_vfs io;
+    CHECK(io.name() == neo::sqlite3::io_stats_vfs::default_name);
+    {
+        auto db = *neo::sqlite3::connection::open(path.string(),
+                                                  neo::sqlite3::open_options{.vfs = io.name()});
+        db.exec("CREATE TABLE foo (a INTEGER PRIMARY KEY, b BLOB)").throw_if_error();
+        db.exec("INSERT INTO foo (b) VALUES (zeroblob(10000))").throw_if_error();
+
+        auto main    = io.stats(neo::sqlite3::file_kind::main_db);
+        auto journal = io.stats(neo::sqlite3::file_kind::journal);
+        CHECK(main.n_writes > 0);
+        CHECK(main.bytes_written >= 10000);
+        CHECK(main.n_syncs > 0);
+        CHECK(main.n_locks > 0);
+        CHECK(main.write_latency.count() == main.n_writes);
+        CHECK(main.sync_latency.count() == main.n_syncs);
+        CHECK(main.sync_latency.percentile(50) > std::chrono::microseconds{0});
+        CHECK(journal.n_writes > 0);
+        CHECK(io.stats(neo::sqlite3::file_kind::wal).n_writes == 0);
+
+        auto total = io.total();
+        CHECK(total.n_writes == main.n_writes + journal.n_writes);
+
+        io.reset();
+        CHECK(io.total().n_reads == 0);
+        db.exec("PRAGMA journal_mode = WAL").throw_if_error();
+        db.exec("INSERT INTO foo (b) VALUES (zeroblob(10000))").throw_if_error();
+        CHECK(io.stats(neo::sqlite3::file_kind::wal).bytes_written >= 10000);
+    }
+}
+
+TEST_CASE("Latency histogram buckets") {
+    using neo::sqlite3::latency_histogram;
+    using namespace std::chrono_literals;
+    CHECK(latency_histogram::bucket_of(500ns) == 0);
+    CHECK(latency_histogram::bucket_of(1us) == 1);
+    CHECK(latency_histogram::bucket_of(3us) == 2);
+    CHECK(latency_histogram::bucket_of(100000s) == latency_histogram::n_buckets - 1);
+
+    latency_histogram h;
+    h.buckets[1] = 90;
+    h.buckets[5] = 10;
+    CHECK(h.count() == 100);
+    CHECK(h.percentile(50) == 2us);
+    CHECK(h.percentile(95) == 32us);
+    CHECK(latency_histogram{}.percentile(50) == 0us);
+}
@@ -0,0 +1,815 @@
+#include "./ivf_index.hpp"
+
+#include <neo/sqlite3/connection_ref.hpp>
+#include <neo/sqlite3/error.hpp>
+#include <neo/sqlite3/exec.hpp>
+#include <neo/sqlite3/identifier.hpp>
+#include <neo/sqlite3/statement.hpp>
+#include <neo/sqlite3/vector_functions.hpp>
+
+#include <neo/ufmt.hpp>
+#include <sqlite3/sqlite3.h>
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace neo::sqlite3;
+using neo::ufmt;
+
+namespace {
+
+/// Columns of the declared virtual table
+enum ivf_column : int {
+    vector_column   = 0,
+    distance_column = 1,
+    query_column    = 2,
+    k_column        = 3,
+};
+
+/// Bits of idxNum that encode the constraints passed to xFilter, in argv order
+enum plan_bits : int {
+    plan_query = 1,
+    plan_k     = 2,
+    plan_rowid = 4,
+};
+
+enum class ivf_metric {
+    l2,
+    cosine,
+};
+
+/// The number of nearest neighbors returned if no 'k' is given
+constexpr int default_k = 10;
+/// The number of k-means iterations performed when training the centroids
+constexpr int kmeans_iterations = 10;
+/// The number of sample vectors used to train each centroid
+constexpr std::size_t samples_per_list = 64;
+
+using float_vec = std::vector<float>;
+
+struct ivf_config {
+    std::size_t dims   = 0;
+    int         lists  = 0;
+    int         probes = 0;
+    ivf_metric  metric = ivf_metric::l2;
+};
+
+std::string_view trim(std::string_view s) noexcept {
+    while (!s.empty() && std::isspace(static_cast<unsigned char>(s.front()))) {
+        s.remove_prefix(1);
+    }
+    while (!s.empty() && std::isspace(static_cast<unsigned char>(s.back()))) {
+        s.remove_suffix(1);
+    }
+    return s;
+}
+
+/// Remove SQL quoting from a module argument. Embedded doubled-quotes are not handled.
+std::string_view unquote(std::string_view s) noexcept {
+    if (s.size() >= 2
+        && ((s.front() == '\'' && s.back() == '\'') || (s.front() == '"' && s.back() == '"')
+            || (s.front() == '`' && s.back() == '`') || (s.front() == '[' && s.back() == ']'))) {
+        return s.substr(1, s.size() - 2);
+    }
+    return s;
+}
+
+int parse_positive_int(std::string_view key, std::string_view value) {
+    int  ret = 0;
+    auto res = std::from_chars(value.data(), value.data() + value.size(), ret);
+    if (res.ec != std::errc{} || res.ptr != value.data() + value.size() || ret < 1) {
+        throw std::invalid_argument(
+            ufmt("Invalid value for ivf_flat option '{}': '{}'", key, value));
+    }
+    return ret;
+}
+
+float_vec to_floats(blob_view blob) {
+    float_vec ret(blob.size() / sizeof(float));
+    std::memcpy(ret.data(), blob.data(), ret.size() * sizeof(float));
+    return ret;
+}
+
+float distance(ivf_metric metric, blob_view a, blob_view b) {
+    return metric == ivf_metric::l2 ? vec_l2(a, b) : vec_cosine(a, b);
+}
+
+/// Find the index of the centroid nearest to the given vector. Centroids must be non-empty
+std::size_t nearest_centroid(const std::vector<float_vec>& centroids, blob_view vec) {
+    std::size_t best      = 0;
+    float       best_dist = vec_l2_squared(blob_view(centroids[0]), vec);
+    for (auto i = 1u; i < centroids.size(); ++i) {
+        auto d = vec_l2_squared(blob_view(centroids[i]), vec);
+        if (d < best_dist) {
+            best      = i;
+            best_dist = d;
+        }
+    }
+    return best;
+}
+
+/// Cluster the sample vectors into (at most) 'k' centroids using Lloyd's algorithm
+std::vector<float_vec> train_kmeans(const std::vector<float_vec>& sample, std::size_t k) {
+    k = std::min(k, sample.size());
+    if (k == 0) {
+        return {};
+    }
+    const auto dims = sample[0].size();
+    // Seed the centroids with vectors spread evenly through the sample
+    std::vector<float_vec> centroids;
+    for (auto i = 0u; i < k; ++i) {
+        centroids.push_back(sample[i * sample.size() / k]);
+    }
+    std::vector<double>      sums(k * dims);
+    std::vector<std::size_t> counts(k);
+    for (auto iter = 0; iter < kmeans_iterations; ++iter) {
+        std::ranges::fill(sums, 0.0);
+        std::ranges::fill(counts, 0u);
+        for (auto& vec : sample) {
+            auto nearest = nearest_centroid(centroids, blob_view(vec));
+            ++counts[nearest];
+            for (auto d = 0u; d < dims; ++d) {
+                sums[nearest * dims + d] += vec[d];
+            }
+        }
+        for (auto c = 0u; c < k; ++c) {
+            // An empty cluster keeps its previous centroid
+            if (counts[c] == 0) {
+                continue;
+            }
+            for (auto d = 0u; d < dims; ++d) {
+                centroids[c][d] = static_cast<float>(sums[c * dims + d] / counts[c]);
+            }
+        }
+    }
+    return centroids;
+}
+
+struct ivf_vtab {
+    ::sqlite3_vtab base{};
+    ::sqlite3*     db = nullptr;
+    /// The name of the database (schema) that contains the table
+    std::string schema;
+    /// The name of the virtual table
+    std::string            name;
+    ivf_config             config;
+    std::vector<float_vec> centroids;
+    /// Set when a rollback may have discarded centroids that are held in memory
+    bool centroids_stale = false;
+    /// The 'PRAGMA data_version' at which the centroids were loaded
+    std::int64_t centroids_version = -1;
+
+    std::optional<statement> insert_vector_st;
+    std::optional<statement> delete_vector_st;
+    std::optional<statement> get_vector_st;
+    std::optional<statement> list_vectors_st;
+    std::optional<statement> insert_centroid_st;
+    std::optional<statement> data_version_st;
+
+    connection_ref conn() const noexcept { return connection_ref(db); }
+
+    /// Get the qualified and quoted name of a shadow table
+    std::string shadow(std::string_view suffix) const {
+        return quote_identifier(schema) + "." + quote_identifier(name + "_" + std::string(suffix));
+    }
+
+    statement& prepared(std::optional<statement>& slot, const std::string& sql) {
+        if (!slot) {
+            slot.emplace(*conn().prepare(sql));
+        }
+        return *slot;
+    }
+
+    void exec_sql(const std::string& sql) { conn().exec(sql).throw_if_error(); }
+
+    void create_shadow_tables() {
+        exec_sql(ufmt("CREATE TABLE {} (key TEXT PRIMARY KEY, value)", shadow("config")));
+        exec_sql(ufmt("CREATE TABLE {} (list INTEGER PRIMARY KEY, centroid BLOB NOT NULL)",
+                      shadow("centroids")));
+        // The vectors of each list are found through the automatic index of the UNIQUE
+        // constraint. Unlike a named index, it is renamed along with the table by xRename (which
+        // cannot drop and re-create an index, as the ALTER TABLE statement is still running)
+        exec_sql(ufmt("CREATE TABLE {} (rowid INTEGER PRIMARY KEY, list INTEGER NOT NULL, "
+                      "vector BLOB NOT NULL, UNIQUE (list, rowid))",
+                      shadow("vectors")));
+    }
+
+    void save_config() {
+        auto st = *conn().prepare(
+            ufmt("INSERT OR REPLACE INTO {} (key, value) VALUES ('dims', ?), ('lists', ?), "
+                 "('probes', ?), ('metric', ?)",
+                 shadow("config")));
+        exec(st,
+             static_cast<std::int64_t>(config.dims),
+             config.lists,
+             config.probes,
+             config.metric == ivf_metric::l2 ? "l2" : "cosine")
+            .throw_if_error();
+    }
+
+    void load_config() {
+        auto st   = *conn().prepare(ufmt("SELECT key, value FROM {}", shadow("config")));
+        auto rows = *exec_tuples<std::string, std::int64_t>(st);
+        for (auto [key, value] : rows) {
+            if (key == "dims") {
+                config.dims = static_cast<std::size_t>(value);
+            } else if (key == "lists") {
+                config.lists = static_cast<int>(value);
+            } else if (key == "probes") {
+                config.probes = static_cast<int>(value);
+            }
+        }
+        auto metric_st
+            = *conn().prepare(ufmt("SELECT value FROM {} WHERE key = 'metric'", shadow("config")));
+        config.metric
+            = *one_cell<std::string>(metric_st) == "cosine" ? ivf_metric::cosine : ivf_metric::l2;
+    }
+
+    std::int64_t data_version() {
+        auto& st = prepared(data_version_st,
+                            ufmt("PRAGMA {}.data_version", quote_identifier(schema)));
+        return *one_cell<std::int64_t>(st);
+    }
+
+    void load_centroids() {
+        centroids.clear();
+        auto st = *conn().prepare(
+            ufmt("SELECT centroid FROM {} ORDER BY list", shadow("centroids")));
+        while (st.step() == errc::row) {
+            centroids.push_back(to_floats(st.row()[0].as_blob()));
+        }
+        centroids_stale   = false;
+        centroids_version = data_version();
+    }
+
+    /// Reload the centroids if they may have been changed by a rollback or by another connection
+    void refresh_centroids() {
+        if (centroids_stale) {
+            load_centroids();
+        } else if (static_cast<int>(centroids.size()) < config.lists
+                   && data_version() != centroids_version) {
+            // Other connections may have inserted new centroids
+            load_centroids();
+        }
+    }
+
+    void add_centroid(float_vec vec) {
+        auto& st = prepared(insert_centroid_st,
+                            ufmt("INSERT INTO {} (list, centroid) VALUES (?, ?)",
+                                 shadow("centroids")));
+        exec(st, static_cast<std::int64_t>(centroids.size()), blob_view(vec)).throw_if_error();
+        centroids.push_back(std::move(vec));
+    }
+
+    void check_vector(blob_view vec) {
+        if (vec.size() == 0 || vec.size() % sizeof(float) != 0) {
+            throw std::invalid_argument(
+                "Vectors in an ivf_flat index must be non-empty BLOBs of packed float32 values");
+        }
+        if (config.dims == 0) {
+            config.dims = vec.size() / sizeof(float);
+            save_config();
+        }
+        if (vec.size() != config.dims * sizeof(float)) {
+            throw std::invalid_argument(
+                ufmt("Vector has {} dimensions, but the ivf_flat index '{}' requires {}",
+                          vec.size() / sizeof(float),
+                          name,
+                          config.dims));
+        }
+    }
+
+    void insert_vector(std::int64_t rowid, blob_view vec) {
+        check_vector(vec);
+        refresh_centroids();
+        if (static_cast<int>(centroids.size()) < config.lists) {
+            // Not enough centroids: Use this vector as a new one
+            add_centroid(to_floats(vec));
+        }
+        auto  list = nearest_centroid(centroids, vec);
+        auto& st   = prepared(insert_vector_st,
+                              ufmt("INSERT INTO {} (rowid, list, vector) VALUES (?, ?, ?)",
+                                   shadow("vectors")));
+        exec(st, rowid, static_cast<std::int64_t>(list), vec).throw_if_error();
+    }
+
+    void delete_vector(std::int64_t rowid) {
+        auto& st
+            = prepared(delete_vector_st, ufmt("DELETE FROM {} WHERE rowid = ?", shadow("vectors")));
+        exec(st, rowid).throw_if_error();
+    }
+
+    /// Train the centroids from the vectors in the given source, then index all of those vectors
+    void build_from(std::string_view source, std::string_view column, bool have_lists) {
+        const auto src      = quote_identifier(schema) + "." + quote_identifier(source);
+        const auto col      = quote_identifier(column);
+        auto       count_st = *conn().prepare(
+            ufmt("SELECT count(*) FROM {} WHERE typeof({}) = 'blob'", src, col));
+        auto n_vectors = static_cast<std::size_t>(*one_cell<std::int64_t>(count_st));
+        if (!have_lists) {
+            config.lists
+                = std::max(1, static_cast<int>(std::sqrt(static_cast<double>(n_vectors))));
+        }
+
+        auto select_st = *conn().prepare(
+            ufmt("SELECT rowid, {} FROM {} WHERE typeof({}) = 'blob'", col, src, col));
+
+        // Take an evenly-spaced sample of the vectors for training
+        const auto sample_size = static_cast<std::size_t>(config.lists) * samples_per_list;
+        const auto stride      = std::max(std::size_t(1), n_vectors / sample_size);
+        std::vector<float_vec> sample;
+        for (std::size_t i = 0; select_st.step() == errc::row; ++i) {
+            auto vec = select_st.row()[1].as_blob();
+            check_vector(vec);
+            if (i % stride == 0) {
+                sample.push_back(to_floats(vec));
+            }
+        }
+        for (auto& centroid : train_kmeans(sample, static_cast<std::size_t>(config.lists))) {
+            add_centroid(std::move(centroid));
+        }
+        sample.clear();
+
+        select_st.reset();
+        while (select_st.step() == errc::row) {
+            auto row = select_st.row();
+            insert_vector(row[0].as_integer(), row[1].as_blob());
+        }
+    }
+
+    /// Find the (approximate) 'k' nearest neighbors of 'query', ordered by distance
+    std::vector<std::pair<float, std::int64_t>> search(blob_view query, int k) {
+        refresh_centroids();
+        std::vector<std::pair<float, std::int64_t>> results;
+        if (centroids.empty() || k < 1) {
+            return results;
+        }
+        if (query.size() != config.dims * sizeof(float)) {
+            throw std::invalid_argument(
+                ufmt("Query vector has {} bytes, but the ivf_flat index '{}' has {} dimensions",
+                     query.size(),
+                     name,
+                     config.dims));
+        }
+
+        // Find the lists with the nearest centroids
+        std::vector<std::pair<float, std::size_t>> lists;
+        for (auto i = 0u; i < centroids.size(); ++i) {
+            lists.emplace_back(vec_l2_squared(blob_view(centroids[i]), query), i);
+        }
+        const auto n_probes = std::min(lists.size(), static_cast<std::size_t>(config.probes));
+        std::ranges::partial_sort(lists, lists.begin() + static_cast<std::ptrdiff_t>(n_probes));
+        lists.resize(n_probes);
+
+        // Keep the best 'k' as a max-heap, so the worst of them can be quickly replaced
+        auto& st = prepared(list_vectors_st,
+                            ufmt("SELECT rowid, vector FROM {} WHERE list = ?", shadow("vectors")));
+        for (auto [unused, list] : lists) {
+            reset_and_bind(st, static_cast<std::int64_t>(list)).throw_if_error();
+            auto rst = st.auto_reset();
+            while (st.step() == errc::row) {
+                auto row = st.row();
+                auto d   = distance(config.metric, query, row[1].as_blob());
+                if (results.size() < static_cast<std::size_t>(k)) {
+                    results.emplace_back(d, row[0].as_integer());
+                    std::ranges::push_heap(results);
+                } else if (d < results.front().first) {
+                    std::ranges::pop_heap(results);
+                    results.back() = {d, row[0].as_integer()};
+                    std::ranges::push_heap(results);
+                }
+            }
+        }
+        std::ranges::sort_heap(results);
+        return results;
+    }
+};
+
+struct ivf_cursor {
+    ::sqlite3_vtab_cursor base{};
+    /// If true, the cursor is iterating nearest-neighbor results. Otherwise, it is scanning.
+    bool knn = false;
+    /// The results of a nearest-neighbor query
+    std::vector<std::pair<float, std::int64_t>> results;
+    std::size_t                                 pos = 0;
+    /// The statement of a scan (or a rowid lookup)
+    std::optional<statement> scan;
+    bool                     scan_done = true;
+};
+
+ivf_vtab& get_vtab(::sqlite3_vtab* vtab) noexcept { return *reinterpret_cast<ivf_vtab*>(vtab); }
+
+void set_vtab_error(::sqlite3_vtab* vtab, const char* message) noexcept {
+    ::sqlite3_free(vtab->zErrMsg);
+    vtab->zErrMsg = ::sqlite3_mprintf("%s", message);
+}
+
+/// Invoke the given function, translating exceptions into an error message on the vtab
+template <typename Func>
+int guard_vtab(::sqlite3_vtab* vtab, Func&& fn) noexcept {
+    try {
+        fn();
+        return SQLITE_OK;
+    } catch (const std::exception& e) {
+        set_vtab_error(vtab, e.what());
+    } catch (...) {
+        set_vtab_error(vtab, "[neo-sqlite3]: Non-std::exception type was thrown by ivf_flat");
+    }
+    return SQLITE_ERROR;
+}
+
+constexpr const char* ivf_schema
+    = "CREATE TABLE x(vector BLOB, distance REAL, query HIDDEN, k HIDDEN)";
+
+int ivf_init(::sqlite3*         db,
+             int                argc,
+             const char* const* argv,
+             ::sqlite3_vtab**   out,
+             char**             errmsg,
+             bool               create) noexcept {
+    auto rc = ::sqlite3_declare_vtab(db, ivf_schema);
+    if (rc != SQLITE_OK) {
+        return rc;
+    }
+    auto vtab = new (std::nothrow) ivf_vtab{};
+    if (!vtab) {
+        return SQLITE_NOMEM;
+    }
+    try {
+        vtab->db     = db;
+        vtab->schema = argv[1];
+        vtab->name   = argv[2];
+        if (create) {
+            std::string_view source, column;
+            bool             have_lists = false, have_probes = false;
+            for (auto i = 3; i < argc; ++i) {
+                std::string_view arg = argv[i];
+                auto             eq  = arg.find('=');
+                if (eq == arg.npos) {
+                    throw std::invalid_argument(
+                        ufmt("Invalid ivf_flat option '{}' (Expected 'key=value')", arg));
+                }
+                auto key   = trim(arg.substr(0, eq));
+                auto value = unquote(trim(arg.substr(eq + 1)));
+                if (key == "source") {
+                    source = value;
+                } else if (key == "column") {
+                    column = value;
+                } else if (key == "lists") {
+                    vtab->config.lists = parse_positive_int(key, value);
+                    have_lists         = true;
+                } else if (key == "probes") {
+                    vtab->config.probes = parse_positive_int(key, value);
+                    have_probes         = true;
+                } else if (key == "dims") {
+                    vtab->config.dims = static_cast<std::size_t>(parse_positive_int(key, value));
+                } else if (key == "metric" && (value == "l2" || value == "cosine")) {
+                    vtab->config.metric = value == "l2" ? ivf_metric::l2 : ivf_metric::cosine;
+                } else {
+                    throw std::invalid_argument(ufmt("Invalid ivf_flat option '{}'", arg));
+                }
+            }
+            if (source.empty() != column.empty()) {
+                throw std::invalid_argument(
+                    "The 'source' and 'column' options of ivf_flat must be given together");
+            }
+            if (!have_lists && source.empty()) {
+                vtab->config.lists = 100;
+            }
+            vtab->create_shadow_tables();
+            vtab->save_config();
+            vtab->load_centroids();
+            if (!source.empty()) {
+                vtab->build_from(source, column, have_lists);
+            }
+            if (!have_probes) {
+                auto lists          = static_cast<double>(vtab->config.lists);
+                vtab->config.probes = std::max(1, static_cast<int>(std::ceil(std::sqrt(lists))));
+            }
+            vtab->save_config();
+        } else {
+            vtab->load_config();
+            vtab->load_centroids();
+        }
+    } catch (const std::exception& e) {
+        *errmsg = ::sqlite3_mprintf("%s", e.what());
+        delete vtab;
+        return SQLITE_ERROR;
+    }
+    *out = &vtab->base;
+    return SQLITE_OK;
+}
+
+int ivf_create(::sqlite3*         db,
+               void*,
+               int                argc,
+               const char* const* argv,
+               ::sqlite3_vtab**   out,
+               char**             errmsg) noexcept {
+    return ivf_init(db, argc, argv, out, errmsg, true);
+}
+
+int ivf_connect(::sqlite3*         db,
+                void*,
+                int                argc,
+                const char* const* argv,
+                ::sqlite3_vtab**   out,
+                char**             errmsg) noexcept {
+    return ivf_init(db, argc, argv, out, errmsg, false);
+}
+
+int ivf_disconnect(::sqlite3_vtab* vtab) noexcept {
+    delete &get_vtab(vtab);
+    return SQLITE_OK;
+}
+
+int ivf_destroy(::sqlite3_vtab* vtab_) noexcept {
+    auto& vtab = get_vtab(vtab_);
+    auto  rc   = guard_vtab(vtab_, [&] {
+        for (auto suffix : {"config", "centroids", "vectors"}) {
+            vtab.exec_sql(ufmt("DROP TABLE IF EXISTS {}", vtab.shadow(suffix)));
+        }
+    });
+    if (rc == SQLITE_OK) {
+        delete &vtab;
+    }
+    return rc;
+}
+
+int ivf_best_index(::sqlite3_vtab*, ::sqlite3_index_info* info) noexcept {
+    int  query_idx = -1, k_idx = -1, rowid_idx = -1;
+    bool query_unusable = false;
+    for (auto i = 0; i < info->nConstraint; ++i) {
+        auto& cons = info->aConstraint[i];
+        if (cons.op != SQLITE_INDEX_CONSTRAINT_EQ) {
+            continue;
+        }
+        if (!cons.usable) {
+            query_unusable = query_unusable || cons.iColumn == query_column;
+            continue;
+        }
+        if (cons.iColumn == query_column) {
+            query_idx = i;
+        } else if (cons.iColumn == k_column) {
+            k_idx = i;
+        } else if (cons.iColumn == -1) {
+            rowid_idx = i;
+        }
+    }
+
+    if (query_idx >= 0) {
+        info->idxNum                                = plan_query;
+        info->aConstraintUsage[query_idx].argvIndex = 1;
+        info->aConstraintUsage[query_idx].omit      = 1;
+        if (k_idx >= 0) {
+            info->idxNum |= plan_k;
+            info->aConstraintUsage[k_idx].argvIndex = 2;
+            info->aConstraintUsage[k_idx].omit      = 1;
+        }
+        info->estimatedCost = 1000;
+        info->estimatedRows = default_k;
+        // Results are generated in order of distance
+        if (info->nOrderBy == 1 && info->aOrderBy[0].iColumn == distance_column
+            && !info->aOrderBy[0].desc) {
+            info->orderByConsumed = 1;
+        }
+    } else if (query_unusable) {
+        // The planner must find a plan in which the query vector is available
+        return SQLITE_CONSTRAINT;
+    } else if (rowid_idx >= 0) {
+        info->idxNum                                = plan_rowid;
+        info->aConstraintUsage[rowid_idx].argvIndex = 1;
+        info->aConstraintUsage[rowid_idx].omit      = 1;
+        info->estimatedCost                         = 10;
+        info->estimatedRows                         = 1;
+    } else {
+        info->idxNum        = 0;
+        info->estimatedCost = 1e9;
+        info->estimatedRows = 1000000;
+    }
+    return SQLITE_OK;
+}
+
+int ivf_open(::sqlite3_vtab*, ::sqlite3_vtab_cursor** out) noexcept {
+    auto cur = new (std::nothrow) ivf_cursor{};
+    if (!cur) {
+        return SQLITE_NOMEM;
+    }
+    *out = &cur->base;
+    return SQLITE_OK;
+}
+
+int ivf_close(::sqlite3_vtab_cursor* cur) noexcept {
+    delete reinterpret_cast<ivf_cursor*>(cur);
+    return SQLITE_OK;
+}
+
+int ivf_scan_step(ivf_cursor& cur) noexcept {
+    auto res = cur.scan->step();
+    if (res == errc::row) {
+        return SQLITE_OK;
+    }
+    cur.scan_done = true;
+    return res == errc::done ? SQLITE_OK : static_cast<int>(res.errc());
+}
+
+int ivf_filter(::sqlite3_vtab_cursor* cur_,
+               int                    idx_num,
+               const char*,
+               int,
+               ::sqlite3_value** argv) noexcept {
+    auto& cur  = *reinterpret_cast<ivf_cursor*>(cur_);
+    auto& vtab = get_vtab(cur.base.pVtab);
+    cur.results.clear();
+    cur.pos       = 0;
+    cur.knn       = (idx_num & plan_query) != 0;
+    cur.scan_done = true;
+    if (cur.knn) {
+        return guard_vtab(cur.base.pVtab, [&] {
+            value_ref query{argv[0]};
+            auto      k = (idx_num & plan_k) ? value_ref(argv[1]).as_integer() : default_k;
+            if (query.is_null() || k < 1) {
+                return;
+            }
+            k           = std::min(k, std::int64_t{std::numeric_limits<int>::max()});
+            cur.results = vtab.search(query.as_blob(), static_cast<int>(k));
+        });
+    }
+    auto rc = guard_vtab(cur.base.pVtab, [&] {
+        if (idx_num & plan_rowid) {
+            cur.scan.emplace(*vtab.conn().prepare(
+                ufmt("SELECT rowid, vector FROM {} WHERE rowid = ?", vtab.shadow("vectors"))));
+            reset_and_bind(*cur.scan, value_ref(argv[0]).as_integer()).throw_if_error();
+        } else {
+            cur.scan.emplace(*vtab.conn().prepare(
+                ufmt("SELECT rowid, vector FROM {}", vtab.shadow("vectors"))));
+        }
+    });
+    if (rc != SQLITE_OK) {
+        return rc;
+    }
+    cur.scan_done = false;
+    return ivf_scan_step(cur);
+}
+
+int ivf_next(::sqlite3_vtab_cursor* cur_) noexcept {
+    auto& cur = *reinterpret_cast<ivf_cursor*>(cur_);
+    if (cur.knn) {
+        ++cur.pos;
+        return SQLITE_OK;
+    }
+    return ivf_scan_step(cur);
+}
+
+int ivf_eof(::sqlite3_vtab_cursor* cur_) noexcept {
+    auto& cur = *reinterpret_cast<ivf_cursor*>(cur_);
+    return cur.knn ? cur.pos >= cur.results.size() : cur.scan_done;
+}
+
+int ivf_column(::sqlite3_vtab_cursor* cur_, ::sqlite3_context* ctx, int col) noexcept {
+    auto& cur = *reinterpret_cast<ivf_cursor*>(cur_);
+    if (col == distance_column) {
+        if (cur.knn) {
+            ::sqlite3_result_double(ctx, cur.results[cur.pos].first);
+        }
+        return SQLITE_OK;
+    }
+    if (col != vector_column) {
+        // Hidden columns are only used as inputs
+        return SQLITE_OK;
+    }
+    if (!cur.knn) {
+        ::sqlite3_result_value(ctx, cur.scan->row()[1].c_ptr());
+        return SQLITE_OK;
+    }
+    auto& vtab = get_vtab(cur.base.pVtab);
+    return guard_vtab(cur.base.pVtab, [&] {
+        auto& st = vtab.prepared(vtab.get_vector_st,
+                                 ufmt("SELECT vector FROM {} WHERE rowid = ?",
+                                      vtab.shadow("vectors")));
+        reset_and_bind(st, cur.results[cur.pos].second).throw_if_error();
+        auto rst = st.auto_reset();
+        if (st.step() == errc::row) {
+            ::sqlite3_result_value(ctx, st.row()[0].c_ptr());
+        }
+    });
+}
+
+int ivf_rowid(::sqlite3_vtab_cursor* cur_, ::sqlite3_int64* out) noexcept {
+    auto& cur = *reinterpret_cast<ivf_cursor*>(cur_);
+    *out      = cur.knn ? cur.results[cur.pos].second : cur.scan->row()[0].as_integer();
+    return SQLITE_OK;
+}
+
+int ivf_update(::sqlite3_vtab*   vtab_,
+               int               argc,
+               ::sqlite3_value** argv,
+               ::sqlite3_int64*  rowid_out) noexcept {
+    auto& vtab = get_vtab(vtab_);
+    return guard_vtab(vtab_, [&] {
+        const value_ref old_rowid{argv[0]};
+        if (argc == 1) {
+            vtab.delete_vector(old_rowid.as_integer());
+            return;
+        }
+        const value_ref new_rowid{argv[1]};
+        const value_ref vector{argv[2 + vector_column]};
+        if (new_rowid.is_null()) {
+            throw std::invalid_argument(
+                "A ROWID must be given when inserting into an ivf_flat index");
+        }
+        if (vector.is_null()) {
+            throw std::invalid_argument("Cannot insert a NULL vector into an ivf_flat index");
+        }
+        if (!old_rowid.is_null()) {
+            vtab.delete_vector(old_rowid.as_integer());
+        }
+        vtab.insert_vector(new_rowid.as_integer(), vector.as_blob());
+        *rowid_out = new_rowid.as_integer();
+    });
+}
+
+int ivf_begin(::sqlite3_vtab*) noexcept { return SQLITE_OK; }
+
+int ivf_rollback(::sqlite3_vtab* vtab) noexcept {
+    get_vtab(vtab).centroids_stale = true;
+    return SQLITE_OK;
+}
+
+int ivf_savepoint(::sqlite3_vtab*, int) noexcept { return SQLITE_OK; }
+
+int ivf_rollback_to(::sqlite3_vtab* vtab, int) noexcept { return ivf_rollback(vtab); }
+
+int ivf_rename(::sqlite3_vtab* vtab_, const char* new_name) noexcept {
+    auto& vtab = get_vtab(vtab_);
+    return guard_vtab(vtab_, [&] {
+        for (auto suffix : {"config", "centroids", "vectors"}) {
+            vtab.exec_sql(ufmt("ALTER TABLE {} RENAME TO {}",
+                               vtab.shadow(suffix),
+                               quote_identifier(std::string(new_name) + "_" + suffix)));
+        }
+        // Cached statements refer to the old names
+        vtab.insert_vector_st.reset();
+        vtab.delete_vector_st.reset();
+        vtab.get_vector_st.reset();
+        vtab.list_vectors_st.reset();
+        vtab.insert_centroid_st.reset();
+        vtab.name = new_name;
+    });
+}
+
+#if SQLITE_VERSION_NUMBER >= 3026000
+int ivf_shadow_name(const char* suffix) noexcept {
+    const std::string_view s = suffix;
+    return s == "config" || s == "centroids" || s == "vectors";
+}
+#endif
+
+constexpr ::sqlite3_module ivf_module = {
+#if SQLITE_VERSION_NUMBER >= 3026000
+    .iVersion = 3,
+#else
+    .iVersion = 2,
+#endif
+    .xCreate     = &ivf_create,
+    .xConnect    = &ivf_connect,
+    .xBestIndex  = &ivf_best_index,
+    .xDisconnect = &ivf_disconnect,
+    .xDestroy    = &ivf_destroy,
+    .xOpen       = &ivf_open,
+    .xClose      = &ivf_close,
+    .xFilter     = &ivf_filter,
+    .xNext       = &ivf_next,
+    .xEof        = &ivf_eof,
+    .xColumn     = &ivf_column,
+    .xRowid      = &ivf_rowid,
+    .xUpdate     = &ivf_update,
+    .xBegin      = &ivf_begin,
+    .xRollback   = &ivf_rollback,
+    .xRename     = &ivf_rename,
+    .xSavepoint  = &ivf_savepoint,
+    .xRelease    = &ivf_savepoint,
+    .xRollbackTo = &ivf_rollback_to,
+#if SQLITE_VERSION_NUMBER >= 3026000
+    .xShadowName = &ivf_shadow_name,
+#endif
+};
+
+}  // namespace
+
+void neo::sqlite3::register_ivf_module(connection_ref db, neo::zstring_view name) {
+    auto rc = ::sqlite3_create_module(db.c_ptr(), name.data(), &ivf_module, nullptr);
+    auto ec = to_error_code(rc);
+    if (ec) {
+        throw_error(ec, ufmt("Error while registering the ivf_flat module as '{}'", name), db);
+    }
+}
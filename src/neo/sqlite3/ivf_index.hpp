@@ -0,0 +1,46 @@
+#pragma once
+
+#include <neo/zstring_view.hpp>
+
+namespace neo::sqlite3 {
+
+class connection_ref;
+
+/**
+ * @brief Register the `ivf_flat` virtual table module: An approximate nearest-neighbor index over
+ * vectors stored as BLOBs of packed float32 values (as used by `register_vector_functions()`).
+ *
+ * Vectors are partitioned into "lists" by k-means clustering. A query only scans the lists whose
+ * centroids are nearest to the query vector, so the cost of a query is sub-linear in the number of
+ * indexed vectors, at the cost of (usually small) losses in recall.
+ *
+ * The index is persisted in shadow tables `<name>_config`, `<name>_centroids`, and
+ * `<name>_vectors` in the same database as the virtual table. It is created with:
+ *
+ *      CREATE VIRTUAL TABLE emb_idx USING ivf_flat(source=docs, column=emb)
+ *
+ * which will train the centroids and index every non-NULL vector in `docs.emb`, keyed by the
+ * ROWID of `docs`. The following options are also accepted:
+ *
+ * - `lists=<N>` - The number of lists. Default is the square root of the number of vectors.
+ * - `probes=<N>` - The number of lists that are scanned by a query. Default is the square root of
+ *   the number of lists.
+ * - `metric=l2|cosine` - The distance function used to rank results. Default is `l2`.
+ * - `dims=<N>` - The dimension of the vectors. Default is inferred from the first vector.
+ *
+ * The table has the columns `vector` and `distance`, and the hidden columns `query` and `k`.
+ * To find the `k` nearest neighbors of a vector, order by distance:
+ *
+ *      SELECT rowid, distance FROM emb_idx(?, 10)
+ *
+ * which is equivalent to `SELECT rowid, distance FROM emb_idx WHERE query = ? AND k = 10`.
+ *
+ * The index is NOT automatically updated when the source table changes. Use `INSERT`, `UPDATE`,
+ * and `DELETE` on the virtual table to keep it in sync (e.g. from triggers on the source table).
+ * Inserted vectors are assigned to the list with the nearest centroid, and the centroids are not
+ * re-trained. If the index was created without a source, the first `lists` vectors that are
+ * inserted become the centroids.
+ */
+void register_ivf_module(connection_ref db, neo::zstring_view name = "ivf_flat");
+
+}  // namespace neo::sqlite3
@@ -0,0 +1,136 @@
+#include <neo/sqlite3/exec.hpp>
+#include <neo/sqlite3/ivf_index.hpp>
+#include <neo/sqlite3/vector_functions.hpp>
+
+#include "./tests.inl"
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace neo::sqlite3;
+
+namespace {
+
+std::vector<float> random_vector(std::mt19937& rng, int dims) {
+    std::normal_distribution<float> dist;
+    std::vector<float>              ret;
+    for (auto i = 0; i < dims; ++i) {
+        ret.push_back(dist(rng));
+    }
+    return ret;
+}
+
+std::vector<std::int64_t> knn_rowids(statement& st, const std::vector<float>& query, int k) {
+    std::vector<std::int64_t> ids;
+    auto                      rows = *exec_tuples<std::int64_t>(st, blob_view(query), k);
+    for (auto [id] : rows) {
+        ids.push_back(id);
+    }
+    return ids;
+}
+
+}  // namespace
+
+TEST_CASE_METHOD(sqlite3_memory_db_fixture, "Build and query an IVF index") {
+    register_ivf_module(db);
+    register_vector_functions(db);
+    db.exec("CREATE TABLE docs (id INTEGER PRIMARY KEY, emb BLOB)").throw_if_error();
+
+    std::mt19937 rng{42};
+    auto         insert = *db.prepare("INSERT INTO docs (id, emb) VALUES (?, ?)");
+    for (auto i = 1; i <= 2000; ++i) {
+        auto vec = random_vector(rng, 16);
+        exec(insert, i, blob_view(vec)).throw_if_error();
+    }
+
+    db.exec("CREATE VIRTUAL TABLE emb_idx USING ivf_flat(source=docs, column=emb, lists=20, "
+            "probes=20)")
+        .throw_if_error();
+    auto count = *db.prepare("SELECT count(*) FROM emb_idx_vectors");
+    CHECK(*one_cell<int>(count) == 2000);
+    auto n_lists = *db.prepare("SELECT count(*) FROM emb_idx_centroids");
+    CHECK(*one_cell<int>(n_lists) == 20);
+
+    // With every list probed, the result is exact
+    auto knn   = *db.prepare("SELECT rowid FROM emb_idx(?, ?)");
+    auto brute = *db.prepare("SELECT id FROM docs ORDER BY vec_l2(emb, ?) LIMIT ?");
+    auto query = random_vector(rng, 16);
+    auto found = knn_rowids(knn, query, 10);
+    CHECK(found.size() == 10);
+    CHECK(found == knn_rowids(brute, query, 10));
+
+    // Results are ordered by distance
+    auto   dists = *db.prepare("SELECT distance FROM emb_idx WHERE query = ? AND k = 5");
+    auto   rows  = *exec_tuples<double>(dists, blob_view(query));
+    double prev  = 0;
+    for (auto [d] : rows) {
+        CHECK(d >= prev);
+        prev = d;
+    }
+
+    // A query vector with the wrong dimensions is an error
+    std::vector<float> bad_query(3);
+    CHECK(exec(knn, blob_view(bad_query), 10).is_error());
+}
+
+TEST_CASE_METHOD(sqlite3_memory_db_fixture, "Maintain an IVF index through insert and delete") {
+    register_ivf_module(db);
+    db.exec("CREATE VIRTUAL TABLE idx USING ivf_flat(lists=2, metric=cosine)").throw_if_error();
+    auto insert = *db.prepare("INSERT INTO idx (rowid, vector) VALUES (?, ?)");
+
+    std::vector<std::vector<float>> vecs = {{1, 0}, {0, 1}, {1, 0.1f}, {0.1f, 1}};
+    for (auto i = 0u; i < vecs.size(); ++i) {
+        exec(insert, static_cast<int>(i + 1), blob_view(vecs[i])).throw_if_error();
+    }
+    auto n_lists = *db.prepare("SELECT count(*) FROM idx_centroids");
+    CHECK(*one_cell<int>(n_lists) == 2);
+
+    auto               knn   = *db.prepare("SELECT rowid FROM idx(?, ?)");
+    std::vector<float> query = {1, 0.01f};
+    CHECK(knn_rowids(knn, query, 2) == std::vector<std::int64_t>{1, 3});
+
+    db.exec("DELETE FROM idx WHERE rowid = 1").throw_if_error();
+    CHECK(knn_rowids(knn, query, 2) == std::vector<std::int64_t>{3, 4});
+
+    // Vectors can be read back, and the index can be updated
+    auto get = *db.prepare("SELECT length(vector) FROM idx WHERE rowid = 2");
+    CHECK(*one_cell<int>(get) == 8);
+    db.exec("UPDATE idx SET vector = x'0000803f00000000' WHERE rowid = 2").throw_if_error();
+    CHECK(knn_rowids(knn, query, 2) == std::vector<std::int64_t>{2, 3});
+
+    // Dropping the table drops the shadow tables
+    db.exec("DROP TABLE idx").throw_if_error();
+    auto shadows = *db.prepare("SELECT count(*) FROM sqlite_master WHERE name LIKE 'idx%'");
+    CHECK(*one_cell<int>(shadows) == 0);
+}
+
+TEST_CASE_METHOD(sqlite3_memory_db_fixture, "Rename an IVF index") {
+    register_ivf_module(db);
+    db.exec("CREATE VIRTUAL TABLE idx USING ivf_flat(lists=1)").throw_if_error();
+    db.exec("INSERT INTO idx (rowid, vector) VALUES (1, x'0000803f00000000')").throw_if_error();
+    db.exec("ALTER TABLE idx RENAME TO renamed").throw_if_error();
+
+    auto names = *db.prepare(
+        "SELECT group_concat(name, ',') FROM "
+        "(SELECT name FROM sqlite_master WHERE type = 'table' AND name LIKE 'renamed%' "
+        " ORDER BY name)");
+    CHECK(*one_cell<std::string>(names)
+          == "renamed,renamed_centroids,renamed_config,renamed_vectors");
+    auto old = *db.prepare(
+        "SELECT count(*) FROM sqlite_master WHERE name LIKE '%idx%' OR tbl_name LIKE 'idx%'");
+    CHECK(*one_cell<int>(old) == 0);
+
+    // Lists are still found through an index
+    auto plan = *db.prepare(
+        "EXPLAIN QUERY PLAN SELECT rowid, vector FROM renamed_vectors WHERE list = 0");
+    auto [id, parent, unused, detail] = *one_row<int, int, int, std::string>(plan);
+    CHECK(detail.find("USING INDEX") != std::string::npos);
+
+    auto               knn   = *db.prepare("SELECT rowid FROM renamed(?, ?)");
+    std::vector<float> query = {1, 0};
+    CHECK(knn_rowids(knn, query, 1) == std::vector<std::int64_t>{1});
+
+    // The old name can be used again
+    db.exec("CREATE VIRTUAL TABLE idx USING ivf_flat(lists=1)").throw_if_error();
+}
@@ -0,0 +1,65 @@
+#include "./open_options.hpp"
+
+#include <neo/sqlite3/error.hpp>
+#include <neo/sqlite3/identifier.hpp>
+#include <neo/sqlite3/statement.hpp>
+#include <neo/sqlite3/statement_cache.hpp>
+
+#include <neo/event.hpp>
+#include <neo/ufmt.hpp>
+
+#include <string>
+
+using namespace neo::sqlite3;
+
+namespace {
+
+/// Read every row of the table, which loads each of its b-tree pages into the page cache
+errable<void> prefetch_table(connection_ref db, std::string_view table) {
+    auto st = db.prepare(neo::ufmt("SELECT * FROM main.{}", quote_identifier(table)));
+    if (!st.has_value()) {
+        return st.error();
+    }
+    return st->run_to_completion();
+}
+
+}  // namespace
+
+errable<connection> connection::open(neo::zstring_view s, const open_options& opts) noexcept {
+    if (opts.busy && opts.pragmas && opts.pragmas->busy_timeout) {
+        // PRAGMA busy_timeout would replace the busy handler of the policy
+        return {errc::misuse, "A busy policy and a busy_timeout pragma cannot both be given"};
+    }
+    auto db = _open(s, opts.mode, opts.vfs.empty() ? nullptr : opts.vfs.data());
+    if (!db.has_value()) {
+        return db;
+    }
+    try {
+        if (opts.busy) {
+            db->set_busy_policy(*opts.busy);
+        }
+        if (opts.pragmas) {
+            apply_profile(*db, *opts.pragmas);
+        }
+        for (auto& table : opts.prefetch_tables) {
+            prefetch_table(*db, table).throw_if_error();
+        }
+        auto& cache = db->statements();
+        for (auto sql : opts.warmup) {
+            std::ignore = cache(sql);
+        }
+    } catch (const error& e) {
+        // The message of the error cannot outlive this function, so it is only given to the event
+        const auto ec = static_cast<errc>(e.code().value());
+        neo::emit(event::open_error{s, ec, e.what()});
+        return {ec, "Failed to prepare a new connection"};
+    } catch (const std::bad_alloc&) {
+        return {errc::no_memory, "Failed to prepare a new connection"};
+    }
+    return db;
+}
+
+errable<connection>
+connection::open(neo::zstring_view s, openmode mode, const pragma_profile& profile) noexcept {
+    return open(s, open_options{.mode = mode, .pragmas = profile});
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <neo/sqlite3/busy_policy.hpp>
+#include <neo/sqlite3/connection.hpp>
+#include <neo/sqlite3/literal.hpp>
+#include <neo/sqlite3/pragma.hpp>
+
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace neo::sqlite3 {
+
+/**
+ * @brief Options for opening a connection with connection::open().
+ *
+ * After the connection is opened, it is prepared in the following order:
+ *
+ *  1. The busy policy is installed
+ *  2. The pragma profile is applied (see apply_profile())
+ *  3. The pages of each table in `prefetch_tables` are read into the page cache
+ *  4. Each statement in `warmup` is prepared into the connection's statement cache
+ *
+ * If any step fails, the connection is closed and the error is returned from open(). The message
+ * of the failure (e.g. naming a warmup statement that could not be prepared) is given to an
+ * event::open_error.
+ *
+ * A busy policy cannot be combined with a pragma profile that sets a `busy_timeout`, since the
+ * pragma would replace the busy handler of the policy.
+ */
+struct open_options {
+    /// The flags used to open the database
+    openmode mode = openmode::readwrite | openmode::create;
+    /// The name of a registered VFS to use. If empty, uses the default VFS
+    std::string vfs;
+    /// Pragma settings to apply to the new connection
+    std::optional<pragma_profile> pragmas;
+    /// The busy handler to install on the new connection
+    std::optional<busy_policy> busy;
+    /**
+     * @brief Statements to prepare when the connection is opened. Access them (without preparing
+     * them again) using connection_ref::statements().
+     */
+    std::vector<sql_string_literal> warmup;
+    /**
+     * @brief Tables in the "main" schema to read when the connection is opened, so that their
+     * pages are in the page cache (and OS cache) before the first query. The page cache must be
+     * large enough to hold them (see pragma_profile::cache_size).
+     */
+    std::vector<std::string> prefetch_tables;
+};
+
+}  // namespace neo::sqlite3
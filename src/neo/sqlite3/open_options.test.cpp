@@ -0,0 +1,82 @@
+#include <neo/sqlite3/exec.hpp>
+#include <neo/sqlite3/open_options.hpp>
+#include <neo/sqlite3/statement.hpp>
+#include <neo/sqlite3/statement_cache.hpp>
+
+#include "./tests.inl"
+
+#include <sqlite3/sqlite3.h>
+
+
+using namespace neo::sqlite3::literals;
+
+TEST_CASE_METHOD(sqlite3_temp_db_fixture, "Open a connection with options") {
+    {
+        auto db = *neo::sqlite3::open(path.string());
+        db.exec(R"(
+            CREATE TABLE foo (a INTEGER PRIMARY KEY, b TEXT);
+            WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < 2000)
+            INSERT INTO foo SELECT i, printf('%0100d', i) FROM n;
+        )")
+            .throw_if_error();
+    }
+
+    auto count_statements = [](neo::sqlite3::connection_ref db) {
+        int  n  = 0;
+        auto st = ::sqlite3_next_stmt(db.c_ptr(), nullptr);
+        while (st) {
+            ++n;
+            st = ::sqlite3_next_stmt(db.c_ptr(), st);
+        }
+        return n;
+    };
+
+    SECTION("Warm up a connection") {
+        auto db = *neo::sqlite3::open(path.string(),
+                                      neo::sqlite3::open_options{
+                                          .vfs     = "unix",
+                                          .pragmas = neo::sqlite3::pragma_profile::read_heavy(),
+                                          .busy    = neo::sqlite3::busy_policy::backoff(
+                                              std::chrono::milliseconds{100}),
+                                          .warmup = {"SELECT b FROM foo WHERE a = ?"_sql},
+                                          .prefetch_tables = {"foo"},
+                                      });
+        CHECK(neo::sqlite3::pragma::get_journal_mode(db) == neo::sqlite3::journal_mode::wal);
+        const auto n_prepared = count_statements(db);
+        CHECK(n_prepared >= 1);
+
+        int cur = 0, hi = 0;
+        ::sqlite3_db_status(db.c_ptr(), SQLITE_DBSTATUS_CACHE_MISS, &cur, &hi, 1);
+        auto& st = db.statements()("SELECT b FROM foo WHERE a = ?"_sql);
+        CHECK(*neo::sqlite3::one_cell<std::string>(st, 1999) == std::string(96, '0') + "1999");
+        // The statement was already prepared, and the table is already in the page cache
+        CHECK(count_statements(db) == n_prepared);
+        ::sqlite3_db_status(db.c_ptr(), SQLITE_DBSTATUS_CACHE_MISS, &cur, &hi, 0);
+        CHECK(cur == 0);
+    }
+
+    SECTION("Opening fails if preparation fails") {
+        auto db = neo::sqlite3::open(path.string(),
+                                     neo::sqlite3::open_options{
+                                         .warmup = {"SELECT * FROM nonesuch"_sql},
+                                     });
+        CHECK(db.is_error());
+        CHECK(db == neo::sqlite3::errc::error);
+        // The context does not refer to the failed connection, or to a message that it owned
+        CHECK(std::string_view(db.error().context()) == "Failed to prepare a new connection");
+        db = neo::sqlite3::open(path.string(), neo::sqlite3::open_options{.vfs = "no-such-vfs"});
+        CHECK(db.is_error());
+        db = neo::sqlite3::open(path.string(),
+                                neo::sqlite3::open_options{.prefetch_tables = {"nonesuch"}});
+        CHECK(db.is_error());
+
+        neo::sqlite3::pragma_profile profile{.busy_timeout = std::chrono::milliseconds{100}};
+        db = neo::sqlite3::open(path.string(),
+                                neo::sqlite3::open_options{
+                                    .pragmas = profile,
+                                    .busy    = neo::sqlite3::busy_policy::backoff(
+                                        std::chrono::milliseconds{100}),
+                                });
+        CHECK(db == neo::sqlite3::errc::misuse);
+    }
+}
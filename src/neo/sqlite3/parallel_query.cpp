@@ -0,0 +1,163 @@
+#include "./parallel_query.hpp"
+
+#include <neo/sqlite3/connection_pool.hpp>
+#include <neo/sqlite3/error.hpp>
+#include <neo/sqlite3/exec.hpp>
+#include <neo/sqlite3/identifier.hpp>
+#include <neo/sqlite3/open_options.hpp>
+#include <neo/sqlite3/snapshot.hpp>
+#include <neo/sqlite3/transaction.hpp>
+
+#include <neo/ufmt.hpp>
+
+#include <sqlite3/sqlite3.h>
+
+#include <thread>
+
+using namespace neo::sqlite3;
+
+namespace {
+
+std::optional<std::int64_t>
+rowid_bound(connection_ref db, std::string_view fn, std::string_view table) {
+    // min() and max() must each be the only aggregate in the query for SQLite to answer them
+    // from the b-tree, so the bounds are found with two queries
+    auto st = *db.prepare(neo::ufmt("SELECT {}(rowid) FROM main.{}", fn, quote_identifier(table)));
+    return *one_cell<std::optional<std::int64_t>>(st);
+}
+
+}  // namespace
+
+std::vector<rowid_range>
+neo::sqlite3::partition_rowids(connection_ref db, std::string_view table, std::size_t n) {
+    auto min = rowid_bound(db, "min", table);
+    auto max = rowid_bound(db, "max", table);
+    if (!min || !max || n == 0) {
+        return {};
+    }
+    // Compute the width as unsigned, since the span of rowids may not fit in an int64
+    auto span  = static_cast<std::uint64_t>(*max) - static_cast<std::uint64_t>(*min);
+    auto width = span / n + 1;
+    if (width == 0) {
+        // Every int64 is a rowid of the single range, so the width does not fit in a uint64
+        return {{*min, *max}};
+    }
+
+    std::vector<rowid_range> ranges;
+    auto                     first = static_cast<std::uint64_t>(*min);
+    while (true) {
+        auto remaining = static_cast<std::uint64_t>(*max) - first;
+        if (remaining < width) {
+            ranges.push_back({static_cast<std::int64_t>(first), *max});
+            break;
+        }
+        ranges.push_back({static_cast<std::int64_t>(first),
+                          static_cast<std::int64_t>(first + width - 1)});
+        first += width;
+    }
+    return ranges;
+}
+
+struct detail::partitioned_query::reader {
+    std::optional<connection>             owned;
+    std::optional<connection_pool::lease> leased;
+    std::optional<transaction_guard>      tr;
+    std::optional<statement>              st;
+
+    connection_ref db() noexcept { return owned ? connection_ref(*owned) : **leased; }
+};
+
+detail::partitioned_query::partitioned_query(connection_ref                db,
+                                             std::string_view              table,
+                                             std::string_view              sql,
+                                             const parallel_query_options& opts) {
+    open_options reader_opts{.mode = openmode::readonly};
+    auto         filename = db.filename();
+    if (!opts.readers) {
+        if (filename.empty()) {
+            throw_error(make_error_code(errc::misuse),
+                        "A parallel query requires a database file to open reader connections",
+                        std::string(table));
+        }
+        ::sqlite3_vfs* vfs = nullptr;
+        ::sqlite3_file_control(db.c_ptr(), "main", SQLITE_FCNTL_VFS_POINTER, &vfs);
+        if (vfs) {
+            reader_opts.vfs = vfs->zName;
+        }
+    }
+
+    auto n = opts.n_partitions;
+    if (n == 0) {
+        n = opts.readers ? opts.readers->size()
+                         : std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    if (opts.readers) {
+        // Leasing more connections than the pool holds would wait forever
+        n = std::min(n, opts.readers->size());
+    }
+
+    // When using a snapshot, the partitions are computed within the same read transaction as
+    // the snapshot, so that they agree with the data that the readers will see
+    std::optional<recursive_transaction_guard> tr;
+    if (opts.use_snapshot) {
+        tr.emplace(db);
+    }
+    auto ranges = partition_rowids(db, table, n);
+    if (ranges.empty()) {
+        return;
+    }
+    std::optional<snapshot> snap;
+    if (opts.use_snapshot) {
+        snap.emplace(*db.get_snapshot());
+    }
+
+    for (auto range : ranges) {
+        auto r = std::make_unique<reader>();
+        if (opts.readers) {
+            r->leased.emplace(opts.readers->acquire());
+        } else {
+            r->owned.emplace(*connection::open(filename, reader_opts));
+        }
+        if (snap) {
+            r->tr.emplace(r->db());
+            r->db().open_snapshot(*snap).throw_if_error();
+        }
+        r->st.emplace(*r->db().prepare(sql));
+        r->st->bindings().bind_tuple(std::tuple(range.first, range.last)).throw_if_error();
+        _readers.push_back(std::move(r));
+    }
+}
+
+detail::partitioned_query::~partitioned_query() = default;
+
+statement& detail::partitioned_query::operator[](std::size_t n) noexcept {
+    return *_readers[n]->st;
+}
+
+void detail::partitioned_query::run(const std::function<void(std::size_t)>& fn) {
+    if (size() == 0) {
+        return;
+    }
+    std::vector<std::exception_ptr> errors(size());
+    auto                            run_one = [&](std::size_t n) {
+        try {
+            fn(n);
+        } catch (...) {
+            errors[n] = std::current_exception();
+        }
+    };
+    std::vector<std::thread> threads;
+    threads.reserve(size() - 1);
+    for (auto n = 0u; n + 1 < size(); ++n) {
+        threads.emplace_back(run_one, n);
+    }
+    run_one(size() - 1);
+    for (auto& t : threads) {
+        t.join();
+    }
+    for (auto& e : errors) {
+        if (e) {
+            std::rethrow_exception(e);
+        }
+    }
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <neo/sqlite3/connection.hpp>
+#include <neo/sqlite3/statement.hpp>
+
+#include <concepts>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace neo::sqlite3 {
+
+class connection_pool;
+
+/**
+ * @brief An inclusive range of rowids
+ */
+struct rowid_range {
+    std::int64_t first;
+    std::int64_t last;
+};
+
+/**
+ * @brief Split the rowids of a table into at most `n` contiguous ranges of equal width.
+ *
+ * The bounds are found with min(rowid) and max(rowid), which SQLite answers from the table
+ * b-tree without scanning it. (sqlite_stat1 records only row counts, not the distribution of
+ * rowids, so it cannot improve on this.) Ranges may contain different numbers of rows if rowids
+ * are sparse. Returns no ranges if the table is empty.
+ */
+[[nodiscard]] std::vector<rowid_range>
+partition_rowids(connection_ref db, std::string_view table, std::size_t n);
+
+/**
+ * @brief Options for parallel_reduce()
+ */
+struct parallel_query_options {
+    /// The number of partitions, each read by its own connection and thread. If zero, uses
+    /// std::thread::hardware_concurrency(), or the size of `readers`
+    std::size_t n_partitions = 0;
+    /**
+     * @brief A pool of connections to the same database with which to read the partitions. A
+     * connection is leased for each partition (at most the size of the pool) for the duration of
+     * the query. If null, a read-only connection is opened for each partition using the file and
+     * VFS of the given connection.
+     */
+    connection_pool* readers = nullptr;
+    /**
+     * @brief If `true`, every partition reads from a snapshot of the database taken when the
+     * query starts, so that the partitions see a single consistent state even while other
+     * connections write. Requires snapshot support (see snapshot).
+     */
+    bool use_snapshot = false;
+};
+
+namespace detail {
+
+/**
+ * @brief A query prepared on a reader connection for each of the rowid ranges of a table.
+ */
+class partitioned_query {
+    struct reader;
+    std::vector<std::unique_ptr<reader>> _readers;
+
+public:
+    partitioned_query(connection_ref                db,
+                      std::string_view              table,
+                      std::string_view              sql,
+                      const parallel_query_options& opts);
+    ~partitioned_query();
+
+    [[nodiscard]] std::size_t size() const noexcept { return _readers.size(); }
+
+    /// Get the statement of the Nth partition, with the bounds of the partition already bound
+    [[nodiscard]] statement& operator[](std::size_t n) noexcept;
+
+    /**
+     * @brief Invoke `fn(n)` for every partition `n`, each on its own thread (the last partition
+     * runs on the calling thread). Rethrows the first exception
+     */
+    void run(const std::function<void(std::size_t)>& fn);
+};
+
+}  // namespace detail
+
+/**
+ * @brief Execute a query over a rowid table in parallel, by splitting the rowids of the table
+ * into ranges and running the query for each range on a separate connection and thread.
+ *
+ * @param db A connection to the database. Unless a pool of readers is given in `opts`, its
+ * filename and VFS are used to open the reader connections, so it may not be an in-memory
+ * database.
+ * @param table The name of the table to partition (in the "main" schema).
+ * @param sql The query to run for each partition. The first and last rowid of the partition are
+ * bound to parameters ?1 and ?2, which the query must use to restrict its rows, e.g.
+ * "SELECT sum(size) FROM files WHERE rowid BETWEEN ?1 AND ?2".
+ * @param init The initial value of the result.
+ * @param map Invoked as `map(statement&)` on the thread of each partition, and should step
+ * through the statement to compute a result for the partition.
+ * @param reduce Invoked as `acc = reduce(std::move(acc), std::move(part))` on the calling thread
+ * for the result of each partition, in rowid order.
+ * @return T The final accumulated result.
+ *
+ * If any invocation of `map` throws, the first exception is rethrown after all threads finish.
+ */
+template <typename T, typename Map, typename Reduce>
+requires std::invocable<Map&, statement&>  //
+    && std::is_invocable_r_v<T, Reduce&, T&&, std::invoke_result_t<Map&, statement&>&&>
+T parallel_reduce(connection_ref                db,
+                  std::string_view              table,
+                  std::string_view              sql,
+                  T                             init,
+                  Map&&                         map,
+                  Reduce&&                      reduce,
+                  const parallel_query_options& opts = {}) {
+    using part_type = std::invoke_result_t<Map&, statement&>;
+    detail::partitioned_query             query{db, table, sql, opts};
+    std::vector<std::optional<part_type>> parts(query.size());
+    query.run([&](std::size_t n) { parts[n].emplace(map(query[n])); });
+    for (auto& part : parts) {
+        init = reduce(std::move(init), std::move(*part));
+    }
+    return init;
+}
+
+}  // namespace neo::sqlite3
@@ -0,0 +1,143 @@
+#include <neo/sqlite3/error.hpp>
+#include <neo/sqlite3/exec.hpp>
+#include <neo/sqlite3/io_stats_vfs.hpp>
+#include <neo/sqlite3/open_options.hpp>
+#include <neo/sqlite3/parallel_query.hpp>
+#include <neo/sqlite3/pragma.hpp>
+#include <neo/sqlite3/shared_memory_db.hpp>
+
+#include "./tests.inl"
+
+#include <limits>
+
+TEST_CASE_METHOD(sqlite3_memory_db_fixture, "Partition the rowids of a table") {
+    db.exec("CREATE TABLE foo (a)").throw_if_error();
+    CHECK(neo::sqlite3::partition_rowids(db, "foo", 4).empty());
+
+    db.exec("INSERT INTO foo (rowid, a) VALUES (-5, 0), (94, 0)").throw_if_error();
+    auto ranges = neo::sqlite3::partition_rowids(db, "foo", 4);
+    REQUIRE(ranges.size() == 4);
+    CHECK(ranges.front().first == -5);
+    CHECK(ranges.back().last == 94);
+    for (auto i = 1u; i < ranges.size(); ++i) {
+        CHECK(ranges[i].first == ranges[i - 1].last + 1);
+    }
+
+    // There cannot be more ranges than rowids
+    db.exec("DELETE FROM foo WHERE rowid = 94").throw_if_error();
+    ranges = neo::sqlite3::partition_rowids(db, "foo", 4);
+    REQUIRE(ranges.size() == 1);
+    CHECK(ranges[0].first == -5);
+    CHECK(ranges[0].last == -5);
+
+    db.exec(R"(
+        INSERT INTO foo (rowid, a)
+        VALUES (9223372036854775807, 0), (-9223372036854775808, 0)
+    )")
+        .throw_if_error();
+    ranges = neo::sqlite3::partition_rowids(db, "foo", 3);
+    REQUIRE(ranges.size() == 3);
+    CHECK(ranges.front().first == std::numeric_limits<std::int64_t>::min());
+    CHECK(ranges.back().last == std::numeric_limits<std::int64_t>::max());
+    ranges = neo::sqlite3::partition_rowids(db, "foo", 1);
+    REQUIRE(ranges.size() == 1);
+    CHECK(ranges[0].first == std::numeric_limits<std::int64_t>::min());
+    CHECK(ranges[0].last == std::numeric_limits<std::int64_t>::max());
+}
+
+TEST_CASE_METHOD(sqlite3_temp_db_fixture, "Run a query in parallel over rowid ranges") {
+    {
+        auto db = *neo::sqlite3::open(path.string());
+        neo::sqlite3::pragma::set_journal_mode(db, neo::sqlite3::journal_mode::wal);
+        db.exec(R"(
+            CREATE TABLE foo (a INTEGER);
+            WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < 10000)
+            INSERT INTO foo SELECT i FROM n;
+        )")
+            .throw_if_error();
+
+        auto sum_rows = [](neo::sqlite3::statement& st) {
+            return *neo::sqlite3::one_cell<std::int64_t>(st);
+        };
+        auto add = [](std::int64_t acc, std::int64_t part) { return acc + part; };
+
+        auto total = neo::sqlite3::parallel_reduce(
+            db,
+            "foo",
+            "SELECT sum(a) FROM foo WHERE rowid BETWEEN ?1 AND ?2",
+            std::int64_t{0},
+            sum_rows,
+            add,
+            {.n_partitions = 4});
+        CHECK(total == 10000 * 10001 / 2);
+
+        // Partial results are reduced in rowid order
+        auto firsts = neo::sqlite3::parallel_reduce(
+            db,
+            "foo",
+            "SELECT min(a) FROM foo WHERE rowid BETWEEN ?1 AND ?2",
+            std::vector<std::int64_t>{},
+            sum_rows,
+            [](std::vector<std::int64_t> acc, std::int64_t part) {
+                acc.push_back(part);
+                return acc;
+            },
+            {.n_partitions = 4});
+        CHECK(firsts == std::vector<std::int64_t>{1, 2501, 5001, 7501});
+
+        auto throws = [](neo::sqlite3::statement&) -> int {
+            throw std::runtime_error("Partition failed");
+        };
+        CHECK_THROWS_AS(neo::sqlite3::parallel_reduce(db, "foo", "SELECT ?1, ?2", 0, throws, add),
+                        std::runtime_error);
+    }
+    {
+        // Readers are opened with the VFS of the given connection
+        neo::sqlite3::io_stats_vfs vfs{"neo-parallel-query-test"};
+        auto db = *neo::sqlite3::connection::open(path.string(),
+                                                  neo::sqlite3::open_options{.vfs = vfs.name()});
+        auto n_locks = vfs.stats(neo::sqlite3::file_kind::main_db).n_locks;
+        auto total   = neo::sqlite3::parallel_reduce(
+            db,
+            "foo",
+            "SELECT count(*) FROM foo WHERE rowid BETWEEN ?1 AND ?2",
+            0,
+            [](neo::sqlite3::statement& st) { return *neo::sqlite3::one_cell<int>(st); },
+            [](int acc, int part) { return acc + part; },
+            {.n_partitions = 4});
+        CHECK(total == 10000);
+        // Each reader took at least a shared lock through the VFS
+        CHECK(vfs.stats(neo::sqlite3::file_kind::main_db).n_locks >= n_locks + 4);
+    }
+}
+
+TEST_CASE_METHOD(sqlite3_memory_db_fixture, "A parallel query requires a database file") {
+    db.exec("CREATE TABLE foo (a); INSERT INTO foo VALUES (1)").throw_if_error();
+    auto count = [](neo::sqlite3::statement&) { return 0; };
+    auto add   = [](int a, int b) { return a + b; };
+    CHECK_THROWS_AS(neo::sqlite3::parallel_reduce(db, "foo", "SELECT ?1, ?2", 0, count, add),
+                    neo::sqlite3::error);
+}
+
+TEST_CASE("Run a parallel query on a pool of readers") {
+    neo::sqlite3::shared_memory_db mem{"neo-sqlite3-parallel-query-test", 3};
+    mem.writer()
+        .exec(R"(
+            CREATE TABLE foo (a INTEGER);
+            WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < 999)
+            INSERT INTO foo SELECT i FROM n;
+        )")
+        .throw_if_error();
+
+    auto total = neo::sqlite3::parallel_reduce(
+        mem.writer(),
+        "foo",
+        "SELECT sum(a) FROM foo WHERE rowid BETWEEN ?1 AND ?2",
+        std::int64_t{0},
+        [](neo::sqlite3::statement& st) { return *neo::sqlite3::one_cell<std::int64_t>(st); },
+        [](std::int64_t acc, std::int64_t part) { return acc + part; },
+        {.n_partitions = 8, .readers = &mem.readers()});
+    CHECK(total == 999 * 1000 / 2);
+    // Every lease was returned
+    CHECK(mem.readers().available() == 3);
+}
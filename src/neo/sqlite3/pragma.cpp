@@ -0,0 +1,256 @@
+#include "./pragma.hpp"
+
+#include <neo/sqlite3/connection_ref.hpp>
+#include <neo/sqlite3/error.hpp>
+#include <neo/sqlite3/exec.hpp>
+
+#include <neo/ufmt.hpp>
+
+#include <initializer_list>
+#include <string>
+
+using namespace neo::sqlite3;
+
+namespace {
+
+template <typename T>
+T get_pragma(connection_ref db, std::string_view name) {
+    return *one_cell<T>(*db.prepare(neo::ufmt("PRAGMA {}", name)));
+}
+
+template <typename T>
+void set_pragma(connection_ref db, std::string_view name, const T& value) {
+    db.exec(neo::ufmt("PRAGMA {} = {}", name, value)).throw_if_error();
+}
+
+template <typename Enum>
+Enum enum_from_string(std::string_view str, std::initializer_list<Enum> candidates) {
+    for (auto e : candidates) {
+        if (to_string(e) == str) {
+            return e;
+        }
+    }
+    throw_error(make_error_code(errc::error),
+                "Unexpected value returned by a pragma",
+                std::string(str));
+}
+
+}  // namespace
+
+std::string_view neo::sqlite3::to_string(journal_mode m) noexcept {
+    switch (m) {
+    case journal_mode::delete_:
+        return "delete";
+    case journal_mode::truncate:
+        return "truncate";
+    case journal_mode::persist:
+        return "persist";
+    case journal_mode::memory:
+        return "memory";
+    case journal_mode::wal:
+        return "wal";
+    case journal_mode::off:
+        return "off";
+    }
+    return "<invalid journal_mode>";
+}
+
+std::string_view neo::sqlite3::to_string(synchronous_mode m) noexcept {
+    switch (m) {
+    case synchronous_mode::off:
+        return "off";
+    case synchronous_mode::normal:
+        return "normal";
+    case synchronous_mode::full:
+        return "full";
+    case synchronous_mode::extra:
+        return "extra";
+    }
+    return "<invalid synchronous_mode>";
+}
+
+std::string_view neo::sqlite3::to_string(temp_store_mode m) noexcept {
+    switch (m) {
+    case temp_store_mode::default_:
+        return "default";
+    case temp_store_mode::file:
+        return "file";
+    case temp_store_mode::memory:
+        return "memory";
+    }
+    return "<invalid temp_store_mode>";
+}
+
+std::string_view neo::sqlite3::to_string(locking_mode m) noexcept {
+    switch (m) {
+    case locking_mode::normal:
+        return "normal";
+    case locking_mode::exclusive:
+        return "exclusive";
+    }
+    return "<invalid locking_mode>";
+}
+
+journal_mode pragma::get_journal_mode(connection_ref db) {
+    return enum_from_string(get_pragma<std::string>(db, "journal_mode"),
+                            {
+                                journal_mode::delete_,
+                                journal_mode::truncate,
+                                journal_mode::persist,
+                                journal_mode::memory,
+                                journal_mode::wal,
+                                journal_mode::off,
+                            });
+}
+
+journal_mode pragma::set_journal_mode(connection_ref db, journal_mode mode) {
+    // Setting the journal mode returns the new mode, which may not be the requested mode
+    set_pragma(db, "journal_mode", to_string(mode));
+    return get_journal_mode(db);
+}
+
+synchronous_mode pragma::get_synchronous(connection_ref db) {
+    return static_cast<synchronous_mode>(get_pragma<int>(db, "synchronous"));
+}
+
+void pragma::set_synchronous(connection_ref db, synchronous_mode mode) {
+    set_pragma(db, "synchronous", static_cast<int>(mode));
+}
+
+std::int64_t pragma::get_cache_size(connection_ref db) {
+    return get_pragma<std::int64_t>(db, "cache_size");
+}
+
+void pragma::set_cache_size(connection_ref db, std::int64_t size) {
+    set_pragma(db, "cache_size", size);
+}
+
+std::int64_t pragma::get_mmap_size(connection_ref db) {
+    // Databases that cannot be memory-mapped (e.g. in-memory databases) return no value
+    auto st  = *db.prepare("PRAGMA mmap_size");
+    auto row = next<std::int64_t>(st);
+    if (row.errc() == errc::done) {
+        return 0;
+    }
+    return std::get<0>(row->as_tuple());
+}
+
+void pragma::set_mmap_size(connection_ref db, std::int64_t size) {
+    set_pragma(db, "mmap_size", size);
+}
+
+temp_store_mode pragma::get_temp_store(connection_ref db) {
+    return static_cast<temp_store_mode>(get_pragma<int>(db, "temp_store"));
+}
+
+void pragma::set_temp_store(connection_ref db, temp_store_mode mode) {
+    set_pragma(db, "temp_store", static_cast<int>(mode));
+}
+
+int pragma::get_wal_autocheckpoint(connection_ref db) {
+    return get_pragma<int>(db, "wal_autocheckpoint");
+}
+
+void pragma::set_wal_autocheckpoint(connection_ref db, int n_pages) {
+    set_pragma(db, "wal_autocheckpoint", n_pages);
+}
+
+int pragma::get_page_size(connection_ref db) { return get_pragma<int>(db, "page_size"); }
+
+void pragma::set_page_size(connection_ref db, int size) { set_pragma(db, "page_size", size); }
+
+int pragma::get_threads(connection_ref db) { return get_pragma<int>(db, "threads"); }
+
+void pragma::set_threads(connection_ref db, int n_threads) {
+    set_pragma(db, "threads", n_threads);
+}
+
+std::chrono::milliseconds pragma::get_busy_timeout(connection_ref db) {
+    return std::chrono::milliseconds{get_pragma<std::int64_t>(db, "busy_timeout")};
+}
+
+void pragma::set_busy_timeout(connection_ref db, std::chrono::milliseconds timeout) {
+    set_pragma(db, "busy_timeout", timeout.count());
+}
+
+locking_mode pragma::get_locking_mode(connection_ref db) {
+    return enum_from_string(get_pragma<std::string>(db, "locking_mode"),
+                            {locking_mode::normal, locking_mode::exclusive});
+}
+
+void pragma::set_locking_mode(connection_ref db, locking_mode mode) {
+    set_pragma(db, "locking_mode", to_string(mode));
+}
+
+pragma_profile pragma_profile::read_heavy() noexcept {
+    return {
+        .journal_mode = journal_mode::wal,
+        .synchronous  = synchronous_mode::normal,
+        .cache_size   = -64 * 1024,
+        .mmap_size    = 256 * 1024 * 1024,
+        .temp_store   = temp_store_mode::memory,
+    };
+}
+
+pragma_profile pragma_profile::write_heavy() noexcept {
+    return {
+        .journal_mode       = journal_mode::wal,
+        .synchronous        = synchronous_mode::normal,
+        .cache_size         = -64 * 1024,
+        .temp_store         = temp_store_mode::memory,
+        .wal_autocheckpoint = 4000,
+    };
+}
+
+pragma_profile pragma_profile::bulk_ingest() noexcept {
+    return {
+        .journal_mode = journal_mode::memory,
+        .synchronous  = synchronous_mode::off,
+        .cache_size   = -256 * 1024,
+        .temp_store   = temp_store_mode::memory,
+        .threads      = 4,
+        .locking_mode = locking_mode::exclusive,
+    };
+}
+
+void neo::sqlite3::apply_profile(connection_ref db, const pragma_profile& profile) {
+    if (profile.page_size) {
+        pragma::set_page_size(db, *profile.page_size);
+    }
+    // The locking mode must be set before entering WAL mode for it to affect the WAL
+    if (profile.locking_mode) {
+        pragma::set_locking_mode(db, *profile.locking_mode);
+    }
+    if (profile.journal_mode) {
+        // SQLite silently keeps the current mode if it cannot change it (e.g. WAL is requested for
+        // an in-memory database, or another connection has the database open)
+        auto mode = pragma::set_journal_mode(db, *profile.journal_mode);
+        if (mode != *profile.journal_mode) {
+            throw_error(make_error_code(errc::error),
+                        neo::ufmt("Failed to set the journal mode to '{}'",
+                                  to_string(*profile.journal_mode)),
+                        neo::ufmt("The journal mode is still '{}'", to_string(mode)));
+        }
+    }
+    if (profile.synchronous) {
+        pragma::set_synchronous(db, *profile.synchronous);
+    }
+    if (profile.cache_size) {
+        pragma::set_cache_size(db, *profile.cache_size);
+    }
+    if (profile.mmap_size) {
+        pragma::set_mmap_size(db, *profile.mmap_size);
+    }
+    if (profile.temp_store) {
+        pragma::set_temp_store(db, *profile.temp_store);
+    }
+    if (profile.wal_autocheckpoint) {
+        pragma::set_wal_autocheckpoint(db, *profile.wal_autocheckpoint);
+    }
+    if (profile.threads) {
+        pragma::set_threads(db, *profile.threads);
+    }
+    if (profile.busy_timeout) {
+        pragma::set_busy_timeout(db, *profile.busy_timeout);
+    }
+}
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+namespace neo::sqlite3 {
+
+class connection_ref;
+
+/**
+ * @brief Values of `PRAGMA journal_mode`. See https://sqlite.org/pragma.html#pragma_journal_mode
+ */
+enum class journal_mode {
+    /// DELETE (Named with a trailing underscore, because 'delete' is a keyword)
+    delete_,
+    truncate,
+    persist,
+    memory,
+    wal,
+    off,
+};
+
+/**
+ * @brief Values of `PRAGMA synchronous`. See https://sqlite.org/pragma.html#pragma_synchronous
+ */
+enum class synchronous_mode {
+    off    = 0,
+    normal = 1,
+    full   = 2,
+    extra  = 3,
+};
+
+/**
+ * @brief Values of `PRAGMA temp_store`. See https://sqlite.org/pragma.html#pragma_temp_store
+ */
+enum class temp_store_mode {
+    /// DEFAULT (Named with a trailing underscore, because 'default' is a keyword)
+    default_ = 0,
+    file     = 1,
+    memory   = 2,
+};
+
+/**
+ * @brief Values of `PRAGMA locking_mode`. See https://sqlite.org/pragma.html#pragma_locking_mode
+ */
+enum class locking_mode {
+    normal,
+    exclusive,
+};
+
+[[nodiscard]] std::string_view to_string(journal_mode) noexcept;
+[[nodiscard]] std::string_view to_string(synchronous_mode) noexcept;
+[[nodiscard]] std::string_view to_string(temp_store_mode) noexcept;
+[[nodiscard]] std::string_view to_string(locking_mode) noexcept;
+
+/**
+ * @brief Typed accessors for the performance-related pragmas of the "main" database of a
+ * connection. See https://sqlite.org/pragma.html for the meaning of each setting.
+ *
+ * Every function throws neo::sqlite3::error if executing the pragma fails.
+ */
+namespace pragma {
+
+[[nodiscard]] journal_mode get_journal_mode(connection_ref db);
+/**
+ * @brief Change the journal mode. If the journal mode cannot be changed (e.g. in-memory databases
+ * only support "memory" and "off"), the journal mode is left unchanged.
+ *
+ * @return The journal mode that is in effect after the change
+ */
+journal_mode set_journal_mode(connection_ref db, journal_mode mode);
+
+[[nodiscard]] synchronous_mode get_synchronous(connection_ref db);
+void                           set_synchronous(connection_ref db, synchronous_mode mode);
+
+/// Positive values are a number of pages, negative values are a number of KiB
+[[nodiscard]] std::int64_t get_cache_size(connection_ref db);
+void                       set_cache_size(connection_ref db, std::int64_t size);
+
+/// The maximum number of bytes of the database file that will be memory-mapped
+[[nodiscard]] std::int64_t get_mmap_size(connection_ref db);
+void                       set_mmap_size(connection_ref db, std::int64_t size);
+
+[[nodiscard]] temp_store_mode get_temp_store(connection_ref db);
+void                          set_temp_store(connection_ref db, temp_store_mode mode);
+
+/// The number of WAL pages that trigger an automatic checkpoint. Zero or negative disables them
+[[nodiscard]] int get_wal_autocheckpoint(connection_ref db);
+void              set_wal_autocheckpoint(connection_ref db, int n_pages);
+
+/// Changing the page size only takes effect before the database is created, or on VACUUM
+[[nodiscard]] int get_page_size(connection_ref db);
+void              set_page_size(connection_ref db, int size);
+
+/// The maximum number of auxiliary threads that a prepared statement may use
+[[nodiscard]] int get_threads(connection_ref db);
+void              set_threads(connection_ref db, int n_threads);
+
+/// Setting the busy timeout replaces any busy handler, including connection_ref::set_busy_policy()
+[[nodiscard]] std::chrono::milliseconds get_busy_timeout(connection_ref db);
+void set_busy_timeout(connection_ref db, std::chrono::milliseconds timeout);
+
+[[nodiscard]] locking_mode get_locking_mode(connection_ref db);
+void                       set_locking_mode(connection_ref db, locking_mode mode);
+
+}  // namespace pragma
+
+/**
+ * @brief A set of pragma settings that can be applied to a connection at once.
+ *
+ * Settings that are `nullopt` are left unchanged. Use the named profiles as a starting point for
+ * common workloads.
+ */
+struct pragma_profile {
+    std::optional<int>                       page_size;
+    std::optional<sqlite3::journal_mode>     journal_mode;
+    std::optional<synchronous_mode>          synchronous;
+    std::optional<std::int64_t>              cache_size;
+    std::optional<std::int64_t>              mmap_size;
+    std::optional<temp_store_mode>           temp_store;
+    std::optional<int>                       wal_autocheckpoint;
+    std::optional<int>                       threads;
+    std::optional<std::chrono::milliseconds> busy_timeout;
+    std::optional<sqlite3::locking_mode>     locking_mode;
+
+    /**
+     * @brief Many concurrent readers and occasional writers: WAL mode, a large page cache, and
+     * memory-mapped I/O
+     */
+    [[nodiscard]] static pragma_profile read_heavy() noexcept;
+
+    /**
+     * @brief Frequent small write transactions: WAL mode with relaxed syncing, and less frequent
+     * checkpoints
+     */
+    [[nodiscard]] static pragma_profile write_heavy() noexcept;
+
+    /**
+     * @brief A single connection loading a large amount of data: No durability against crashes,
+     * exclusive locking, a very large page cache, and multi-threaded sorting for index builds.
+     *
+     * See also: bulk_load_session, which temporarily applies similar settings.
+     */
+    [[nodiscard]] static pragma_profile bulk_ingest() noexcept;
+};
+
+/**
+ * @brief Apply each setting of the profile to the connection.
+ *
+ * The page size is applied first, so that it takes effect for new databases, followed by the
+ * locking mode and the journal mode. Throws neo::sqlite3::error if any setting fails (including
+ * if the journal mode cannot be changed), in which case the settings before it will have been
+ * applied.
+ */
+void apply_profile(connection_ref db, const pragma_profile& profile);
+
+}  // namespace neo::sqlite3
@@ -0,0 +1,82 @@
+#include <neo/sqlite3/connection.hpp>
+#include <neo/sqlite3/error.hpp>
+#include <neo/sqlite3/pragma.hpp>
+
+#include "./tests.inl"
+
+namespace pragma = neo::sqlite3::pragma;
+using namespace std::chrono_literals;
+
+TEST_CASE_METHOD(sqlite3_memory_db_fixture, "Get and set pragmas") {
+    CHECK(pragma::get_journal_mode(db) == neo::sqlite3::journal_mode::memory);
+    // In-memory databases cannot use WAL
+    CHECK(pragma::set_journal_mode(db, neo::sqlite3::journal_mode::wal)
+          == neo::sqlite3::journal_mode::memory);
+    CHECK(pragma::set_journal_mode(db, neo::sqlite3::journal_mode::off)
+          == neo::sqlite3::journal_mode::off);
+
+    pragma::set_synchronous(db, neo::sqlite3::synchronous_mode::normal);
+    CHECK(pragma::get_synchronous(db) == neo::sqlite3::synchronous_mode::normal);
+
+    pragma::set_cache_size(db, -4096);
+    CHECK(pragma::get_cache_size(db) == -4096);
+
+    pragma::set_temp_store(db, neo::sqlite3::temp_store_mode::memory);
+    CHECK(pragma::get_temp_store(db) == neo::sqlite3::temp_store_mode::memory);
+
+    pragma::set_wal_autocheckpoint(db, 500);
+    CHECK(pragma::get_wal_autocheckpoint(db) == 500);
+
+    pragma::set_busy_timeout(db, 1234ms);
+    CHECK(pragma::get_busy_timeout(db) == 1234ms);
+
+    pragma::set_locking_mode(db, neo::sqlite3::locking_mode::exclusive);
+    CHECK(pragma::get_locking_mode(db) == neo::sqlite3::locking_mode::exclusive);
+
+    pragma::set_threads(db, 2);
+    CHECK(pragma::get_threads(db) <= 2);
+
+    // In-memory databases are never memory-mapped
+    pragma::set_mmap_size(db, 1024 * 1024);
+    CHECK(pragma::get_mmap_size(db) == 0);
+
+    CHECK(pragma::get_page_size(db) > 0);
+}
+
+TEST_CASE_METHOD(sqlite3_temp_db_fixture, "Open a database with a pragma profile") {
+    {
+        auto profile      = neo::sqlite3::pragma_profile::write_heavy();
+        profile.page_size = 8192;
+        auto db           = *neo::sqlite3::open(path.string(), profile);
+        CHECK(pragma::get_journal_mode(db) == neo::sqlite3::journal_mode::wal);
+        CHECK(pragma::get_synchronous(db) == neo::sqlite3::synchronous_mode::normal);
+        CHECK(pragma::get_wal_autocheckpoint(db) == 4000);
+        CHECK(pragma::get_page_size(db) == 8192);
+    }
+    {
+        auto db = *neo::sqlite3::open(path.string(), neo::sqlite3::pragma_profile::read_heavy());
+        CHECK(pragma::get_journal_mode(db) == neo::sqlite3::journal_mode::wal);
+        CHECK(pragma::get_cache_size(db) == -64 * 1024);
+        CHECK(pragma::get_temp_store(db) == neo::sqlite3::temp_store_mode::memory);
+    }
+    {
+        auto db = *neo::sqlite3::open(path.string(), neo::sqlite3::pragma_profile::bulk_ingest());
+        CHECK(pragma::get_journal_mode(db) == neo::sqlite3::journal_mode::memory);
+        CHECK(pragma::get_locking_mode(db) == neo::sqlite3::locking_mode::exclusive);
+        CHECK(pragma::get_synchronous(db) == neo::sqlite3::synchronous_mode::off);
+        pragma::set_mmap_size(db, 1024 * 1024);
+        CHECK(pragma::get_mmap_size(db) == 1024 * 1024);
+    }
+    {
+        // In-memory databases cannot use WAL mode
+        auto db = *neo::sqlite3::create_memory_db();
+        CHECK_THROWS_AS(neo::sqlite3::apply_profile(db, neo::sqlite3::pragma_profile::read_heavy()),
+                        neo::sqlite3::error);
+        CHECK(pragma::get_journal_mode(db) == neo::sqlite3::journal_mode::memory);
+    }
+    {
+        neo::sqlite3::pragma_profile bad{.page_size = 4096};
+        auto db = neo::sqlite3::open((path.parent_path() / "nonexistent" / "db.db").string(), bad);
+        CHECK(db.is_error());
+    }
+}
@@ -0,0 +1,343 @@
+#include "./range_table.hpp"
+
+#include <neo/sqlite3/error.hpp>
+#include <neo/sqlite3/identifier.hpp>
+
+#include <neo/ufmt.hpp>
+#include <sqlite3/sqlite3.h>
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+using namespace neo::sqlite3;
+
+namespace {
+
+template <typename T>
+int three_way(T left, T right) noexcept {
+    return left < right ? -1 : (right < left ? 1 : 0);
+}
+
+/// The relative ordering of SQLite storage classes: NULL < numbers < TEXT < BLOB
+int type_rank(value_type t) noexcept {
+    switch (t) {
+    case value_type::null:
+        return 0;
+    case value_type::integer:
+    case value_type::real:
+        return 1;
+    case value_type::text:
+        return 2;
+    case value_type::blob:
+        return 3;
+    }
+    return 3;
+}
+
+/// Bits of idxNum that encode the constraints passed to xFilter, in argv order
+enum constraint_bits : int {
+    key_eq = 1,
+    key_gt = 2,
+    key_ge = 4,
+    key_lt = 8,
+    key_le = 16,
+};
+
+struct range_vtab {
+    ::sqlite3_vtab            base;
+    detail::range_table_base* table;
+};
+
+struct range_cursor {
+    ::sqlite3_vtab_cursor base;
+    std::int64_t          pos = 0;
+    std::int64_t          end = 0;
+};
+
+detail::range_table_base& get_table(::sqlite3_vtab* vtab) noexcept {
+    return *reinterpret_cast<range_vtab*>(vtab)->table;
+}
+
+int range_connect(::sqlite3* db,
+                  void*      aux,
+                  int,
+                  const char* const*,
+                  ::sqlite3_vtab** out,
+                  char**           errmsg) noexcept {
+    auto& table = *static_cast<detail::range_table_base*>(aux);
+    try {
+        auto rc = ::sqlite3_declare_vtab(db, table.schema().data());
+        if (rc != SQLITE_OK) {
+            return rc;
+        }
+    } catch (const std::exception& e) {
+        *errmsg = ::sqlite3_mprintf("%s", e.what());
+        return SQLITE_ERROR;
+    }
+    auto vtab = static_cast<range_vtab*>(::sqlite3_malloc(sizeof(range_vtab)));
+    if (!vtab) {
+        return SQLITE_NOMEM;
+    }
+    std::memset(vtab, 0, sizeof *vtab);
+    vtab->table = &table;
+    *out        = &vtab->base;
+    return SQLITE_OK;
+}
+
+int range_disconnect(::sqlite3_vtab* vtab) noexcept {
+    ::sqlite3_free(vtab);
+    return SQLITE_OK;
+}
+
+bool is_binary_collation(::sqlite3_index_info* info, int idx) noexcept {
+#if SQLITE_VERSION_NUMBER >= 3022000
+    auto coll = ::sqlite3_vtab_collation(info, idx);
+    return coll == nullptr || ::sqlite3_stricmp(coll, "BINARY") == 0;
+#else
+    (void)info;
+    (void)idx;
+    return true;
+#endif
+}
+
+int range_best_index(::sqlite3_vtab* vtab, ::sqlite3_index_info* info) noexcept {
+    auto&      table = get_table(vtab);
+    const auto key   = table.key_column_index();
+    const auto n_rows = static_cast<double>(std::max(table.size(), std::int64_t(1)));
+
+    int eq_idx = -1, lower_idx = -1, upper_idx = -1;
+    int lower_bit = 0, upper_bit = 0;
+    for (auto i = 0; i < info->nConstraint; ++i) {
+        auto& cons = info->aConstraint[i];
+        if (key < 0 || !cons.usable || cons.iColumn != key || !is_binary_collation(info, i)) {
+            continue;
+        }
+        switch (cons.op) {
+        case SQLITE_INDEX_CONSTRAINT_EQ:
+            eq_idx = i;
+            break;
+        case SQLITE_INDEX_CONSTRAINT_GT:
+        case SQLITE_INDEX_CONSTRAINT_GE:
+            lower_idx = i;
+            lower_bit = cons.op == SQLITE_INDEX_CONSTRAINT_GT ? key_gt : key_ge;
+            break;
+        case SQLITE_INDEX_CONSTRAINT_LT:
+        case SQLITE_INDEX_CONSTRAINT_LE:
+            upper_idx = i;
+            upper_bit = cons.op == SQLITE_INDEX_CONSTRAINT_LT ? key_lt : key_le;
+            break;
+        default:
+            break;
+        }
+    }
+
+    // Binary searching costs ~log2(N) row visits, plus the rows that are emitted
+    const auto search_cost
+        = static_cast<double>(std::bit_width(static_cast<std::uint64_t>(n_rows)));
+    int argv_idx = 0;
+    if (eq_idx >= 0) {
+        info->idxNum                             = key_eq;
+        info->aConstraintUsage[eq_idx].argvIndex = ++argv_idx;
+        info->estimatedCost                      = search_cost + 1;
+        info->estimatedRows                      = 1;
+    } else if (lower_idx >= 0 || upper_idx >= 0) {
+        info->idxNum = lower_bit | upper_bit;
+        if (lower_idx >= 0) {
+            info->aConstraintUsage[lower_idx].argvIndex = ++argv_idx;
+        }
+        if (upper_idx >= 0) {
+            info->aConstraintUsage[upper_idx].argvIndex = ++argv_idx;
+        }
+        // Guess that each bound discards half of the table
+        const auto fraction = (lower_idx >= 0 && upper_idx >= 0) ? 0.25 : 0.5;
+        info->estimatedCost = search_cost + n_rows * fraction;
+        info->estimatedRows = static_cast<::sqlite3_int64>(n_rows * fraction);
+    } else {
+        info->idxNum        = 0;
+        info->estimatedCost = n_rows;
+        info->estimatedRows = static_cast<::sqlite3_int64>(n_rows);
+    }
+
+    // Rows are stored in key order, so an ascending ORDER BY the key is free
+    if (key >= 0 && info->nOrderBy == 1 && info->aOrderBy[0].iColumn == key
+        && !info->aOrderBy[0].desc) {
+        info->orderByConsumed = 1;
+    }
+    return SQLITE_OK;
+}
+
+int range_open(::sqlite3_vtab*, ::sqlite3_vtab_cursor** out) noexcept {
+    auto cur = new (std::nothrow) range_cursor{};
+    if (!cur) {
+        return SQLITE_NOMEM;
+    }
+    *out = &cur->base;
+    return SQLITE_OK;
+}
+
+int range_close(::sqlite3_vtab_cursor* cur) noexcept {
+    delete reinterpret_cast<range_cursor*>(cur);
+    return SQLITE_OK;
+}
+
+/// Apply the affinity of the key column to a constraint value, as SQLite would when comparing
+void apply_key_affinity(std::string_view key_type, ::sqlite3_value* value) noexcept {
+    if (key_type != "TEXT") {
+        // Convert numeric-looking text to a number, in-place.
+        ::sqlite3_value_numeric_type(value);
+    }
+}
+
+int range_filter(::sqlite3_vtab_cursor* cur_,
+                 int                    idx_num,
+                 const char*,
+                 int               argc,
+                 ::sqlite3_value** argv) noexcept {
+    auto& cur   = *reinterpret_cast<range_cursor*>(cur_);
+    auto& table = get_table(cur.base.pVtab);
+    cur.pos     = 0;
+    cur.end     = table.size();
+    for (auto i = 0; i < argc; ++i) {
+        if (::sqlite3_value_type(argv[i]) == SQLITE_NULL) {
+            // Comparisons with NULL never match
+            cur.end = 0;
+            return SQLITE_OK;
+        }
+        apply_key_affinity(table.key_type(), argv[i]);
+    }
+    auto arg = argv;
+    if (idx_num & key_eq) {
+        value_ref v{*arg++};
+        cur.pos = table.lower_bound(v);
+        cur.end = table.upper_bound(v);
+        return SQLITE_OK;
+    }
+    if (idx_num & (key_gt | key_ge)) {
+        value_ref v{*arg++};
+        cur.pos = (idx_num & key_gt) ? table.upper_bound(v) : table.lower_bound(v);
+    }
+    if (idx_num & (key_lt | key_le)) {
+        value_ref v{*arg++};
+        cur.end = (idx_num & key_lt) ? table.lower_bound(v) : table.upper_bound(v);
+    }
+    return SQLITE_OK;
+}
+
+int range_next(::sqlite3_vtab_cursor* cur) noexcept {
+    ++reinterpret_cast<range_cursor*>(cur)->pos;
+    return SQLITE_OK;
+}
+
+int range_eof(::sqlite3_vtab_cursor* cur_) noexcept {
+    auto& cur = *reinterpret_cast<range_cursor*>(cur_);
+    return cur.pos >= cur.end;
+}
+
+int range_column(::sqlite3_vtab_cursor* cur_, ::sqlite3_context* ctx, int col) noexcept {
+    auto& cur = *reinterpret_cast<range_cursor*>(cur_);
+    try {
+        get_table(cur.base.pVtab).column_value(ctx, cur.pos, col);
+    } catch (const std::exception& e) {
+        ::sqlite3_result_error(ctx, e.what(), -1);
+    } catch (...) {
+        ::sqlite3_result_error(
+            ctx, "[neo-sqlite3]: Non-std::exception type was thrown by a range table", -1);
+    }
+    return SQLITE_OK;
+}
+
+int range_rowid(::sqlite3_vtab_cursor* cur, ::sqlite3_int64* out) noexcept {
+    *out = reinterpret_cast<range_cursor*>(cur)->pos;
+    return SQLITE_OK;
+}
+
+void destroy_range_table(void* ptr) noexcept {
+    delete static_cast<detail::range_table_base*>(ptr);
+}
+
+// xCreate is null, which makes this an eponymous-only virtual table
+constexpr ::sqlite3_module range_module = {
+    .iVersion    = 0,
+    .xCreate     = nullptr,
+    .xConnect    = &range_connect,
+    .xBestIndex  = &range_best_index,
+    .xDisconnect = &range_disconnect,
+    .xDestroy    = &range_disconnect,
+    .xOpen       = &range_open,
+    .xClose      = &range_close,
+    .xFilter     = &range_filter,
+    .xNext       = &range_next,
+    .xEof        = &range_eof,
+    .xColumn     = &range_column,
+    .xRowid      = &range_rowid,
+};
+
+}  // namespace
+
+int detail::compare_key(std::int64_t key, value_ref value) noexcept {
+    switch (value.type()) {
+    case value_type::integer:
+        return three_way(key, value.as_integer());
+    case value_type::real:
+        return three_way(static_cast<double>(key), value.as_real());
+    default:
+        return three_way(1, type_rank(value.type()));
+    }
+}
+
+int detail::compare_key(double key, value_ref value) noexcept {
+    switch (value.type()) {
+    case value_type::integer:
+    case value_type::real:
+        return three_way(key, value.as_real());
+    default:
+        return three_way(1, type_rank(value.type()));
+    }
+}
+
+int detail::compare_key(std::string_view key, value_ref value) noexcept {
+    switch (value.type()) {
+    case value_type::text:
+    case value_type::integer:
+    case value_type::real:
+        // Numbers compared against a TEXT column take on TEXT affinity
+        return three_way(key.compare(value.as_text()), 0);
+    default:
+        return three_way(2, type_rank(value.type()));
+    }
+}
+
+std::string detail::range_table_base::schema() const {
+    std::string ret = "CREATE TABLE x(";
+    for (auto i = 0u; i < _column_names.size(); ++i) {
+        if (i != 0) {
+            ret += ", ";
+        }
+        ret += quote_identifier(_column_names[i]);
+        if (static_cast<int>(i) == _key_column) {
+            ret += ' ';
+            ret += _key_type;
+        }
+    }
+    ret += ")";
+    return ret;
+}
+
+void detail::register_range_table(::sqlite3*                        db,
+                                  neo::zstring_view                 name,
+                                  std::unique_ptr<range_table_base> table) {
+    auto rc = ::sqlite3_create_module_v2(db,
+                                         name.data(),
+                                         &range_module,
+                                         table.get(),
+                                         &destroy_range_table);
+    // sqlite3_create_module_v2 calls the destructor even if it fails
+    table.release();
+    auto ec = to_error_code(rc);
+    if (ec) {
+        throw_error(ec,
+                    ufmt("Error while creating range virtual table '{}'", name),
+                    connection_ref(db));
+    }
+}
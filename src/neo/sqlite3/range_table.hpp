@@ -0,0 +1,255 @@
+#pragma once
+
+#include <neo/sqlite3/connection.hpp>
+#include <neo/sqlite3/function.hpp>
+#include <neo/sqlite3/value_ref.hpp>
+
+#include <neo/fwd.hpp>
+
+#include <concepts>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <ranges>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+struct sqlite3_context;
+
+namespace neo::sqlite3 {
+
+/**
+ * @brief Declare a column of a range-backed virtual table.
+ *
+ * @tparam Proj A projection (member pointer or invocable) that obtains the column's value from an
+ * element of the range.
+ */
+template <typename Proj>
+struct table_column {
+    std::string_view name;
+    Proj             proj;
+};
+
+/**
+ * @brief Declare the key column of a range-backed virtual table.
+ *
+ * The range MUST be sorted in ascending order by the key column. Equality and range constraints
+ * on the key column will be resolved using a binary search, rather than a full scan.
+ */
+template <typename Proj>
+struct key_column {
+    std::string_view name;
+    Proj             proj;
+};
+
+template <typename Proj>
+table_column(std::string_view, Proj) -> table_column<Proj>;
+
+template <typename Proj>
+key_column(std::string_view, Proj) -> key_column<Proj>;
+
+namespace detail {
+
+/// Compare a key against a SQLite value, using SQLite's ordering rules for mixed types
+[[nodiscard]] int compare_key(std::int64_t key, value_ref value) noexcept;
+[[nodiscard]] int compare_key(double key, value_ref value) noexcept;
+[[nodiscard]] int compare_key(std::string_view key, value_ref value) noexcept;
+
+template <typename T>
+constexpr bool is_key_column_v = false;
+
+template <typename Proj>
+constexpr bool is_key_column_v<key_column<Proj>> = true;
+
+class range_table_base {
+    std::vector<std::string> _column_names;
+    int                      _key_column = -1;
+    std::string_view         _key_type;
+
+protected:
+    range_table_base(std::vector<std::string> names, int key_column, std::string_view key_type)
+        : _column_names(std::move(names))
+        , _key_column(key_column)
+        , _key_type(key_type) {}
+
+public:
+    virtual ~range_table_base() = default;
+
+    /// Generate the CREATE TABLE statement used to declare the virtual table
+    [[nodiscard]] std::string schema() const;
+    /// The declared type of the key column
+    [[nodiscard]] std::string_view key_type() const noexcept { return _key_type; }
+    /// The index of the key column, or -1 if there is no key column
+    [[nodiscard]] int key_column_index() const noexcept { return _key_column; }
+
+    [[nodiscard]] virtual std::int64_t size() noexcept = 0;
+    /// Find the first row whose key is not less than the given value
+    [[nodiscard]] virtual std::int64_t lower_bound(value_ref) noexcept = 0;
+    /// Find the first row whose key is greater than the given value
+    [[nodiscard]] virtual std::int64_t upper_bound(value_ref) noexcept = 0;
+    /// Set the result of the given context to the value of a cell in the table
+    virtual void column_value(sqlite3_context* ctx, std::int64_t row, int col) = 0;
+};
+
+/// Obtain the declared type (and thus the affinity) of a key column of type T
+template <typename T>
+constexpr std::string_view key_decl_type() noexcept {
+    if constexpr (std::integral<T>) {
+        return "INTEGER";
+    } else if constexpr (std::floating_point<T>) {
+        return "REAL";
+    } else {
+        return "TEXT";
+    }
+}
+
+template <typename T>
+decltype(auto) as_comparable_key(const T& key) noexcept {
+    if constexpr (std::integral<T>) {
+        return static_cast<std::int64_t>(key);
+    } else if constexpr (std::floating_point<T>) {
+        return static_cast<double>(key);
+    } else {
+        static_assert(std::convertible_to<const T&, std::string_view>,
+                      "Key columns must be integral, floating point, or string types");
+        return std::string_view(key);
+    }
+}
+
+template <typename Range, typename... Columns>
+class range_table final : public range_table_base {
+    Range                  _range;
+    std::tuple<Columns...> _columns;
+
+    static constexpr int _key_index() noexcept {
+        constexpr bool is_key[] = {is_key_column_v<Columns>...};
+        for (auto i = 0u; i < sizeof...(Columns); ++i) {
+            if (is_key[i]) {
+                return static_cast<int>(i);
+            }
+        }
+        return -1;
+    }
+
+    static constexpr int key_index = _key_index();
+
+    static constexpr std::string_view _key_type() noexcept {
+        if constexpr (key_index < 0) {
+            return "";
+        } else {
+            using key_col  = std::tuple_element_t<key_index, std::tuple<Columns...>>;
+            using elem_ref = std::ranges::range_reference_t<Range>;
+            using key_type = std::invoke_result_t<decltype(key_col::proj), elem_ref>;
+            return key_decl_type<std::remove_cvref_t<key_type>>();
+        }
+    }
+
+    decltype(auto) _row(std::int64_t idx) {
+        return std::ranges::begin(_range)[static_cast<std::ranges::range_difference_t<Range>>(idx)];
+    }
+
+    int _compare_row(std::int64_t idx, value_ref value) {
+        if constexpr (key_index < 0) {
+            return 0;
+        } else {
+            auto&& col = std::get<key_index>(_columns);
+            return compare_key(as_comparable_key(std::invoke(col.proj, _row(idx))), value);
+        }
+    }
+
+    template <typename Pred>
+    std::int64_t _partition_point(Pred&& pred) {
+        std::int64_t low  = 0;
+        std::int64_t high = size();
+        while (low < high) {
+            auto mid = low + (high - low) / 2;
+            if (pred(mid)) {
+                low = mid + 1;
+            } else {
+                high = mid;
+            }
+        }
+        return low;
+    }
+
+    template <std::size_t... Is>
+    void
+    _column_value(sqlite3_context* ctx, std::int64_t row, int col, std::index_sequence<Is...>) {
+        auto&& elem = _row(row);
+        static_cast<void>(((static_cast<int>(Is) == col
+                            && (assign_result(ctx, std::invoke(std::get<Is>(_columns).proj, elem)),
+                                true))
+                           || ...));
+    }
+
+public:
+    template <typename R>
+    range_table(R&& range, Columns... cols)
+        : range_table_base({std::string(cols.name)...}, key_index, _key_type())
+        , _range(std::views::all(NEO_FWD(range)))
+        , _columns(std::move(cols)...) {}
+
+    std::int64_t size() noexcept override {
+        return static_cast<std::int64_t>(std::ranges::size(_range));
+    }
+
+    std::int64_t lower_bound(value_ref value) noexcept override {
+        return _partition_point([&](std::int64_t idx) { return _compare_row(idx, value) < 0; });
+    }
+
+    std::int64_t upper_bound(value_ref value) noexcept override {
+        return _partition_point([&](std::int64_t idx) { return _compare_row(idx, value) <= 0; });
+    }
+
+    void column_value(sqlite3_context* ctx, std::int64_t row, int col) override {
+        _column_value(ctx, row, col, std::index_sequence_for<Columns...>{});
+    }
+};
+
+void register_range_table(::sqlite3*                        db,
+                          neo::zstring_view                 name,
+                          std::unique_ptr<range_table_base> table);
+
+}  // namespace detail
+
+/**
+ * @brief Expose a random-access range as an eponymous virtual table.
+ *
+ * The virtual table is named `name`, and has one column for each of the given `columns` (created
+ * with `table_column` or `key_column`). The ROWID of each row is its index in the range.
+ *
+ * If an lvalue range is given, the range is referred-to, not copied, and MUST outlive the
+ * connection. If an rvalue range is given, it will be moved into the virtual table.
+ *
+ * Example:
+ *
+ *      db.register_range_table("points",
+ *                              points,
+ *                              key_column{"id", &point::id},
+ *                              table_column{"x", &point::x},
+ *                              table_column{"y", &point::y});
+ *      // Will perform a binary search on 'points' rather than a full scan:
+ *      db.prepare("SELECT x, y FROM points WHERE id = ?");
+ */
+template <typename Range, typename... Columns>
+void connection_ref::register_range_table(neo::zstring_view name,
+                                          Range&&           range,
+                                          Columns... columns) {
+    using view_type = std::views::all_t<Range>;
+    static_assert(std::ranges::random_access_range<view_type>
+                      && std::ranges::sized_range<view_type>,
+                  "Range tables must be backed by a sized random-access range");
+    static_assert(sizeof...(Columns) > 0, "Range tables must have at least one column");
+    static_assert((static_cast<int>(detail::is_key_column_v<Columns>) + ... + 0) <= 1,
+                  "At most one key_column may be given for a range table");
+    auto table
+        = std::make_unique<detail::range_table<view_type, Columns...>>(NEO_FWD(range),
+                                                                        std::move(columns)...);
+    detail::register_range_table(_ptr, name, std::move(table));
+}
+
+}  // namespace neo::sqlite3
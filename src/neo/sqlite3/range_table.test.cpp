@@ -0,0 +1,87 @@
+#include <neo/sqlite3/range_table.hpp>
+
+#include <neo/sqlite3/exec.hpp>
+#include <neo/sqlite3/statement.hpp>
+
+#include "./tests.inl"
+
+#include <string>
+#include <vector>
+
+namespace {
+
+struct person {
+    int         id;
+    std::string name;
+    double      score;
+};
+
+}  // namespace
+
+TEST_CASE_METHOD(sqlite3_memory_db_fixture, "Query a vector as a virtual table") {
+    std::vector<person> people = {
+        {1, "Joe", 4.5},
+        {3, "Amy", 9.1},
+        {4, "George", 1.2},
+        {8, "Sue", 7.7},
+    };
+    db.register_range_table("people",
+                            people,
+                            neo::sqlite3::key_column{"id", &person::id},
+                            neo::sqlite3::table_column{"name", &person::name},
+                            neo::sqlite3::table_column{"score", &person::score});
+
+    auto st = *db.prepare("SELECT count(*), sum(score) FROM people");
+    auto [count, sum] = *neo::sqlite3::next<int, double>(st);
+    CHECK(count == 4);
+    CHECK(sum == Approx(4.5 + 9.1 + 1.2 + 7.7));
+
+    SECTION("Equality on the key column") {
+        st = *db.prepare("SELECT name FROM people WHERE id = ?");
+        CHECK(*neo::sqlite3::one_cell<std::string>(st, 4) == "George");
+        CHECK(*neo::sqlite3::one_cell<std::string>(st, "3") == "Amy");
+        CHECK(neo::sqlite3::one_cell<std::string>(st, 2) == neo::sqlite3::errc::done);
+    }
+
+    SECTION("Constraints on the key column are given to the virtual table") {
+        st = *db.prepare("EXPLAIN QUERY PLAN SELECT name FROM people WHERE id = ?");
+        REQUIRE(st.step() == neo::sqlite3::errc::row);
+        CHECK(st.row()[3].as_text().find("INDEX 1:") != std::string_view::npos);
+    }
+
+    SECTION("Range constraints on the key column") {
+        st = *db.prepare("SELECT group_concat(name) FROM people WHERE id > ? AND id <= ?");
+        CHECK(*neo::sqlite3::one_cell<std::string>(st, 1, 4) == "Amy,George");
+        CHECK(*neo::sqlite3::one_cell<std::string>(st, 3.5, 100) == "George,Sue");
+    }
+
+    SECTION("Join against a regular table") {
+        db.exec(R"(
+            CREATE TABLE visits (person_id, n);
+            INSERT INTO visits VALUES (8, 2), (1, 5), (9, 1);
+        )")
+            .throw_if_error();
+        // The order of group_concat() follows the rows of the subquery, not the join plan
+        st = *db.prepare(R"(
+            SELECT group_concat(visit) FROM (
+                SELECT name || '=' || n AS visit
+                  FROM visits JOIN people ON people.id = visits.person_id
+                 ORDER BY person_id
+            )
+        )");
+        CHECK(*neo::sqlite3::one_cell<std::string>(st) == "Joe=5,Sue=2");
+    }
+
+    // Changes to the underlying range are visible in subsequent queries
+    people.push_back({10, "Ann", 3.0});
+    st = *db.prepare("SELECT name FROM people WHERE id >= 9");
+    CHECK(*neo::sqlite3::one_cell<std::string>(st) == "Ann");
+}
+
+TEST_CASE_METHOD(sqlite3_memory_db_fixture, "Range table without a key column") {
+    db.register_range_table("squares",
+                            std::vector<int>{1, 4, 9, 16},
+                            neo::sqlite3::table_column{"n", [](int n) { return n; }});
+    auto st = *db.prepare("SELECT sum(n) FROM squares WHERE n > 2");
+    CHECK(*neo::sqlite3::one_cell<int>(st) == 29);
+}
@@ -0,0 +1,191 @@
+#include "./readahead_vfs.hpp"
+
+#include <sqlite3/sqlite3.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+
+#if !defined(_WIN32) && !defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#define NEO_SQLITE3_HAVE_FADVISE 1
+#else
+#define NEO_SQLITE3_HAVE_FADVISE 0
+#endif
+
+using namespace neo::sqlite3;
+
+namespace {
+
+/// The settings of a connection, which are shared by its database file and its WAL
+struct readahead_settings {
+    bool readahead;
+    bool drop_wal;
+};
+
+/// The read-ahead state of a database or WAL file
+struct readahead_state : vfs_shim::file_state {
+    int                                 fd;
+    std::shared_ptr<readahead_settings> settings;
+
+    /// The offset that follows the most recent read
+    std::int64_t next_offset = -1;
+    /// The number of consecutive sequential reads
+    int n_sequential = 0;
+    /// The end of the extent that has been advised to be read ahead
+    std::int64_t advised_end = 0;
+    /// The size of the next extent to be advised
+    std::int64_t window;
+
+    readahead_state(int fd, std::shared_ptr<readahead_settings> settings, std::int64_t window)
+        : fd(fd)
+        , settings(std::move(settings))
+        , window(window) {}
+
+    static readahead_state* of(vfs_shim::file& f) noexcept {
+        return static_cast<readahead_state*>(f.state());
+    }
+};
+
+/// Update a setting from a file-control argument. See readahead_vfs::fcntl_readahead
+void update_setting(bool& setting, void* arg) noexcept {
+    auto& value = *static_cast<int*>(arg);
+    if (value >= 0) {
+        setting = value != 0;
+    }
+    value = setting ? 1 : 0;
+}
+
+errable<void>
+set_setting(connection_ref db, int op, bool enable, neo::zstring_view schema) noexcept {
+    int  value = enable ? 1 : 0;
+    auto rc    = errc{::sqlite3_file_control(db.c_ptr(), schema.data(), op, &value)};
+    if (rc == errc::not_found) {
+        return {rc, "The database does not use a readahead_vfs", db};
+    } else if (rc != errc::ok) {
+        return {rc, "Failed to change a setting of a readahead_vfs", db};
+    }
+    return errc::ok;
+}
+
+}  // namespace
+
+readahead_vfs::readahead_vfs(readahead_vfs_options opts)
+    : vfs_shim(opts.name, opts.base)
+    , _opts(std::move(opts)) {
+    _opts.initial_window = (std::max)(_opts.initial_window, std::int64_t(4096));
+    _opts.max_window     = (std::max)(_opts.max_window, _opts.initial_window);
+}
+
+readahead_vfs_stats readahead_vfs::stats() const noexcept {
+    readahead_vfs_stats ret;
+    ret.n_readaheads  = _n_readaheads.load(std::memory_order_relaxed);
+    ret.bytes_advised = _bytes_advised.load(std::memory_order_relaxed);
+    ret.n_wal_drops   = _n_wal_drops.load(std::memory_order_relaxed);
+    return ret;
+}
+
+int readahead_vfs::on_open(file& f) noexcept {
+    if (!NEO_SQLITE3_HAVE_FADVISE
+        || (f.kind() != file_kind::main_db && f.kind() != file_kind::wal)) {
+        return SQLITE_OK;
+    }
+    auto fd = f.posix_fd();
+    if (fd < 0) {
+        return SQLITE_OK;
+    }
+    try {
+        // The WAL follows the settings of the database file of its connection, since the
+        // settings are changed with file-controls on the database file
+        std::shared_ptr<readahead_settings> settings;
+        auto                                db = f.database_file();
+        if (auto db_st = db ? readahead_state::of(*db) : nullptr) {
+            settings = db_st->settings;
+        } else {
+            settings = std::make_shared<readahead_settings>(
+                readahead_settings{_opts.readahead, _opts.drop_wal_after_checkpoint});
+        }
+        f.set_state(std::make_unique<readahead_state>(fd, std::move(settings),
+                                                      _opts.initial_window));
+    } catch (const std::bad_alloc&) {
+        // Read without hints instead
+    }
+    return SQLITE_OK;
+}
+
+int readahead_vfs::read(file& f, void* buf, int amount, std::int64_t offset) noexcept {
+    auto st = readahead_state::of(f);
+    if (!st || !st->settings->readahead) {
+        return f.read(buf, amount, offset);
+    }
+    const bool sequential = st->next_offset >= 0 && offset >= st->next_offset
+        && offset - st->next_offset <= _opts.max_gap;
+    if (sequential) {
+        ++st->n_sequential;
+    } else {
+        st->n_sequential = 0;
+        st->advised_end  = 0;
+        st->window       = _opts.initial_window;
+    }
+    const auto end  = offset + amount;
+    st->next_offset = end;
+    // Advise the next extent before reading, so that the OS reads it while SQLite processes this
+    // page. Stay at least half a window ahead of the reader.
+    if (st->n_sequential >= _opts.trigger && end + st->window / 2 > st->advised_end) {
+        const auto start = (std::max)(st->advised_end, end);
+#if NEO_SQLITE3_HAVE_FADVISE
+        ::posix_fadvise(st->fd, start, st->window, POSIX_FADV_WILLNEED);
+#endif
+        _n_readaheads.fetch_add(1, std::memory_order_relaxed);
+        _bytes_advised.fetch_add(static_cast<std::uint64_t>(st->window),
+                                 std::memory_order_relaxed);
+        st->advised_end = start + st->window;
+        st->window      = (std::min)(st->window * 2, _opts.max_window);
+    }
+    return f.read(buf, amount, offset);
+}
+
+int readahead_vfs::file_control(file& f, int op, void* arg) noexcept {
+    auto st = readahead_state::of(f);
+    if (!st) {
+        return f.file_control(op, arg);
+    }
+    if (op == fcntl_readahead) {
+        update_setting(st->settings->readahead, arg);
+        return SQLITE_OK;
+    } else if (op == fcntl_drop_wal_after_checkpoint) {
+        update_setting(st->settings->drop_wal, arg);
+        return SQLITE_OK;
+    }
+    auto rc = f.file_control(op, arg);
+    if (op == SQLITE_FCNTL_CKPT_DONE && st->settings->drop_wal && f.path()) {
+        // Every frame of the WAL has been copied into the database. SQLite holds no POSIX locks
+        // on the WAL file, so it is safe to open and close another descriptor of it.
+#if NEO_SQLITE3_HAVE_FADVISE
+        try {
+            auto wal_path = std::string(f.path()) + "-wal";
+            auto fd       = ::open(wal_path.data(), O_RDONLY | O_CLOEXEC);
+            if (fd >= 0) {
+                ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+                ::close(fd);
+                _n_wal_drops.fetch_add(1, std::memory_order_relaxed);
+            }
+        } catch (const std::bad_alloc&) {
+            // Skip the hint
+        }
+#endif
+    }
+    return rc;
+}
+
+errable<void>
+readahead_vfs::set_readahead(connection_ref db, bool enable, neo::zstring_view schema) noexcept {
+    return set_setting(db, fcntl_readahead, enable, schema);
+}
+
+errable<void> readahead_vfs::set_drop_wal_after_checkpoint(connection_ref    db,
+                                                           bool              enable,
+                                                           neo::zstring_view schema) noexcept {
+    return set_setting(db, fcntl_drop_wal_after_checkpoint, enable, schema);
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <neo/sqlite3/connection_ref.hpp>
+#include <neo/sqlite3/errable.hpp>
+#include <neo/sqlite3/vfs.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace neo::sqlite3 {
+
+/**
+ * @brief Options for a readahead_vfs
+ */
+struct readahead_vfs_options {
+    /// The name with which to register the VFS
+    std::string name = "neo-readahead";
+    /// The name of the VFS to wrap. If empty, wraps the default VFS
+    std::string base;
+    /// The number of consecutive sequential reads of a file that start read-ahead
+    int trigger = 4;
+    /**
+     * @brief The largest forward gap between two reads, in bytes, for which they are still
+     * considered sequential. A table scan skips the interior pages of the b-tree.
+     */
+    std::int64_t max_gap = 64 * 1024;
+    /// The size of the first extent that is read ahead. Each further extent is twice as large
+    std::int64_t initial_window = 128 * 1024;
+    /// The size of the largest extent that is read ahead
+    std::int64_t max_window = 4 * 1024 * 1024;
+    /// Whether new connections read ahead. See readahead_vfs::set_readahead()
+    bool readahead = true;
+    /**
+     * @brief Whether new connections drop the pages of the WAL from the OS cache after each
+     * checkpoint. See readahead_vfs::set_drop_wal_after_checkpoint()
+     */
+    bool drop_wal_after_checkpoint = true;
+};
+
+/**
+ * @brief Counters of the hints given by a readahead_vfs
+ */
+struct readahead_vfs_stats {
+    /// The number of extents that were advised to be read ahead
+    std::uint64_t n_readaheads = 0;
+    /// The total size of those extents
+    std::uint64_t bytes_advised = 0;
+    /// The number of times that the pages of a WAL were dropped from the OS cache
+    std::uint64_t n_wal_drops = 0;
+};
+
+/**
+ * @brief A VFS that detects sequential reads of database and WAL files, and advises the OS to read
+ * the following extents of the file ahead of the reader (with `posix_fadvise(WILLNEED)`).
+ *
+ * The read-ahead window starts at `initial_window` bytes, and doubles with each extent while the
+ * reads remain sequential, up to `max_window`. It also drops the pages of the WAL from the OS
+ * cache (with `posix_fadvise(DONTNEED)`) once a checkpoint has copied them into the database,
+ * since they will not be read again.
+ *
+ * Both behaviors can be toggled for each connection with set_readahead() and
+ * set_drop_wal_after_checkpoint(). The hints are advisory, and are silently skipped on platforms
+ * without `posix_fadvise()`. The VFS uses a second descriptor of each file (see
+ * vfs_shim::file::posix_fd()), which stays open for as long as the file exists.
+ */
+class readahead_vfs : public vfs_shim {
+    readahead_vfs_options _opts;
+
+    std::atomic<std::uint64_t> _n_readaheads{0};
+    std::atomic<std::uint64_t> _bytes_advised{0};
+    std::atomic<std::uint64_t> _n_wal_drops{0};
+
+protected:
+    int on_open(file& f) noexcept override;
+    int read(file& f, void* buf, int amount, std::int64_t offset) noexcept override;
+    int file_control(file& f, int op, void* arg) noexcept override;
+
+public:
+    /**
+     * @brief File-control opcodes understood by the main database file of a connection that uses
+     * a readahead_vfs (see `sqlite3_file_control()`). The argument is an `int*`: 1 to enable, 0
+     * to disable, or -1 to query. The resulting setting is written back to the argument.
+     */
+    constexpr static int fcntl_readahead                 = 0x4e454f01;
+    constexpr static int fcntl_drop_wal_after_checkpoint = 0x4e454f02;
+
+    explicit readahead_vfs(readahead_vfs_options opts = {});
+
+    [[nodiscard]] const readahead_vfs_options& options() const noexcept { return _opts; }
+
+    [[nodiscard]] readahead_vfs_stats stats() const noexcept;
+
+    /**
+     * @brief Enable or disable read-ahead for the given schema of a connection, in both its
+     * database file and its WAL. Returns an error if the schema does not use a readahead_vfs.
+     */
+    static errable<void>
+    set_readahead(connection_ref db, bool enable, neo::zstring_view schema = "main") noexcept;
+    /**
+     * @brief Enable or disable dropping the WAL of the given schema of a connection from the OS
+     * cache after each checkpoint. Returns an error if the schema does not use a readahead_vfs.
+     */
+    static errable<void> set_drop_wal_after_checkpoint(connection_ref    db,
+                                                       bool              enable,
+                                                       neo::zstring_view schema = "main") noexcept;
+};
+
+}  // namespace neo::sqlite3
@@ -0,0 +1,105 @@
+#include <neo/sqlite3/exec.hpp>
+#include <neo/sqlite3/open_options.hpp>
+#include <neo/sqlite3/readahead_vfs.hpp>
+
+#include "./tests.inl"
+
+#include <chrono>
+#include <filesystem>
+
+#if !defined(_WIN32) && !defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+TEST_CASE_METHOD(sqlite3_temp_db_fixture, "Read ahead of a sequential scan") {
+    neo::sqlite3::readahead_vfs vfs{{.name = "neo-readahead-test"}};
+    {
+        auto db = *neo::sqlite3::connection::open(path.string(),
+                                                  neo::sqlite3::open_options{.vfs = vfs.name()});
+        db.exec(R"(
+            PRAGMA journal_mode = WAL;
+            CREATE TABLE foo (a INTEGER PRIMARY KEY, b BLOB);
+            WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < 2000)
+            INSERT INTO foo (b) SELECT randomblob(1000) FROM n;
+        )")
+            .throw_if_error();
+        db.exec("PRAGMA wal_checkpoint(TRUNCATE)").throw_if_error();
+#if !defined(_WIN32) && !defined(__APPLE__)
+        CHECK(vfs.stats().n_wal_drops > 0);
+#endif
+    }
+
+    auto db = *neo::sqlite3::connection::open(path.string(),
+                                              neo::sqlite3::open_options{.vfs = vfs.name()});
+    auto before = vfs.stats();
+    auto total  = *neo::sqlite3::one_cell<std::int64_t>(
+        *db.prepare("SELECT sum(length(b)) FROM foo"));
+    CHECK(total == 2000 * 1000);
+#if !defined(_WIN32) && !defined(__APPLE__)
+    CHECK(vfs.stats().n_readaheads > before.n_readaheads);
+    CHECK(vfs.stats().bytes_advised > before.bytes_advised);
+#endif
+
+    // Read-ahead can be disabled for each connection
+    neo::sqlite3::readahead_vfs::set_readahead(db, false).throw_if_error();
+    db.exec("PRAGMA cache_size = 0").throw_if_error();
+    before = vfs.stats();
+    total  = *neo::sqlite3::one_cell<std::int64_t>(*db.prepare("SELECT sum(length(b)) FROM foo"));
+    CHECK(total == 2000 * 1000);
+    CHECK(vfs.stats().n_readaheads == before.n_readaheads);
+
+    // The setting also applies to the WAL of the connection
+    db.exec(R"(
+        PRAGMA wal_autocheckpoint = 0;
+        UPDATE foo SET b = randomblob(1000);
+    )")
+        .throw_if_error();
+    before = vfs.stats();
+    total  = *neo::sqlite3::one_cell<std::int64_t>(*db.prepare("SELECT sum(length(b)) FROM foo"));
+    CHECK(total == 2000 * 1000);
+    CHECK(vfs.stats().n_readaheads == before.n_readaheads);
+
+    // Connections that do not use the VFS cannot change its settings
+    auto other = *neo::sqlite3::open(path.string());
+    CHECK(neo::sqlite3::readahead_vfs::set_readahead(other, true).errc()
+          == neo::sqlite3::errc::not_found);
+}
+
+#if !defined(_WIN32) && !defined(__APPLE__)
+TEST_CASE_METHOD(sqlite3_temp_db_fixture, "Benchmark a cold-cache scan", "[.benchmark]") {
+    neo::sqlite3::readahead_vfs vfs{{.name = "neo-readahead-bench"}};
+    {
+        auto db = *neo::sqlite3::open(path.string());
+        db.exec(R"(
+            CREATE TABLE foo (a INTEGER PRIMARY KEY, b BLOB);
+            WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < 500000)
+            INSERT INTO foo (b) SELECT randomblob(1000) FROM n;
+        )")
+            .throw_if_error();
+    }
+
+    for (auto readahead : {false, true, false, true}) {
+        // Drop the database from the OS cache. No connection is open, so this cannot release
+        // any POSIX locks.
+        auto fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        REQUIRE(fd >= 0);
+        ::fdatasync(fd);
+        ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        ::close(fd);
+
+        auto db = *neo::sqlite3::connection::open(path.string(),
+                                                  neo::sqlite3::open_options{.vfs = vfs.name()});
+        neo::sqlite3::readahead_vfs::set_readahead(db, readahead).throw_if_error();
+        auto start = std::chrono::steady_clock::now();
+        auto total = *neo::sqlite3::one_cell<std::int64_t>(
+            *db.prepare("SELECT sum(length(b)) FROM foo"));
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        CHECK(total == 500000 * 1000);
+        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count();
+        WARN("Cold scan of " << std::filesystem::file_size(path) / (1024 * 1024) << " MiB "
+                             << (readahead ? "with" : "without") << " read-ahead: " << ms
+                             << "ms");
+    }
+}
+#endif
@@ -0,0 +1,50 @@
+#include "./run_transaction.hpp"
+
+#include <neo/event.hpp>
+
+#include <algorithm>
+#include <random>
+#include <thread>
+
+using namespace neo::sqlite3;
+
+namespace {
+
+std::chrono::nanoseconds jittered(std::chrono::nanoseconds backoff) {
+    thread_local std::minstd_rand rng{std::random_device{}()};
+    // "Equal jitter": Wait at least half of the backoff, so that waits still grow exponentially
+    std::uniform_int_distribution<std::int64_t> dist{backoff.count() / 2, backoff.count()};
+    return std::chrono::nanoseconds{dist(rng)};
+}
+
+}  // namespace
+
+detail::transaction_retrier::transaction_retrier(connection_ref      db,
+                                                 const retry_policy& policy) noexcept
+    : _db(db)
+    , _policy(policy)
+    , _deadline(clock::now() + policy.deadline)
+    , _backoff(policy.initial_backoff) {}
+
+bool detail::transaction_retrier::backoff(const error& e) {
+    const auto now = clock::now();
+    if (now >= _deadline) {
+        return false;
+    }
+    // Shorten the last wait to end at the deadline, so that a final attempt is made there
+    auto delay = std::min(jittered(_backoff),
+                          std::chrono::duration_cast<std::chrono::nanoseconds>(_deadline - now));
+    neo::emit(event::transaction_retry{_db, _attempt, errc{e.code().value()}, delay});
+    std::this_thread::sleep_for(delay);
+    _time_waiting += delay;
+    ++_attempt;
+    auto next = std::chrono::duration_cast<std::chrono::nanoseconds>(_backoff * _policy.multiplier);
+    _backoff  = std::min(next, std::chrono::nanoseconds{_policy.max_backoff});
+    return true;
+}
+
+void detail::transaction_retrier::finish(bool committed) noexcept {
+    if (_attempt > 1) {
+        neo::emit(event::transaction_retry_finish{_db, _attempt, _time_waiting, committed});
+    }
+}
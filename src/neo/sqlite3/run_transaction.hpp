@@ -0,0 +1,134 @@
+#pragma once
+
+#include <neo/sqlite3/connection_ref.hpp>
+#include <neo/sqlite3/error.hpp>
+#include <neo/sqlite3/transaction.hpp>
+
+#include <chrono>
+#include <functional>
+#include <type_traits>
+
+namespace neo::sqlite3 {
+
+/**
+ * @brief Controls how run_transaction() retries a transaction that fails due to lock contention.
+ *
+ * After each failed attempt, run_transaction() sleeps for a random duration between half of and
+ * the full "backoff" duration. The backoff begins at `initial_backoff`, and is multiplied by
+ * `multiplier` after each attempt, up to `max_backoff`. The wait that would pass `deadline` is
+ * shortened to end at the deadline, where a final attempt is made.
+ */
+struct retry_policy {
+    std::chrono::microseconds initial_backoff{500};
+    std::chrono::microseconds max_backoff{std::chrono::milliseconds{100}};
+    std::chrono::milliseconds deadline{5000};
+    double                    multiplier = 2.0;
+};
+
+namespace event {
+
+/**
+ * @brief Fired when run_transaction() will retry a transaction that failed due to contention.
+ */
+struct transaction_retry {
+    connection_ref&          db;
+    /// The number of the attempt that failed, starting at one
+    int                      attempt;
+    errc                     ec;
+    /// The time that will be spent sleeping before the next attempt
+    std::chrono::nanoseconds delay;
+};
+
+/**
+ * @brief Fired when run_transaction() completes (successfully or not) after at least one retry.
+ */
+struct transaction_retry_finish {
+    connection_ref& db;
+    /// The total number of attempts that were made
+    int attempts;
+    /// The total time spent backing-off between attempts
+    std::chrono::nanoseconds time_waiting;
+    /// Whether the transaction was eventually committed
+    bool committed;
+};
+
+}  // namespace event
+
+namespace detail {
+
+/**
+ * @brief Implements the backoff and bookkeeping of run_transaction()
+ */
+class transaction_retrier {
+    using clock = std::chrono::steady_clock;
+
+    connection_ref           _db;
+    retry_policy             _policy;
+    clock::time_point        _deadline;
+    std::chrono::nanoseconds _backoff;
+    std::chrono::nanoseconds _time_waiting{0};
+    int                      _attempt = 1;
+
+public:
+    transaction_retrier(connection_ref db, const retry_policy& policy) noexcept;
+
+    /**
+     * @brief Handle a busy error on the current attempt. If another attempt should be made, sleeps
+     * for the backoff period and returns 'true'. Otherwise returns 'false' and the caller should
+     * re-throw the error.
+     */
+    [[nodiscard]] bool backoff(const error& e);
+
+    /// Record the completion of the transaction
+    void finish(bool committed) noexcept;
+};
+
+}  // namespace detail
+
+/**
+ * @brief Run `fn` within a transaction, retrying the transaction if it fails due to lock
+ * contention.
+ *
+ * A transaction_guard with the given mode is opened, then `fn` is invoked, then the transaction is
+ * committed. If any step throws a `busy_error` (including `errc::busy_snapshot`), the transaction
+ * is rolled back and the whole process is repeated after a randomized exponential backoff, until
+ * the deadline of the retry_policy is reached. Other exceptions are not retried.
+ *
+ * Because `fn` may be invoked more than once, it must not have side effects outside of the
+ * database that cannot be safely repeated. There must be no transaction active on the connection.
+ *
+ * @return The value returned by `fn`.
+ */
+template <typename Func>
+decltype(auto) run_transaction(connection_ref      db,
+                               transaction_mode    mode,
+                               Func&&              fn,
+                               const retry_policy& policy = {}) {
+    detail::transaction_retrier retrier{db, policy};
+    while (true) {
+        try {
+            transaction_guard tr{db, mode};
+            if constexpr (std::is_void_v<std::invoke_result_t<Func&>>) {
+                std::invoke(fn);
+                tr.commit();
+                retrier.finish(true);
+                return;
+            } else {
+                std::invoke_result_t<Func&> result = std::invoke(fn);
+                tr.commit();
+                retrier.finish(true);
+                return result;
+            }
+        } catch (const busy_error& e) {
+            if (!retrier.backoff(e)) {
+                retrier.finish(false);
+                throw;
+            }
+        } catch (...) {
+            retrier.finish(false);
+            throw;
+        }
+    }
+}
+
+}  // namespace neo::sqlite3
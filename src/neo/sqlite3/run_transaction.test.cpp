@@ -0,0 +1,72 @@
+#include <neo/sqlite3/exec.hpp>
+#include <neo/sqlite3/run_transaction.hpp>
+
+#include "./tests.inl"
+
+#include <thread>
+
+using namespace std::chrono_literals;
+
+TEST_CASE_METHOD(sqlite3_memory_db_fixture, "Run a simple transaction") {
+    db.exec("CREATE TABLE foo (bar INTEGER)").throw_if_error();
+    auto n = neo::sqlite3::run_transaction(db, neo::sqlite3::transaction_mode::immediate, [&] {
+        db.exec("INSERT INTO foo VALUES (1), (2)").throw_if_error();
+        return db.changes();
+    });
+    CHECK(n == 2);
+    CHECK_FALSE(db.is_transaction_active());
+    CHECK(*neo::sqlite3::one_cell<int>(*db.prepare("SELECT count(*) FROM foo")) == 2);
+}
+
+TEST_CASE_METHOD(sqlite3_memory_db_fixture, "Non-busy errors are not retried") {
+    int n_calls = 0;
+    CHECK_THROWS_AS(neo::sqlite3::run_transaction(db,
+                                                  neo::sqlite3::transaction_mode::deferred,
+                                                  [&] {
+                                                      ++n_calls;
+                                                      db.exec("INSERT INTO nonesuch VALUES (1)")
+                                                          .throw_if_error();
+                                                  }),
+                    neo::sqlite3::error);
+    CHECK(n_calls == 1);
+    CHECK_FALSE(db.is_transaction_active());
+}
+
+TEST_CASE_METHOD(sqlite3_temp_db_fixture, "Busy transactions are retried") {
+    auto db1 = *neo::sqlite3::open(path.string());
+    auto db2 = *neo::sqlite3::open(path.string());
+    db1.exec("CREATE TABLE foo (bar INTEGER)").throw_if_error();
+
+    SECTION("Until the lock is released") {
+        auto tr = std::make_unique<neo::sqlite3::transaction_guard>(
+            db1, neo::sqlite3::transaction_mode::immediate);
+        std::thread releaser{[&] {
+            std::this_thread::sleep_for(50ms);
+            tr->commit();
+        }};
+        int n_calls = 0;
+        neo::sqlite3::run_transaction(db2, neo::sqlite3::transaction_mode::immediate, [&] {
+            ++n_calls;
+            db2.exec("INSERT INTO foo VALUES (42)").throw_if_error();
+        });
+        releaser.join();
+        CHECK(n_calls == 1);
+        CHECK(*neo::sqlite3::one_cell<int>(*db1.prepare("SELECT bar FROM foo")) == 42);
+    }
+
+    SECTION("Until the deadline passes") {
+        neo::sqlite3::transaction_guard tr{db1, neo::sqlite3::transaction_mode::immediate};
+        neo::sqlite3::retry_policy      policy{.deadline = 20ms};
+        auto                            start = std::chrono::steady_clock::now();
+        CHECK_THROWS_AS(neo::sqlite3::run_transaction(db2,
+                                                      neo::sqlite3::transaction_mode::immediate,
+                                                      [] {},
+                                                      policy),
+                        neo::sqlite3::busy_error);
+        // Retrying continues until the deadline
+        CHECK(std::chrono::steady_clock::now() - start >= 20ms);
+        CHECK_FALSE(db2.is_transaction_active());
+    }
+
+    // Close the connections before removing the file
+}
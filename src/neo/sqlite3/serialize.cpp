@@ -0,0 +1,179 @@
+#include "./serialize.hpp"
+
+#include <neo/sqlite3/connection_ref.hpp>
+#include <neo/sqlite3/errable.hpp>
+
+#include <sqlite3/sqlite3.h>
+
+#include <cstring>
+#include <new>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace neo::sqlite3;
+
+serialized_database::~serialized_database() { ::sqlite3_free(_data); }
+
+serialized_database serialized_database::copy_of(std::span<const std::byte> bytes) {
+    auto ptr = static_cast<std::byte*>(::sqlite3_malloc64(bytes.size()));
+    if (!ptr && !bytes.empty()) {
+        throw std::bad_alloc();
+    }
+    if (!bytes.empty()) {
+        std::memcpy(ptr, bytes.data(), bytes.size());
+    }
+    return serialized_database{std::move(ptr), bytes.size()};
+}
+
+errable<serialized_database> connection_ref::serialize(neo::zstring_view schema) const noexcept {
+    ::sqlite3_int64 size = 0;
+    auto ptr = reinterpret_cast<std::byte*>(::sqlite3_serialize(c_ptr(), schema.data(), &size, 0));
+    if (!ptr) {
+        if (size == 0) {
+            // The database is empty
+            return serialized_database{};
+        }
+        if (size < 0) {
+            // The size is only known if the schema exists and its size could be read
+            return {errc::error, "Failed to serialize the database: No such schema", *this};
+        }
+        return {errc::no_memory, "Failed to serialize the database", *this};
+    }
+    return serialized_database{std::move(ptr), static_cast<std::size_t>(size)};
+}
+
+std::span<const std::byte>
+connection_ref::serialized_view(neo::zstring_view schema) const noexcept {
+    ::sqlite3_int64 size = 0;
+    auto ptr = ::sqlite3_serialize(c_ptr(), schema.data(), &size, SQLITE_SERIALIZE_NOCOPY);
+    if (!ptr) {
+        return {};
+    }
+    return {reinterpret_cast<const std::byte*>(ptr), static_cast<std::size_t>(size)};
+}
+
+errable<void> connection_ref::deserialize(serialized_database&& data,
+                                          neo::zstring_view     schema) noexcept {
+    const auto size = static_cast<::sqlite3_int64>(data.size());
+    // SQLite frees the buffer even if deserialization fails
+    auto rc = errc{::sqlite3_deserialize(c_ptr(),
+                                         schema.data(),
+                                         reinterpret_cast<unsigned char*>(data.release()),
+                                         size,
+                                         size,
+                                         SQLITE_DESERIALIZE_FREEONCLOSE
+                                             | SQLITE_DESERIALIZE_RESIZEABLE)};
+    if (rc != errc::ok) {
+        return {rc, "Failed to deserialize a database", *this};
+    }
+    return errc::ok;
+}
+
+errable<void> connection_ref::deserialize_readonly(std::span<const std::byte> data,
+                                                   neo::zstring_view          schema) noexcept {
+    const auto size = static_cast<::sqlite3_int64>(data.size());
+    // SQLite will never write to the buffer of a read-only database
+    auto buf = reinterpret_cast<unsigned char*>(const_cast<std::byte*>(data.data()));
+    auto rc  = errc{::sqlite3_deserialize(c_ptr(),
+                                         schema.data(),
+                                         buf,
+                                         size,
+                                         size,
+                                         SQLITE_DESERIALIZE_READONLY)};
+    if (rc != errc::ok) {
+        return {rc, "Failed to deserialize a read-only database", *this};
+    }
+    return errc::ok;
+}
+
+#ifdef _WIN32
+
+errable<mapped_file> mapped_file::open(neo::zstring_view path) noexcept {
+    auto file = ::CreateFileA(path.data(),
+                              GENERIC_READ,
+                              FILE_SHARE_READ,
+                              nullptr,
+                              OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL,
+                              nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return {errc::cant_open, "Failed to open a file for mapping"};
+    }
+    LARGE_INTEGER size;
+    if (!::GetFileSizeEx(file, &size)) {
+        ::CloseHandle(file);
+        return {errc::ioerr_fstat, "Failed to obtain the size of a file for mapping"};
+    }
+    mapped_file ret;
+    if (size.QuadPart == 0) {
+        // Empty files cannot be mapped
+        ::CloseHandle(file);
+        return ret;
+    }
+    // The mapping keeps the file open, so the file handle is no longer needed
+    auto mapping = ::CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    ::CloseHandle(file);
+    if (!mapping) {
+        return {errc::ioerr_mmap, "Failed to map a file"};
+    }
+    auto view = ::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view) {
+        ::CloseHandle(mapping);
+        return {errc::ioerr_mmap, "Failed to map a file"};
+    }
+    ret._data    = static_cast<const std::byte*>(view);
+    ret._size    = static_cast<std::size_t>(size.QuadPart);
+    ret._mapping = mapping;
+    return ret;
+}
+
+void mapped_file::_unmap() noexcept {
+    if (_data) {
+        ::UnmapViewOfFile(_data);
+        ::CloseHandle(_mapping);
+    }
+}
+
+#else
+
+errable<mapped_file> mapped_file::open(neo::zstring_view path) noexcept {
+    auto fd = ::open(path.data(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return {errc::cant_open, "Failed to open a file for mapping"};
+    }
+    struct ::stat st;
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        return {errc::ioerr_fstat, "Failed to obtain the size of a file for mapping"};
+    }
+    mapped_file ret;
+    if (st.st_size == 0) {
+        // Empty files cannot be mapped
+        ::close(fd);
+        return ret;
+    }
+    // The mapping keeps the file open, so the descriptor is no longer needed
+    auto ptr = ::mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (ptr == MAP_FAILED) {
+        return {errc::ioerr_mmap, "Failed to map a file"};
+    }
+    ret._data = static_cast<const std::byte*>(ptr);
+    ret._size = static_cast<std::size_t>(st.st_size);
+    return ret;
+}
+
+void mapped_file::_unmap() noexcept {
+    if (_data) {
+        ::munmap(const_cast<std::byte*>(_data), _size);
+    }
+}
+
+#endif
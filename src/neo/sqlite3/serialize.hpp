@@ -0,0 +1,114 @@
+#pragma once
+
+#include "./errable_fwd.hpp"
+
+#include <neo/zstring_view.hpp>
+
+#include <cstddef>
+#include <span>
+#include <utility>
+
+namespace neo::sqlite3 {
+
+/**
+ * @brief An owned copy of the content of a database, as produced by connection_ref::serialize().
+ *
+ * The buffer is allocated by SQLite, so that it may be handed back to SQLite with
+ * connection_ref::deserialize() without copying.
+ */
+class serialized_database {
+    std::byte*  _data = nullptr;
+    std::size_t _size = 0;
+
+public:
+    serialized_database() = default;
+
+    /// Take ownership of a buffer that was allocated with sqlite3_malloc64()
+    explicit serialized_database(std::byte*&& data, std::size_t size) noexcept
+        : _data(std::exchange(data, nullptr))
+        , _size(size) {}
+
+    ~serialized_database();
+
+    serialized_database(serialized_database&& o) noexcept
+        : _data(std::exchange(o._data, nullptr))
+        , _size(std::exchange(o._size, 0)) {}
+
+    serialized_database& operator=(serialized_database&& o) noexcept {
+        std::swap(_data, o._data);
+        std::swap(_size, o._size);
+        return *this;
+    }
+
+    /**
+     * @brief Create a copy of the given bytes in a buffer allocated by SQLite.
+     *
+     * @throws std::bad_alloc if allocation fails
+     */
+    [[nodiscard]] static serialized_database copy_of(std::span<const std::byte> bytes);
+
+    [[nodiscard]] std::byte*  data() const noexcept { return _data; }
+    [[nodiscard]] std::size_t size() const noexcept { return _size; }
+
+    [[nodiscard]] std::span<const std::byte> bytes() const noexcept { return {_data, _size}; }
+
+    /// Relinquish ownership of the buffer. It must be freed with sqlite3_free()
+    [[nodiscard]] std::byte* release() noexcept {
+        _size = 0;
+        return std::exchange(_data, nullptr);
+    }
+};
+
+/**
+ * @brief A read-only memory mapping of an entire file, suitable for passing to
+ * connection_ref::deserialize_readonly().
+ *
+ * Pages of the file are read by the OS on first access, and are shared between every mapping
+ * of the file, so many connections (or processes) can use one database file with no copies.
+ */
+class mapped_file {
+    const std::byte* _data = nullptr;
+    std::size_t      _size = 0;
+#ifdef _WIN32
+    void* _mapping = nullptr;
+#endif
+
+    void _unmap() noexcept;
+
+public:
+    mapped_file() = default;
+    ~mapped_file() { _unmap(); }
+
+    mapped_file(mapped_file&& o) noexcept
+        : _data(std::exchange(o._data, nullptr))
+        , _size(std::exchange(o._size, 0))
+#ifdef _WIN32
+        , _mapping(std::exchange(o._mapping, nullptr))
+#endif
+    {
+    }
+
+    mapped_file& operator=(mapped_file&& o) noexcept {
+        std::swap(_data, o._data);
+        std::swap(_size, o._size);
+#ifdef _WIN32
+        std::swap(_mapping, o._mapping);
+#endif
+        return *this;
+    }
+
+    /**
+     * @brief Map the file at the given path into memory.
+     *
+     * @return errc::cant_open if the file cannot be opened, or errc::ioerr_mmap if it cannot be
+     * mapped.
+     */
+    [[nodiscard]] static errable<mapped_file> open(neo::zstring_view path) noexcept;
+
+    [[nodiscard]] const std::byte* data() const noexcept { return _data; }
+    [[nodiscard]] std::size_t      size() const noexcept { return _size; }
+
+    [[nodiscard]] std::span<const std::byte> bytes() const noexcept { return {_data, _size}; }
+};
+
+}  // namespace neo::sqlite3
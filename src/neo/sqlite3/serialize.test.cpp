@@ -0,0 +1,84 @@
+#include <neo/sqlite3/exec.hpp>
+#include <neo/sqlite3/serialize.hpp>
+
+#include "./tests.inl"
+
+#include <filesystem>
+#include <fstream>
+
+namespace {
+
+int count_rows(neo::sqlite3::connection_ref db) {
+    return *neo::sqlite3::one_cell<int>(*db.prepare("SELECT count(*) FROM foo"));
+}
+
+}  // namespace
+
+TEST_CASE_METHOD(sqlite3_memory_db_fixture, "Serialize and deserialize a database") {
+    CHECK(db.serialize()->size() == 0);
+
+    db.exec(R"(
+        CREATE TABLE foo (a INTEGER PRIMARY KEY, b TEXT);
+        WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < 500)
+        INSERT INTO foo SELECT i, printf('row %d', i) FROM n;
+    )")
+        .throw_if_error();
+
+    auto data = *db.serialize();
+    REQUIRE(data.size() > 0);
+    // The serialization has the format of a database file
+    CHECK(std::string_view(reinterpret_cast<const char*>(data.data()), 15) == "SQLite format 3");
+    // A regular in-memory database cannot be viewed without copying
+    CHECK(db.serialized_view().empty());
+
+    SECTION("Clone into a writable database") {
+        auto clone = *neo::sqlite3::create_memory_db();
+        clone.deserialize(neo::sqlite3::serialized_database::copy_of(data.bytes()))
+            .throw_if_error();
+        CHECK(count_rows(clone) == 500);
+        clone.exec("INSERT INTO foo (b) VALUES ('more')").throw_if_error();
+        CHECK(count_rows(clone) == 501);
+        CHECK(count_rows(db) == 500);
+
+        // The deserialized database can be viewed without copying
+        auto view = clone.serialized_view();
+        CHECK(view.size() >= data.size());
+
+        clone.deserialize(std::move(data)).throw_if_error();
+        CHECK(count_rows(clone) == 500);
+    }
+
+    SECTION("Open a read-only database from a caller-owned buffer") {
+        auto clone = *neo::sqlite3::create_memory_db();
+        clone.deserialize_readonly(data.bytes()).throw_if_error();
+        CHECK(count_rows(clone) == 500);
+        CHECK(clone.exec("DELETE FROM foo").errc() == neo::sqlite3::errc::readonly);
+        CHECK(clone.serialized_view().data() == data.data());
+    }
+
+    SECTION("Open a read-only database from a mapped file") {
+        sqlite3_temp_db_fixture tmp;
+        const auto&             path = tmp.path;
+        {
+            std::ofstream out{path, std::ios::binary};
+            out.write(reinterpret_cast<const char*>(data.data()),
+                      static_cast<std::streamsize>(data.size()));
+        }
+        {
+            auto file = *neo::sqlite3::mapped_file::open(path.string());
+            CHECK(file.size() == data.size());
+            auto clone = *neo::sqlite3::create_memory_db();
+            clone.deserialize_readonly(file.bytes()).throw_if_error();
+            CHECK(count_rows(clone) == 500);
+        }
+        std::filesystem::remove(path);
+        CHECK(neo::sqlite3::mapped_file::open(path.string()).errc()
+              == neo::sqlite3::errc::cant_open);
+    }
+
+    SECTION("Invalid schema") {
+        CHECK(db.serialize("nonesuch") == neo::sqlite3::errc::error);
+        CHECK(db.serialized_view("nonesuch").empty());
+        CHECK(db.deserialize(neo::sqlite3::serialized_database{}, "nonesuch").is_error());
+    }
+}
@@ -0,0 +1,55 @@
+#include "./shared_memory_db.hpp"
+
+#include <neo/sqlite3/busy_policy.hpp>
+
+#include <neo/ufmt.hpp>
+
+using namespace neo::sqlite3;
+
+namespace {
+
+/// Percent-encode the characters of a name that have special meaning in a URI
+std::string uri_escape(std::string_view name) {
+    std::string ret;
+    for (char c : name) {
+        if (c == '?' || c == '#' || c == '%' || c == '&' || c == '=' || c <= ' ' || c > '~') {
+            constexpr std::string_view hex = "0123456789ABCDEF";
+            auto                       u   = static_cast<unsigned char>(c);
+            ret.push_back('%');
+            ret.push_back(hex[u >> 4]);
+            ret.push_back(hex[u & 0xf]);
+        } else {
+            ret.push_back(c);
+        }
+    }
+    return ret;
+}
+
+std::vector<connection> open_readers(std::string_view name, std::size_t n) {
+    std::vector<connection> readers;
+    readers.reserve(n);
+    for (auto i = 0u; i < n; ++i) {
+        auto db = *open_shared_memory_db(name, openmode::readonly);
+        db.set_busy_policy(busy_policy::backoff(std::chrono::seconds{5}));
+        readers.push_back(std::move(db));
+    }
+    return readers;
+}
+
+}  // namespace
+
+errable<connection> neo::sqlite3::open_shared_memory_db(std::string_view name,
+                                                        openmode         mode) noexcept {
+    std::string uri;
+    try {
+        uri = neo::ufmt("file:/{}?vfs=memdb", uri_escape(name));
+    } catch (const std::bad_alloc&) {
+        return {errc::no_memory, "Failed to open a shared in-memory database"};
+    }
+    return connection::open(uri, mode | openmode::uri);
+}
+
+shared_memory_db::shared_memory_db(std::string_view name, std::size_t n_readers)
+    : _name(name)
+    , _writer(*open_shared_memory_db(name))
+    , _readers(open_readers(name, n_readers)) {}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <neo/sqlite3/connection.hpp>
+#include <neo/sqlite3/connection_pool.hpp>
+
+#include <string>
+#include <string_view>
+
+namespace neo::sqlite3 {
+
+/**
+ * @brief Open a connection to a named in-memory database that is shared by every connection
+ * in the process that opens the same name.
+ *
+ * The database uses the "memdb" VFS, and is opened with the URI "file:/<name>?vfs=memdb". It
+ * exists for as long as any connection to it remains open. Unlike a shared-cache ":memory:"
+ * database, each connection has its own page cache and uses ordinary database locking, so
+ * connections can read it from several threads at once.
+ */
+[[nodiscard]] errable<connection>
+open_shared_memory_db(std::string_view name,
+                      openmode         mode = openmode::readwrite | openmode::create) noexcept;
+
+/**
+ * @brief A named in-memory database, with one connection for writing and a pool of read-only
+ * connections for querying it concurrently.
+ *
+ * The database uses a rollback journal (memdb does not support WAL), so readers wait for the
+ * writer to commit. Readers are given a busy policy so that they wait rather than fail.
+ */
+class shared_memory_db {
+    std::string     _name;
+    connection      _writer;
+    connection_pool _readers;
+
+public:
+    /**
+     * @brief Create (or open) the named shared in-memory database with the given number of
+     * reader connections.
+     */
+    shared_memory_db(std::string_view name, std::size_t n_readers);
+
+    /// The name of the database
+    [[nodiscard]] const std::string& name() const noexcept { return _name; }
+
+    /**
+     * @brief The read-write connection to the database. This connection keeps the database
+     * alive, and must only be used by one thread at a time.
+     */
+    [[nodiscard]] connection_ref writer() noexcept { return _writer; }
+
+    /// Lease a read-only connection, waiting until one is available
+    [[nodiscard]] connection_pool::lease acquire_reader() { return _readers.acquire(); }
+
+    /// The pool of read-only connections
+    [[nodiscard]] connection_pool& readers() noexcept { return _readers; }
+};
+
+}  // namespace neo::sqlite3
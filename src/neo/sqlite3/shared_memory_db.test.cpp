@@ -0,0 +1,62 @@
+#include <neo/sqlite3/exec.hpp>
+#include <neo/sqlite3/shared_memory_db.hpp>
+
+#include "./tests.inl"
+
+#include <atomic>
+#include <thread>
+
+TEST_CASE("Open a shared in-memory database") {
+    auto db1 = *neo::sqlite3::open_shared_memory_db("neo-sqlite3 test?db");
+    db1.exec("CREATE TABLE foo (a); INSERT INTO foo VALUES (42)").throw_if_error();
+
+    auto db2 = *neo::sqlite3::open_shared_memory_db("neo-sqlite3 test?db");
+    CHECK(*neo::sqlite3::one_cell<int>(*db2.prepare("SELECT a FROM foo")) == 42);
+
+    // A different name is a different database
+    auto other = *neo::sqlite3::open_shared_memory_db("neo-sqlite3 test");
+    CHECK(other.prepare("SELECT a FROM foo").is_error());
+}
+
+TEST_CASE("Query a shared in-memory database from many threads") {
+    neo::sqlite3::shared_memory_db db{"neo-sqlite3-pool-test", 4};
+    db.writer()
+        .exec(R"(
+            CREATE TABLE foo (a INTEGER);
+            WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < 1000)
+            INSERT INTO foo SELECT i FROM n;
+        )")
+        .throw_if_error();
+    CHECK(db.readers().size() == 4);
+    CHECK(db.readers().available() == 4);
+
+    std::atomic<std::int64_t> total{0};
+    std::vector<std::thread>  threads;
+    for (auto i = 0; i < 8; ++i) {
+        threads.emplace_back([&] {
+            auto reader = db.acquire_reader();
+            auto sum    = *neo::sqlite3::one_cell<std::int64_t>(
+                *reader->prepare("SELECT sum(a) FROM foo"));
+            total += sum;
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    CHECK(total == 8 * (1000 * 1001 / 2));
+    CHECK(db.readers().available() == 4);
+
+    // Readers cannot write
+    auto reader = db.acquire_reader();
+    CHECK(reader->exec("DELETE FROM foo").errc() == neo::sqlite3::errc::readonly);
+
+    // Leases are exclusive
+    std::vector<neo::sqlite3::connection_pool::lease> leases;
+    while (auto l = db.readers().try_acquire()) {
+        leases.push_back(std::move(*l));
+    }
+    CHECK(leases.size() == 3);
+    CHECK_FALSE(db.readers().try_acquire_for(std::chrono::milliseconds{1}));
+    leases.clear();
+    CHECK(db.readers().available() == 3);
+}
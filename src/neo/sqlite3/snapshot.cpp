@@ -0,0 +1,55 @@
+#include "./snapshot.hpp"
+
+#include <neo/sqlite3/connection_ref.hpp>
+#include <neo/sqlite3/errable.hpp>
+
+#include <sqlite3/sqlite3.h>
+
+using namespace neo::sqlite3;
+
+#ifdef SQLITE_ENABLE_SNAPSHOT
+
+snapshot::~snapshot() {
+    if (_ptr) {
+        ::sqlite3_snapshot_free(release());
+    }
+}
+
+int snapshot::compare(const snapshot& other) const noexcept {
+    return ::sqlite3_snapshot_cmp(c_ptr(), other.c_ptr());
+}
+
+errable<snapshot> connection_ref::get_snapshot(zstring_view schema) noexcept {
+    ::sqlite3_snapshot* ptr = nullptr;
+    auto                rc  = errc{::sqlite3_snapshot_get(c_ptr(), schema.data(), &ptr)};
+    if (rc != errc::ok) {
+        return {rc, "Failed to obtain a snapshot of the database", *this};
+    }
+    return snapshot{std::move(ptr)};
+}
+
+errable<void> connection_ref::open_snapshot(const snapshot& snap, zstring_view schema) noexcept {
+    auto rc = errc{::sqlite3_snapshot_open(c_ptr(), schema.data(), snap.c_ptr())};
+    if (rc != errc::ok) {
+        return {rc, "Failed to open a read transaction on a database snapshot", *this};
+    }
+    return errc::ok;
+}
+
+#else
+
+// SQLite was built without snapshot support, so no snapshot can ever be created
+
+snapshot::~snapshot() = default;
+
+int snapshot::compare(const snapshot&) const noexcept { return 0; }
+
+errable<snapshot> connection_ref::get_snapshot(zstring_view) noexcept {
+    return {errc::error, "SQLite was compiled without SQLITE_ENABLE_SNAPSHOT"};
+}
+
+errable<void> connection_ref::open_snapshot(const snapshot&, zstring_view) noexcept {
+    return {errc::error, "SQLite was compiled without SQLITE_ENABLE_SNAPSHOT"};
+}
+
+#endif
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "./errable_fwd.hpp"
+
+#include <utility>
+
+struct sqlite3_snapshot;
+
+namespace neo::sqlite3 {
+
+/**
+ * @brief An owning handle to a point-in-time view of a WAL-mode database.
+ *
+ * Obtain a snapshot with connection_ref::get_snapshot() while the connection has a read
+ * transaction open, then open other connections to the same database on that snapshot with
+ * connection_ref::open_snapshot(). Every connection will then read the database exactly as it
+ * was when the snapshot was taken, even while other connections continue to write. This allows
+ * a single large read to be split across many connections (and threads) with a consistent view.
+ *
+ * Snapshots require SQLite to be compiled with SQLITE_ENABLE_SNAPSHOT. If it is not,
+ * get_snapshot() will always fail with errc::error.
+ *
+ * @note A snapshot can only be opened while the WAL still contains it. If the WAL is reset by a
+ * checkpoint, opening the snapshot fails with errc::error_snapshot. Keeping a read transaction
+ * open on the connection that took the snapshot prevents the WAL from being reset.
+ */
+class snapshot {
+    ::sqlite3_snapshot* _ptr = nullptr;
+
+public:
+    ~snapshot();
+
+    snapshot() = default;
+
+    explicit snapshot(::sqlite3_snapshot*&& ptr) noexcept
+        : _ptr(std::exchange(ptr, nullptr)) {}
+
+    snapshot(snapshot&& o) noexcept
+        : _ptr(o.release()) {}
+
+    snapshot& operator=(snapshot&& other) noexcept {
+        std::swap(_ptr, other._ptr);
+        return *this;
+    }
+
+    [[nodiscard]] ::sqlite3_snapshot* c_ptr() const noexcept { return _ptr; }
+    [[nodiscard]] ::sqlite3_snapshot* release() noexcept { return std::exchange(_ptr, nullptr); }
+
+    /**
+     * @brief Determine whether this snapshot is older than another snapshot of the same database.
+     *
+     * @return A negative value if this snapshot is older than `other`, a positive value if it is
+     * newer, or zero if they are the same.
+     */
+    [[nodiscard]] int compare(const snapshot& other) const noexcept;
+};
+
+}  // namespace neo::sqlite3
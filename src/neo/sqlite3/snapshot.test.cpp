@@ -0,0 +1,56 @@
+#include <neo/sqlite3/exec.hpp>
+#include <neo/sqlite3/pragma.hpp>
+#include <neo/sqlite3/snapshot.hpp>
+#include <neo/sqlite3/transaction.hpp>
+
+#include "./tests.inl"
+
+#include <sqlite3/sqlite3.h>
+
+
+#ifdef SQLITE_ENABLE_SNAPSHOT
+
+TEST_CASE_METHOD(sqlite3_temp_db_fixture, "Read from a snapshot on several connections") {
+    {
+        auto writer = *neo::sqlite3::open(path.string());
+        neo::sqlite3::pragma::set_journal_mode(writer, neo::sqlite3::journal_mode::wal);
+        writer.exec("CREATE TABLE foo (a INTEGER); INSERT INTO foo VALUES (1)").throw_if_error();
+
+        auto count_rows = [](neo::sqlite3::connection_ref db) {
+            return *neo::sqlite3::one_cell<int>(*db.prepare("SELECT count(*) FROM foo"));
+        };
+
+        auto                            reader = *neo::sqlite3::open(path.string());
+        neo::sqlite3::transaction_guard tr{reader};
+        CHECK(count_rows(reader) == 1);
+        auto snap = *reader.get_snapshot();
+
+        writer.exec("INSERT INTO foo VALUES (2)").throw_if_error();
+        CHECK(count_rows(writer) == 2);
+
+        auto other = *neo::sqlite3::open(path.string());
+        {
+            neo::sqlite3::transaction_guard tr2{other};
+            other.open_snapshot(snap).throw_if_error();
+            // The connection sees the database as it was when the snapshot was taken
+            CHECK(count_rows(other) == 1);
+        }
+        // Outside of the transaction, the newest data is visible again
+        CHECK(count_rows(other) == 2);
+
+        neo::sqlite3::transaction_guard tr3{other};
+        CHECK(count_rows(other) == 2);
+        auto newer = *other.get_snapshot();
+        CHECK(snap.compare(newer) < 0);
+        CHECK(newer.compare(snap) > 0);
+        CHECK(snap.compare(snap) == 0);
+    }
+}
+
+#else
+
+TEST_CASE_METHOD(sqlite3_memory_db_fixture, "Snapshots are unavailable") {
+    CHECK(db.get_snapshot().errc() == neo::sqlite3::errc::error);
+}
+
+#endif
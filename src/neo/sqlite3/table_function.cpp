@@ -0,0 +1,253 @@
+#include "./table_function.hpp"
+
+#include <neo/sqlite3/error.hpp>
+#include <neo/sqlite3/identifier.hpp>
+
+#include <neo/ufmt.hpp>
+#include <sqlite3/sqlite3.h>
+
+#include <cstring>
+#include <vector>
+
+using namespace neo::sqlite3;
+
+namespace {
+
+struct table_fn_vtab {
+    ::sqlite3_vtab         base;
+    detail::table_fn_base* fn;
+};
+
+struct table_fn_cursor {
+    ::sqlite3_vtab_cursor base{};
+    /// Private copies of the arguments of the current invocation
+    std::vector<::sqlite3_value*> args;
+    /// The rows of the current invocation. Destroyed before 'args'
+    std::unique_ptr<detail::table_fn_rows_base> rows;
+    std::int64_t                                rowid = 0;
+
+    void reset() noexcept {
+        rows.reset();
+        for (auto arg : args) {
+            ::sqlite3_value_free(arg);
+        }
+        args.clear();
+    }
+
+    ~table_fn_cursor() { reset(); }
+};
+
+detail::table_fn_base& get_fn(::sqlite3_vtab* vtab) noexcept {
+    return *reinterpret_cast<table_fn_vtab*>(vtab)->fn;
+}
+
+void set_vtab_error(::sqlite3_vtab* vtab, const char* message) noexcept {
+    ::sqlite3_free(vtab->zErrMsg);
+    vtab->zErrMsg = ::sqlite3_mprintf("%s", message);
+}
+
+int table_fn_connect(::sqlite3* db,
+                     void*      aux,
+                     int,
+                     const char* const*,
+                     ::sqlite3_vtab** out,
+                     char**           errmsg) noexcept {
+    auto& fn = *static_cast<detail::table_fn_base*>(aux);
+    try {
+        auto rc = ::sqlite3_declare_vtab(db, fn.schema().data());
+        if (rc != SQLITE_OK) {
+            return rc;
+        }
+    } catch (const std::exception& e) {
+        *errmsg = ::sqlite3_mprintf("%s", e.what());
+        return SQLITE_ERROR;
+    }
+    auto vtab = static_cast<table_fn_vtab*>(::sqlite3_malloc(sizeof(table_fn_vtab)));
+    if (!vtab) {
+        return SQLITE_NOMEM;
+    }
+    std::memset(vtab, 0, sizeof *vtab);
+    vtab->fn = &fn;
+    *out     = &vtab->base;
+    return SQLITE_OK;
+}
+
+int table_fn_disconnect(::sqlite3_vtab* vtab) noexcept {
+    ::sqlite3_free(vtab);
+    return SQLITE_OK;
+}
+
+int table_fn_best_index(::sqlite3_vtab* vtab, ::sqlite3_index_info* info) noexcept {
+    auto&             fn        = get_fn(vtab);
+    const auto        first_arg = fn.column_count();
+    std::vector<bool> found(static_cast<std::size_t>(fn.arg_count()));
+    int               n_found = 0;
+    for (auto i = 0; i < info->nConstraint; ++i) {
+        auto& cons    = info->aConstraint[i];
+        auto  arg_idx = cons.iColumn - first_arg;
+        if (arg_idx < 0 || cons.op != SQLITE_INDEX_CONSTRAINT_EQ || found[arg_idx]) {
+            continue;
+        }
+        if (!cons.usable) {
+            // The planner must find a plan in which all arguments are available
+            return SQLITE_CONSTRAINT;
+        }
+        info->aConstraintUsage[i].argvIndex = arg_idx + 1;
+        info->aConstraintUsage[i].omit      = 1;
+        found[arg_idx]                      = true;
+        ++n_found;
+    }
+    if (n_found != fn.arg_count()) {
+        set_vtab_error(vtab, "Too few arguments were given to a table-valued function");
+        return SQLITE_ERROR;
+    }
+    info->estimatedCost = 1000;
+    info->estimatedRows = 1000;
+    return SQLITE_OK;
+}
+
+int table_fn_open(::sqlite3_vtab*, ::sqlite3_vtab_cursor** out) noexcept {
+    auto cur = new (std::nothrow) table_fn_cursor{};
+    if (!cur) {
+        return SQLITE_NOMEM;
+    }
+    *out = &cur->base;
+    return SQLITE_OK;
+}
+
+int table_fn_close(::sqlite3_vtab_cursor* cur) noexcept {
+    delete reinterpret_cast<table_fn_cursor*>(cur);
+    return SQLITE_OK;
+}
+
+int table_fn_filter(::sqlite3_vtab_cursor* cur_,
+                    int,
+                    const char*,
+                    int               argc,
+                    ::sqlite3_value** argv) noexcept {
+    auto& cur  = *reinterpret_cast<table_fn_cursor*>(cur_);
+    auto  vtab = cur.base.pVtab;
+    cur.reset();
+    cur.rowid = 0;
+    try {
+        for (auto i = 0; i < argc; ++i) {
+            auto dup = ::sqlite3_value_dup(argv[i]);
+            if (!dup) {
+                return SQLITE_NOMEM;
+            }
+            cur.args.push_back(dup);
+        }
+        cur.rows = get_fn(vtab).invoke(cur.args.data());
+    } catch (const std::exception& e) {
+        set_vtab_error(vtab, e.what());
+        return SQLITE_ERROR;
+    } catch (...) {
+        set_vtab_error(vtab,
+                       "[neo-sqlite3]: Non-std::exception type was thrown by a table-valued "
+                       "function");
+        return SQLITE_ERROR;
+    }
+    return SQLITE_OK;
+}
+
+int table_fn_next(::sqlite3_vtab_cursor* cur_) noexcept {
+    auto& cur = *reinterpret_cast<table_fn_cursor*>(cur_);
+    try {
+        cur.rows->advance();
+    } catch (const std::exception& e) {
+        set_vtab_error(cur.base.pVtab, e.what());
+        return SQLITE_ERROR;
+    } catch (...) {
+        set_vtab_error(cur.base.pVtab,
+                       "[neo-sqlite3]: Non-std::exception type was thrown by a table-valued "
+                       "function");
+        return SQLITE_ERROR;
+    }
+    ++cur.rowid;
+    return SQLITE_OK;
+}
+
+int table_fn_eof(::sqlite3_vtab_cursor* cur_) noexcept {
+    auto& cur = *reinterpret_cast<table_fn_cursor*>(cur_);
+    return !cur.rows || cur.rows->at_end();
+}
+
+int table_fn_column(::sqlite3_vtab_cursor* cur_, ::sqlite3_context* ctx, int col) noexcept {
+    auto& cur = *reinterpret_cast<table_fn_cursor*>(cur_);
+    auto& fn  = get_fn(cur.base.pVtab);
+    if (col >= fn.column_count()) {
+        // A hidden argument column
+        ::sqlite3_result_value(ctx, cur.args[static_cast<std::size_t>(col - fn.column_count())]);
+        return SQLITE_OK;
+    }
+    try {
+        cur.rows->column_value(ctx, col);
+    } catch (const std::exception& e) {
+        ::sqlite3_result_error(ctx, e.what(), -1);
+    } catch (...) {
+        ::sqlite3_result_error(ctx,
+                               "[neo-sqlite3]: Non-std::exception type was thrown by a "
+                               "table-valued function",
+                               -1);
+    }
+    return SQLITE_OK;
+}
+
+int table_fn_rowid(::sqlite3_vtab_cursor* cur, ::sqlite3_int64* out) noexcept {
+    *out = reinterpret_cast<table_fn_cursor*>(cur)->rowid;
+    return SQLITE_OK;
+}
+
+void destroy_table_fn(void* ptr) noexcept { delete static_cast<detail::table_fn_base*>(ptr); }
+
+// xCreate is null, which makes this an eponymous-only virtual table
+constexpr ::sqlite3_module table_fn_module = {
+    .iVersion    = 0,
+    .xCreate     = nullptr,
+    .xConnect    = &table_fn_connect,
+    .xBestIndex  = &table_fn_best_index,
+    .xDisconnect = &table_fn_disconnect,
+    .xDestroy    = &table_fn_disconnect,
+    .xOpen       = &table_fn_open,
+    .xClose      = &table_fn_close,
+    .xFilter     = &table_fn_filter,
+    .xNext       = &table_fn_next,
+    .xEof        = &table_fn_eof,
+    .xColumn     = &table_fn_column,
+    .xRowid      = &table_fn_rowid,
+};
+
+}  // namespace
+
+std::string detail::table_fn_base::schema() const {
+    std::string ret = "CREATE TABLE x(";
+    for (auto& name : _column_names) {
+        ret += quote_identifier(name);
+        ret += ", ";
+    }
+    for (auto i = 0; i < _arg_count; ++i) {
+        ret += ufmt("arg{} HIDDEN, ", i + 1);
+    }
+    // Drop the trailing comma
+    ret.resize(ret.size() - 2);
+    ret += ")";
+    return ret;
+}
+
+void detail::register_table_function(::sqlite3*                     db,
+                                     neo::zstring_view              name,
+                                     std::unique_ptr<table_fn_base> fn) {
+    auto rc = ::sqlite3_create_module_v2(db,
+                                         name.data(),
+                                         &table_fn_module,
+                                         fn.get(),
+                                         &destroy_table_fn);
+    // sqlite3_create_module_v2 calls the destructor even if it fails
+    fn.release();
+    auto ec = to_error_code(rc);
+    if (ec) {
+        throw_error(ec,
+                    ufmt("Error while creating table-valued function '{}'", name),
+                    connection_ref(db));
+    }
+}
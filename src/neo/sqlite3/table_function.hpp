@@ -0,0 +1,216 @@
+#pragma once
+
+#include <neo/sqlite3/connection.hpp>
+#include <neo/sqlite3/function.hpp>
+
+#include <neo/function_traits.hpp>
+#include <neo/fwd.hpp>
+
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <optional>
+#include <ranges>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+struct sqlite3_context;
+struct sqlite3_value;
+
+namespace neo::sqlite3 {
+
+namespace detail {
+
+template <typename T>
+concept tuple_like_row = requires {
+    std::tuple_size<std::remove_cvref_t<T>>::value;
+};
+
+/**
+ * @brief A single in-progress invocation of a table-valued function
+ */
+class table_fn_rows_base {
+public:
+    virtual ~table_fn_rows_base() = default;
+
+    [[nodiscard]] virtual bool at_end() = 0;
+
+    virtual void advance()                                  = 0;
+    virtual void column_value(sqlite3_context* ctx, int col) = 0;
+};
+
+template <typename Range>
+class table_fn_rows final : public table_fn_rows_base {
+    using reference = std::ranges::range_reference_t<Range>;
+
+    /// Elements that are computed when they are dereferenced (e.g. by a transform view) are
+    /// computed once for each row, rather than once for each column
+    constexpr static bool cache_elems = !std::is_lvalue_reference_v<reference>;
+    struct no_elem {};
+    using cache_type = std::conditional_t<cache_elems, std::remove_cvref_t<reference>, no_elem>;
+
+    Range                                         _range;
+    std::optional<std::ranges::iterator_t<Range>> _it;
+    std::optional<cache_type>                     _elem;
+
+    decltype(auto) _current() {
+        if constexpr (cache_elems) {
+            if (!_elem) {
+                _elem.emplace(**_it);
+            }
+            return (*_elem);
+        } else {
+            return **_it;
+        }
+    }
+
+    template <std::size_t... Is>
+    void _column_value(sqlite3_context* ctx, int col, std::index_sequence<Is...>) {
+        decltype(auto) elem = _current();
+        static_cast<void>(
+            ((static_cast<int>(Is) == col && (assign_result(ctx, std::get<Is>(elem)), true))
+             || ...));
+    }
+
+public:
+    template <typename R>
+    explicit table_fn_rows(R&& r)
+        : _range(NEO_FWD(r)) {
+        _it.emplace(std::ranges::begin(_range));
+    }
+
+    bool at_end() override { return *_it == std::ranges::end(_range); }
+    void advance() override {
+        _elem.reset();
+        ++*_it;
+    }
+
+    void column_value(sqlite3_context* ctx, int col) override {
+        using elem_type = std::ranges::range_reference_t<Range>;
+        if constexpr (tuple_like_row<elem_type>) {
+            constexpr auto size = std::tuple_size_v<std::remove_cvref_t<elem_type>>;
+            _column_value(ctx, col, std::make_index_sequence<size>{});
+        } else {
+            assign_result(ctx, _current());
+        }
+    }
+};
+
+class table_fn_base {
+    std::vector<std::string> _column_names;
+    int                      _arg_count = 0;
+
+protected:
+    table_fn_base(std::initializer_list<std::string_view> columns, int arg_count)
+        : _column_names(columns.begin(), columns.end())
+        , _arg_count(arg_count) {}
+
+public:
+    virtual ~table_fn_base() = default;
+
+    /// Generate the CREATE TABLE statement used to declare the virtual table
+    [[nodiscard]] std::string schema() const;
+
+    [[nodiscard]] int column_count() const noexcept {
+        return static_cast<int>(_column_names.size());
+    }
+    [[nodiscard]] int arg_count() const noexcept { return _arg_count; }
+
+    /// Invoke the function with `arg_count()` arguments
+    [[nodiscard]] virtual std::unique_ptr<table_fn_rows_base> invoke(sqlite3_value** argv) = 0;
+};
+
+template <typename Func, typename ArgTypesTag>
+class table_fn;
+
+template <typename Func, typename... ArgTypes>
+class table_fn<Func, neo::tag<ArgTypes...>> final : public table_fn_base {
+    Func _fn;
+
+    using result_type = std::invoke_result_t<Func&, ArgTypes...>;
+    using elem_type   = std::ranges::range_reference_t<result_type>;
+
+    static_assert(std::ranges::input_range<result_type>,
+                  "Table-valued functions must return an input range (or a generator)");
+
+    template <std::size_t... Is>
+    std::unique_ptr<table_fn_rows_base> _invoke(sqlite3_value** argv,
+                                                std::index_sequence<Is...>) {
+        return std::make_unique<table_fn_rows<result_type>>(
+            std::invoke(_fn, get_arg<std::remove_cvref_t<ArgTypes>>(argv[Is])...));
+    }
+
+public:
+    template <typename FuncArg>
+    table_fn(std::initializer_list<std::string_view> columns, FuncArg&& fn)
+        : table_fn_base(columns, static_cast<int>(sizeof...(ArgTypes)))
+        , _fn(NEO_FWD(fn)) {
+        if constexpr (tuple_like_row<elem_type>) {
+            neo_assert(expects,
+                       columns.size() == std::tuple_size_v<std::remove_cvref_t<elem_type>>,
+                       "The number of column names given for a table-valued function must match "
+                       "the size of the tuples that it generates",
+                       columns.size());
+        } else {
+            neo_assert(expects,
+                       columns.size() == 1,
+                       "A table-valued function that generates non-tuple values must have exactly "
+                       "one column",
+                       columns.size());
+        }
+    }
+
+    std::unique_ptr<table_fn_rows_base> invoke(sqlite3_value** argv) override {
+        return _invoke(argv, std::index_sequence_for<ArgTypes...>{});
+    }
+};
+
+void register_table_function(::sqlite3*                     db,
+                             neo::zstring_view              name,
+                             std::unique_ptr<table_fn_base> ptr);
+
+}  // namespace detail
+
+/**
+ * @brief Register a table-valued function implemented by a C++ callable.
+ *
+ * The parameters of the callable become hidden columns of an eponymous virtual table named `name`,
+ * and the callable must return an input range (which may be a lazy view or a coroutine-based
+ * generator). Rows are pulled from the range as the statement is stepped, so the results are never
+ * fully materialized. If the elements of the range are tuple-like, each tuple element is a column,
+ * otherwise each element is a single column.
+ *
+ * String and blob arguments are copied for the duration of the function's invocation, so the
+ * returned range may safely refer to them.
+ *
+ * Example:
+ *
+ *      db.register_table_function("squares", {"value", "square"}, [](std::int64_t start) {
+ *          return std::views::iota(start) | std::views::transform([](std::int64_t i) {
+ *                     return std::tuple{i, i * i};
+ *                 });
+ *      });
+ *      db.prepare("SELECT value, square FROM squares(1) LIMIT 10");
+ */
+template <typename Func>
+void connection_ref::register_table_function(neo::zstring_view                       name,
+                                             std::initializer_list<std::string_view> columns,
+                                             Func&&                                  fn) {
+    static_assert(neo::fixed_invocable<Func>,
+                  "Unable to infer the argument types of the function object. Did you pass a "
+                  "callable object? Argument type detection can fail if you passed a callable "
+                  "object with a generic/templated call operator (including as a closure from a "
+                  "generic lambda expression).");
+    using signature = neo::invocable_signature<Func>;
+    using argtypes  = typename signature::arg_types;
+    auto table_fn = std::make_unique<detail::table_fn<std::decay_t<Func>, argtypes>>(columns,
+                                                                                      NEO_FWD(fn));
+    detail::register_table_function(_ptr, name, std::move(table_fn));
+}
+
+}  // namespace neo::sqlite3
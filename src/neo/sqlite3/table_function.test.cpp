@@ -0,0 +1,96 @@
+#include <neo/sqlite3/table_function.hpp>
+
+#include <neo/sqlite3/exec.hpp>
+#include <neo/sqlite3/statement.hpp>
+
+#include "./tests.inl"
+
+#include <cstring>
+#include <ranges>
+#include <string>
+#include <tuple>
+#include <vector>
+
+TEST_CASE_METHOD(sqlite3_memory_db_fixture, "Split a string with a table-valued function") {
+    db.register_table_function("split", {"part"}, [](std::string_view str, std::string_view delim) {
+        std::vector<std::string> parts;
+        while (true) {
+            auto pos = str.find(delim);
+            parts.emplace_back(str.substr(0, pos));
+            if (pos == str.npos) {
+                break;
+            }
+            str.remove_prefix(pos + delim.size());
+        }
+        return parts;
+    });
+    auto st = *db.prepare("SELECT group_concat(part, '|') FROM split('foo,bar,baz', ',')");
+    CHECK(*neo::sqlite3::one_cell<std::string>(st) == "foo|bar|baz");
+
+    // The arguments can come from other tables
+    db.exec(R"(
+        CREATE TABLE csv (id, line);
+        INSERT INTO csv VALUES (1, 'a;b'), (2, 'c;d;e');
+    )")
+        .throw_if_error();
+    st = *db.prepare("SELECT count(*) FROM csv, split(csv.line, ';') WHERE csv.id = 2");
+    CHECK(*neo::sqlite3::one_cell<int>(st) == 3);
+}
+
+TEST_CASE_METHOD(sqlite3_memory_db_fixture, "Expand a packed array with multiple columns") {
+    db.register_table_function("unpack_i32",
+                               {"idx", "value"},
+                               [](neo::sqlite3::blob_view blob) {
+                                   std::vector<std::tuple<int, std::int32_t>> ret;
+                                   for (auto i = 0u; i * 4 < blob.size(); ++i) {
+                                       std::int32_t n = 0;
+                                       std::memcpy(&n, blob.data() + i * 4, sizeof n);
+                                       ret.emplace_back(static_cast<int>(i), n);
+                                   }
+                                   return ret;
+                               });
+    std::vector<std::int32_t> nums = {4, 8, 15, 16, 23, 42};
+    auto st = *db.prepare("SELECT sum(value), max(idx) FROM unpack_i32(?)");
+    auto [sum, max_idx] = *neo::sqlite3::one_row<int, int>(st, neo::sqlite3::blob_view(nums));
+    CHECK(sum == 108);
+    CHECK(max_idx == 5);
+}
+
+TEST_CASE_METHOD(sqlite3_memory_db_fixture, "Pull rows from a lazy range") {
+    int n_produced = 0;
+    db.register_table_function("squares", {"value", "square"}, [&](std::int64_t start) {
+        // The range is unbounded, so it could never be materialized
+        return std::views::iota(start) | std::views::transform([&](std::int64_t i) {
+                   ++n_produced;
+                   return std::tuple{i, i * i};
+               });
+    });
+    auto st = *db.prepare("SELECT sum(value), sum(square) FROM (SELECT * FROM squares(1) LIMIT 4)");
+    auto [sum, sum_squares] = *neo::sqlite3::one_row<int, int>(st);
+    CHECK(sum == 10);
+    CHECK(sum_squares == 30);
+    // Each row was produced once, and only the rows that were stepped over were produced
+    CHECK(n_produced == 4);
+}
+
+TEST_CASE_METHOD(sqlite3_memory_db_fixture, "Table-valued functions require their arguments") {
+    db.register_table_function("count_to", {"n"}, [](int n) { return std::views::iota(1, n + 1); });
+    auto st = *db.prepare("SELECT sum(n) FROM count_to(4)");
+    CHECK(*neo::sqlite3::one_cell<int>(st) == 10);
+    CHECK(db.prepare("SELECT * FROM count_to").is_error());
+}
+
+TEST_CASE_METHOD(sqlite3_memory_db_fixture, "Table-valued functions may throw any type") {
+    db.register_table_function("throws", {"n"}, [](int n) {
+        return std::views::iota(1, n + 1) | std::views::transform([](int i) {
+                   if (i == 3) {
+                       throw 42;
+                   }
+                   return i;
+               });
+    });
+    auto st = *db.prepare("SELECT sum(n) FROM throws(2)");
+    CHECK(*neo::sqlite3::one_cell<int>(st) == 3);
+    st = *db.prepare("SELECT sum(n) FROM throws(5)");
+    CHECK(st.step().is_error());
+}
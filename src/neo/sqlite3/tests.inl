@@ -2,7 +2,49 @@
 
 #include <catch2/catch.hpp>
 
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <system_error>
+
 class sqlite3_memory_db_fixture {
 public:
     neo::sqlite3::connection db = *neo::sqlite3::create_memory_db();
-};
\ No newline at end of file
+};
+
+/**
+ * @brief A path for a database file, in a new directory that is unique to the fixture. The
+ * directory and everything in it (e.g. journals and WALs) are removed when the fixture is
+ * destroyed, so every connection to the database must be closed by then.
+ */
+class sqlite3_temp_db_fixture {
+    static std::filesystem::path _create_dir() {
+        // Unique within the process by the counter, and between processes by the seed
+        static std::atomic<unsigned> counter{0};
+        static const auto            seed = std::random_device{}()
+            ^ static_cast<unsigned>(std::chrono::steady_clock::now().time_since_epoch().count());
+        const auto base = std::filesystem::temp_directory_path();
+        while (true) {
+            auto dir = base
+                / ("neo-sqlite3-test-" + std::to_string(seed) + "-" + std::to_string(++counter));
+            if (std::filesystem::create_directory(dir)) {
+                return dir;
+            }
+        }
+    }
+
+public:
+    const std::filesystem::path dir  = _create_dir();
+    const std::filesystem::path path = dir / "test.db";
+
+    sqlite3_temp_db_fixture()                               = default;
+    sqlite3_temp_db_fixture(const sqlite3_temp_db_fixture&) = delete;
+    sqlite3_temp_db_fixture& operator=(const sqlite3_temp_db_fixture&) = delete;
+
+    ~sqlite3_temp_db_fixture() {
+        std::error_code ec;
+        std::filesystem::remove_all(dir, ec);
+    }
+};
@@ -1,8 +1,10 @@
 #include "./transaction.hpp"
 
 #include <neo/sqlite3/connection.hpp>
+#include <neo/sqlite3/connection_state.hpp>
 #include <neo/sqlite3/statement.hpp>
 
+#include <neo/assert.hpp>
 #include <neo/event.hpp>
 
 #include <cstdio>
@@ -10,19 +12,45 @@
 
 using namespace neo::sqlite3;
 
-recursive_transaction_guard::recursive_transaction_guard(connection_ref db) {
+namespace {
+
+sql_string_literal begin_sql(transaction_mode mode) noexcept {
+    switch (mode) {
+    case transaction_mode::deferred:
+        return "BEGIN DEFERRED"_sql;
+    case transaction_mode::immediate:
+        return "BEGIN IMMEDIATE"_sql;
+    case transaction_mode::exclusive:
+        return "BEGIN EXCLUSIVE"_sql;
+    }
+    neo::unreachable();
+}
+
+void report_rollback_failure(const char* what, const std::exception& e) noexcept {
+    std::fputs("An exception occurred while rolling back a SQLite ", stderr);
+    std::fputs(what, stderr);
+    std::fputs(" due to another exception. The system may now be in an inconsistent state!\n",
+               stderr);
+    std::fputs("The exception message is '", stderr);
+    std::fputs(e.what(), stderr);
+    std::fputs("'\n", stderr);
+}
+
+}  // namespace
+
+recursive_transaction_guard::recursive_transaction_guard(connection_ref db, transaction_mode mode) {
     if (!db.is_transaction_active()) {
         // There is no active transaction, so we are the top-most transaction
         // guard. Create an inner transaction guard to track the transaction
-        _inner = transaction_guard(db);
+        _inner = transaction_guard(db, mode);
     }
 }
 
-transaction_guard::transaction_guard(connection_ref db)
+transaction_guard::transaction_guard(connection_ref db, transaction_mode mode)
     : _db(db.c_ptr()) {
     _n_uncaught_exceptions = std::uncaught_exceptions();
-    neo::emit(event::transaction_guard_begin{db});
-    db.prepare("BEGIN")->run_to_completion().throw_if_error();
+    neo::emit(event::transaction_guard_begin{db, mode});
+    detail::exec_cached(db, begin_sql(mode)).throw_if_error();
 }
 
 transaction_guard::~transaction_guard() noexcept(false) {
@@ -35,13 +63,7 @@ transaction_guard::~transaction_guard() noexcept(false) {
         try {
             rollback();
         } catch (const std::exception& e) {
-            std::fputs(
-                "An exception occurred while rolling back a SQLite transaction due to another "
-                "exception. The system may now be in an inconsistent state!\n",
-                stderr);
-            std::fputs("The exception message is '", stderr);
-            std::fputs(e.what(), stderr);
-            std::fputs("'\n", stderr);
+            report_rollback_failure("transaction", e);
         }
     } else {
         commit();
@@ -54,7 +76,7 @@ void transaction_guard::commit() {
                       "transaction_guard::commit() on ended (or dropped) transaction");
     connection_ref db{_db};
     neo::emit(event::transaction_guard_commit{db});
-    db.prepare("COMMIT")->run_to_completion().throw_if_error();
+    detail::exec_cached(db, "COMMIT"_sql).throw_if_error();
     drop();
 }
 
@@ -64,6 +86,56 @@ void transaction_guard::rollback() {
                       "transaction_guard::rollback() on an ended (or dropped) transaction");
     connection_ref db{_db};
     neo::emit(event::transaction_guard_rollback{db});
-    db.prepare("ROLLBACK")->run_to_completion().throw_if_error();
+    detail::exec_cached(db, "ROLLBACK"_sql).throw_if_error();
+    drop();
+}
+
+savepoint_guard::savepoint_guard(connection_ref db)
+    : _db(db.c_ptr()) {
+    _n_uncaught_exceptions = std::uncaught_exceptions();
+    neo::emit(event::savepoint_guard_begin{db});
+    // Nested savepoints may share a name: RELEASE and ROLLBACK TO use the most recent one
+    detail::exec_cached(db, "SAVEPOINT neo_sqlite3_savepoint"_sql).throw_if_error();
+}
+
+savepoint_guard::~savepoint_guard() noexcept(false) {
+    if (_db == nullptr) {
+        return;
+    }
+
+    bool is_failing = std::uncaught_exceptions() > _n_uncaught_exceptions;
+    if (is_failing) {
+        try {
+            rollback();
+        } catch (const std::exception& e) {
+            report_rollback_failure("savepoint", e);
+        }
+    } else {
+        release();
+    }
+}
+
+void savepoint_guard::release() {
+    neo_assert_always(expects,
+                      _db != nullptr,
+                      "savepoint_guard::release() on an ended (or dropped) savepoint");
+    connection_ref db{_db};
+    neo::emit(event::savepoint_guard_release{db});
+    detail::exec_cached(db, "RELEASE neo_sqlite3_savepoint"_sql).throw_if_error();
+    drop();
+}
+
+void savepoint_guard::rollback() {
+    neo_assert_always(expects,
+                      _db != nullptr,
+                      "savepoint_guard::rollback() on an ended (or dropped) savepoint");
+    connection_ref db{_db};
     drop();
+    if (!db.is_transaction_active()) {
+        // Some errors cause SQLite to roll back the entire transaction, including the savepoint
+        return;
+    }
+    neo::emit(event::savepoint_guard_rollback{db});
+    detail::exec_cached(db, "ROLLBACK TO neo_sqlite3_savepoint"_sql).throw_if_error();
+    detail::exec_cached(db, "RELEASE neo_sqlite3_savepoint"_sql).throw_if_error();
 }
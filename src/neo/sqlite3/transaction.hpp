@@ -9,10 +9,25 @@ namespace neo::sqlite3 {
 
 class connection_ref;
 
+/**
+ * @brief The locking behavior when a transaction begins.
+ *
+ * See https://sqlite.org/lang_transaction.html
+ */
+enum class transaction_mode {
+    /// BEGIN DEFERRED: Acquire locks when the database is first read or written
+    deferred,
+    /// BEGIN IMMEDIATE: Acquire the write lock immediately
+    immediate,
+    /// BEGIN EXCLUSIVE: Acquire the write lock immediately, and prevent readers in non-WAL modes
+    exclusive,
+};
+
 namespace event {
 
 struct transaction_guard_begin {
-    connection_ref& db;
+    connection_ref&  db;
+    transaction_mode mode;
 };
 
 struct transaction_guard_rollback {
@@ -23,12 +38,27 @@ struct transaction_guard_commit {
     connection_ref& db;
 };
 
+struct savepoint_guard_begin {
+    connection_ref& db;
+};
+
+struct savepoint_guard_release {
+    connection_ref& db;
+};
+
+struct savepoint_guard_rollback {
+    connection_ref& db;
+};
+
 }  // namespace event
 
 /**
  * @brief Scope-guard for database transactions.
  *
- * When constructed, executes BEGIN on the connection.
+ * When constructed, executes BEGIN on the connection, using the given transaction_mode.
+ *
+ * Connections opened with connection::open() keep the BEGIN, COMMIT, and ROLLBACK statements
+ * prepared, so starting and ending a transaction does not need to compile any SQL.
  *
  * When destroyed:
  *
@@ -47,7 +77,8 @@ class [[nodiscard]] transaction_guard {
 
 public:
     // Open a new transaction on the given connection
-    explicit transaction_guard(connection_ref db);
+    explicit transaction_guard(connection_ref   db,
+                               transaction_mode mode = transaction_mode::deferred);
     ~transaction_guard() noexcept(false);
 
     // Move a transaction-guard. The transaction now lives as long as the moved-to transaction
@@ -79,7 +110,8 @@ public:
  *
  * Behaves identically to transaction guard, except if a transaction is already
  * open on the connection when this object is constructed, then this object's
- * method become no-ops.
+ * method become no-ops. (The transaction_mode is only used when beginning a new
+ * transaction.)
  */
 class [[nodiscard]] recursive_transaction_guard {
     // We just wrap a transaction guard. This optional will only be engaged if
@@ -87,7 +119,8 @@ class [[nodiscard]] recursive_transaction_guard {
     std::optional<transaction_guard> _inner;
 
 public:
-    explicit recursive_transaction_guard(connection_ref db);
+    explicit recursive_transaction_guard(connection_ref   db,
+                                         transaction_mode mode = transaction_mode::deferred);
     ~recursive_transaction_guard() noexcept(false) {}
 
     /// COMMIT if we are the top-level transaction
@@ -121,4 +154,54 @@ public:
     [[nodiscard]] bool is_top_transaction() const noexcept { return _inner.has_value(); }
 };
 
+/**
+ * @brief Scope-guard for a SAVEPOINT, allowing a nested unit of work to be undone without
+ * undoing the enclosing transaction.
+ *
+ * When constructed, executes SAVEPOINT on the connection. If no transaction is active, this
+ * begins a new (deferred) transaction.
+ *
+ * When destroyed:
+ *
+ *  - If release(), rollback(), or drop() was called, does nothing.
+ *  - If there are no additional exceptions in-flight, executes a RELEASE, keeping the changes
+ *    made since the savepoint as part of the enclosing transaction (or committing them, if there
+ *    is no enclosing transaction).
+ *  - Otherwise, executes ROLLBACK TO followed by RELEASE, discarding only the changes made since
+ *    the savepoint.
+ *
+ * Savepoint guards may be nested within each other and within a transaction_guard, but must be
+ * destroyed in the reverse order of their construction.
+ */
+class [[nodiscard]] savepoint_guard {
+    int        _n_uncaught_exceptions = 0;
+    ::sqlite3* _db                    = nullptr;
+
+public:
+    explicit savepoint_guard(connection_ref db);
+    ~savepoint_guard() noexcept(false);
+
+    savepoint_guard(savepoint_guard&& other) noexcept
+        : _n_uncaught_exceptions(other._n_uncaught_exceptions)
+        , _db(std::exchange(other._db, nullptr)) {}
+
+    savepoint_guard& operator=(savepoint_guard&& other) noexcept {
+        std::swap(_n_uncaught_exceptions, other._n_uncaught_exceptions);
+        std::swap(_db, other._db);
+        return *this;
+    }
+
+    /// Immediately RELEASE the savepoint, keeping its changes. (Expects: !dropped())
+    void release();
+    /// Immediately discard the changes since the savepoint, and RELEASE it. (Expects: !dropped())
+    void rollback();
+    /// Drop ownership of the savepoint. It is now up to the caller to RELEASE or ROLLBACK TO
+    void drop() noexcept { _db = nullptr; }
+
+    /**
+     * @brief Check whether release(), rollback(), or drop() has been called.
+     */
+    [[nodiscard]] bool dropped() const noexcept { return _db == nullptr; }
+};
+
 }  // namespace neo::sqlite3
@@ -1,8 +1,12 @@
 #include <neo/sqlite3/error.hpp>
+#include <neo/sqlite3/exec.hpp>
 #include <neo/sqlite3/transaction.hpp>
 
 #include "./tests.inl"
 
+#include <sqlite3/sqlite3.h>
+
+
 TEST_CASE_METHOD(sqlite3_memory_db_fixture, "Create and drop a simple transaction") {
     CHECK_FALSE(db.is_transaction_active());
     {
@@ -60,3 +64,85 @@ TEST_CASE_METHOD(sqlite3_memory_db_fixture, "Nested non-recursive transactions t
     }
     CHECK_FALSE(db.is_transaction_active());
 }
+
+TEST_CASE_METHOD(sqlite3_temp_db_fixture, "Immediate transactions take the write lock up-front") {
+    auto db1 = *neo::sqlite3::open(path.string());
+    auto db2 = *neo::sqlite3::open(path.string());
+    db1.exec("CREATE TABLE foo (bar INTEGER)").throw_if_error();
+    {
+        neo::sqlite3::transaction_guard tr{db1, neo::sqlite3::transaction_mode::immediate};
+        // A deferred transaction does not need the write lock to begin
+        neo::sqlite3::transaction_guard reader{db2};
+        reader.rollback();
+        CHECK_THROWS_AS(
+            neo::sqlite3::transaction_guard(db2, neo::sqlite3::transaction_mode::immediate),
+            neo::sqlite3::busy_error);
+    }
+    CHECK_NOTHROW(neo::sqlite3::transaction_guard(db2, neo::sqlite3::transaction_mode::exclusive));
+    // Close the connections before removing the file
+}
+
+TEST_CASE_METHOD(sqlite3_memory_db_fixture, "Transaction control statements are reused") {
+    auto count_statements = [&] {
+        int  n  = 0;
+        auto st = ::sqlite3_next_stmt(db.c_ptr(), nullptr);
+        while (st) {
+            ++n;
+            st = ::sqlite3_next_stmt(db.c_ptr(), st);
+        }
+        return n;
+    };
+    { neo::sqlite3::transaction_guard tr{db}; }
+    { neo::sqlite3::transaction_guard tr{db}; }
+    // BEGIN and COMMIT
+    CHECK(count_statements() == 2);
+    {
+        neo::sqlite3::transaction_guard tr{db};
+        tr.rollback();
+    }
+    { neo::sqlite3::transaction_guard tr{db}; }
+    // Plus ROLLBACK
+    CHECK(count_statements() == 3);
+}
+
+TEST_CASE_METHOD(sqlite3_memory_db_fixture, "Savepoints discard only nested work") {
+    db.exec("CREATE TABLE foo (bar INTEGER)").throw_if_error();
+    auto count = *db.prepare("SELECT count(*) FROM foo");
+    {
+        neo::sqlite3::transaction_guard tr{db};
+        db.exec("INSERT INTO foo VALUES (1)").throw_if_error();
+        try {
+            neo::sqlite3::savepoint_guard sp{db};
+            db.exec("INSERT INTO foo VALUES (2)").throw_if_error();
+            throw std::runtime_error("Abandon the savepoint");
+        } catch (const std::runtime_error&) {
+        }
+        // The first insert is still part of the transaction
+        CHECK(db.is_transaction_active());
+        CHECK(*neo::sqlite3::one_cell<int>(count) == 1);
+        {
+            neo::sqlite3::savepoint_guard sp1{db};
+            db.exec("INSERT INTO foo VALUES (3)").throw_if_error();
+            {
+                neo::sqlite3::savepoint_guard sp2{db};
+                db.exec("INSERT INTO foo VALUES (4)").throw_if_error();
+                sp2.rollback();
+                CHECK(sp2.dropped());
+            }
+        }
+    }
+    CHECK_FALSE(db.is_transaction_active());
+    CHECK(*neo::sqlite3::one_cell<int>(count) == 2);
+}
+
+TEST_CASE_METHOD(sqlite3_memory_db_fixture, "A savepoint outside of a transaction") {
+    db.exec("CREATE TABLE foo (bar INTEGER)").throw_if_error();
+    {
+        neo::sqlite3::savepoint_guard sp{db};
+        CHECK(db.is_transaction_active());
+        db.exec("INSERT INTO foo VALUES (1)").throw_if_error();
+    }
+    CHECK_FALSE(db.is_transaction_active());
+    auto count = *db.prepare("SELECT count(*) FROM foo");
+    CHECK(*neo::sqlite3::one_cell<int>(count) == 1);
+}
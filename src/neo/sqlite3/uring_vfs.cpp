@@ -0,0 +1,856 @@
+#include "./uring_vfs.hpp"
+
+#include <sqlite3/sqlite3.h>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter) \
+    && defined(__NR_io_uring_register)
+#define NEO_SQLITE3_HAVE_IO_URING 1
+#endif
+#endif
+
+#ifndef NEO_SQLITE3_HAVE_IO_URING
+#define NEO_SQLITE3_HAVE_IO_URING 0
+#endif
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace neo::sqlite3;
+
+uring_vfs::uring_vfs(uring_vfs_options opts)
+    : vfs_shim(opts.name, opts.base)
+    , _opts(std::move(opts)) {
+    // Leave room for the read-ahead windows in each queue
+    _opts.queue_depth = (std::max)(_opts.queue_depth, 8u);
+    _enabled          = supported();
+}
+
+uring_vfs::~uring_vfs() = default;
+
+uring_vfs_stats uring_vfs::stats() const noexcept {
+    uring_vfs_stats ret;
+    ret.n_write_batches     = _n_write_batches.load(std::memory_order_relaxed);
+    ret.n_writes            = _n_writes.load(std::memory_order_relaxed);
+    ret.n_readahead_windows = _n_readahead_windows.load(std::memory_order_relaxed);
+    ret.n_readahead_hits    = _n_readahead_hits.load(std::memory_order_relaxed);
+    return ret;
+}
+
+#if NEO_SQLITE3_HAVE_IO_URING
+
+namespace {
+
+/**
+ * @brief A minimal io_uring, driven by the raw system calls. Submissions are only consumed by the
+ * kernel during enter() (there is no submission-polling thread).
+ */
+class ring {
+    int      _fd      = -1;
+    unsigned _entries = 0;
+
+    void*           _sq_map      = MAP_FAILED;
+    std::size_t     _sq_map_size = 0;
+    void*           _cq_map      = MAP_FAILED;
+    std::size_t     _cq_map_size = 0;
+    ::io_uring_sqe* _sqes        = nullptr;
+    std::size_t     _sqes_size   = 0;
+
+    unsigned*       _sq_tail  = nullptr;
+    unsigned*       _sq_mask  = nullptr;
+    unsigned*       _sq_array = nullptr;
+    unsigned*       _cq_head  = nullptr;
+    unsigned*       _cq_tail  = nullptr;
+    unsigned*       _cq_mask  = nullptr;
+    ::io_uring_cqe* _cqes     = nullptr;
+
+    /// The number of SQEs that have been prepared, but not yet consumed by the kernel
+    unsigned _to_submit = 0;
+    /// The number of SQEs that have been prepared, but whose completions have not been reaped
+    unsigned _inflight = 0;
+
+    ring() = default;
+
+    template <typename T>
+    T* at(void* map, std::uint32_t offset) noexcept {
+        return reinterpret_cast<T*>(static_cast<char*>(map) + offset);
+    }
+
+public:
+    ring(const ring&) = delete;
+    ring& operator=(const ring&) = delete;
+
+    ~ring() {
+        if (_sqes) {
+            ::munmap(_sqes, _sqes_size);
+        }
+        if (_cq_map != MAP_FAILED && _cq_map != _sq_map) {
+            ::munmap(_cq_map, _cq_map_size);
+        }
+        if (_sq_map != MAP_FAILED) {
+            ::munmap(_sq_map, _sq_map_size);
+        }
+        if (_fd >= 0) {
+            ::close(_fd);
+        }
+    }
+
+    static std::unique_ptr<ring> create(unsigned entries) noexcept {
+        ::io_uring_params params{};
+        auto              fd = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+        if (fd < 0) {
+            return nullptr;
+        }
+        std::unique_ptr<ring> r{new (std::nothrow) ring};
+        if (!r) {
+            ::close(fd);
+            return nullptr;
+        }
+        r->_fd      = fd;
+        r->_entries = params.sq_entries;
+
+        r->_sq_map_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        r->_cq_map_size = params.cq_off.cqes + params.cq_entries * sizeof(::io_uring_cqe);
+        const bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+        if (single_mmap) {
+            r->_sq_map_size = r->_cq_map_size = (std::max)(r->_sq_map_size, r->_cq_map_size);
+        }
+        constexpr auto prot  = PROT_READ | PROT_WRITE;
+        constexpr auto flags = MAP_SHARED | MAP_POPULATE;
+        r->_sq_map = ::mmap(nullptr, r->_sq_map_size, prot, flags, fd, IORING_OFF_SQ_RING);
+        if (r->_sq_map == MAP_FAILED) {
+            return nullptr;
+        }
+        r->_cq_map = single_mmap
+            ? r->_sq_map
+            : ::mmap(nullptr, r->_cq_map_size, prot, flags, fd, IORING_OFF_CQ_RING);
+        if (r->_cq_map == MAP_FAILED) {
+            return nullptr;
+        }
+        r->_sqes_size = params.sq_entries * sizeof(::io_uring_sqe);
+        auto sqes     = ::mmap(nullptr, r->_sqes_size, prot, flags, fd, IORING_OFF_SQES);
+        if (sqes == MAP_FAILED) {
+            return nullptr;
+        }
+        r->_sqes = static_cast<::io_uring_sqe*>(sqes);
+
+        r->_sq_tail  = r->at<unsigned>(r->_sq_map, params.sq_off.tail);
+        r->_sq_mask  = r->at<unsigned>(r->_sq_map, params.sq_off.ring_mask);
+        r->_sq_array = r->at<unsigned>(r->_sq_map, params.sq_off.array);
+        r->_cq_head  = r->at<unsigned>(r->_cq_map, params.cq_off.head);
+        r->_cq_tail  = r->at<unsigned>(r->_cq_map, params.cq_off.tail);
+        r->_cq_mask  = r->at<unsigned>(r->_cq_map, params.cq_off.ring_mask);
+        r->_cqes     = r->at<::io_uring_cqe>(r->_cq_map, params.cq_off.cqes);
+        return r;
+    }
+
+    /**
+     * @brief Whether the kernel supports each of the given operations. Kernels that are too old to
+     * be asked (before Linux 5.6) support none of the operations that are used here.
+     */
+    [[nodiscard]] bool supports(std::initializer_list<int> ops) const noexcept {
+        constexpr unsigned n_probe_ops = 256;
+        alignas(::io_uring_probe) std::byte
+            buf[sizeof(::io_uring_probe) + n_probe_ops * sizeof(::io_uring_probe_op)]{};
+        auto probe = reinterpret_cast<::io_uring_probe*>(buf);
+        if (::syscall(__NR_io_uring_register, _fd, IORING_REGISTER_PROBE, probe, n_probe_ops)
+            != 0) {
+            return false;
+        }
+        return std::ranges::all_of(ops, [&](int op) {
+            return op <= probe->last_op && (probe->ops[op].flags & IO_URING_OP_SUPPORTED);
+        });
+    }
+
+    [[nodiscard]] unsigned capacity() const noexcept { return _entries; }
+    [[nodiscard]] unsigned inflight() const noexcept { return _inflight; }
+
+    /**
+     * @brief Prepare a new submission. Returns null if the queue is full. The completion queue is
+     * twice the size of the submission queue, so limiting the number of operations in flight to
+     * the size of the submission queue means that completions are never dropped.
+     */
+    ::io_uring_sqe* next_sqe() noexcept {
+        if (_inflight >= _entries) {
+            return nullptr;
+        }
+        const auto tail = *_sq_tail;
+        const auto idx  = tail & *_sq_mask;
+        auto       sqe  = &_sqes[idx];
+        std::memset(sqe, 0, sizeof *sqe);
+        _sq_array[idx] = idx;
+        // The kernel only reads the entry during enter(), after the caller has filled it in
+        std::atomic_ref<unsigned>(*_sq_tail).store(tail + 1, std::memory_order_release);
+        ++_to_submit;
+        ++_inflight;
+        return sqe;
+    }
+
+    /**
+     * @brief Submit the prepared entries, and wait for at least `min_complete` completions to be
+     * available. Returns zero, or a negative errno value.
+     */
+    int enter(unsigned min_complete) noexcept {
+        while (true) {
+            const unsigned flags = min_complete ? IORING_ENTER_GETEVENTS : 0;
+            auto           rc
+                = ::syscall(__NR_io_uring_enter, _fd, _to_submit, min_complete, flags, nullptr, 0);
+            if (rc < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return -errno;
+            }
+            _to_submit -= (std::min)(_to_submit, static_cast<unsigned>(rc));
+            if (_to_submit == 0) {
+                return 0;
+            }
+        }
+    }
+
+    /// Invoke `fn(user_data, res)` for each available completion
+    template <typename Func>
+    void reap(Func&& fn) noexcept {
+        auto       head = *_cq_head;
+        const auto tail = std::atomic_ref<unsigned>(*_cq_tail).load(std::memory_order_acquire);
+        for (; head != tail; ++head) {
+            const auto& cqe = _cqes[head & *_cq_mask];
+            --_inflight;
+            fn(cqe.user_data, cqe.res);
+        }
+        std::atomic_ref<unsigned>(*_cq_head).store(head, std::memory_order_release);
+    }
+};
+
+/// Tags the user_data of read-ahead completions. The low bit is the index of the window
+constexpr std::uint64_t readahead_tag = std::uint64_t(1) << 63;
+
+/// A deferred write, which owns a copy of the written data
+struct pending_write {
+    std::int64_t           offset;
+    std::vector<std::byte> data;
+    bool                   done = false;
+    int                    res  = 0;
+};
+
+/// A buffer that holds an extent of a file that was read ahead of the reader
+struct readahead_window {
+    std::unique_ptr<std::byte[]> buf;
+    std::int64_t                 offset    = 0;
+    std::size_t                  requested = 0;
+    std::size_t                  size      = 0;
+    /// The read has been submitted, but has not completed
+    bool inflight = false;
+    /// The buffer holds the content of the file from `offset` to `offset + size`
+    bool valid = false;
+    /// The file may have changed since the read was submitted, so its result must be discarded
+    bool discard = false;
+
+    [[nodiscard]] bool covers(std::int64_t off, int amount) const noexcept {
+        const auto len = inflight && !discard ? requested : (valid ? size : 0);
+        return off >= offset && off + amount <= offset + static_cast<std::int64_t>(len);
+    }
+};
+
+/**
+ * @brief Writes that were submitted to a ring that then failed. The kernel may still read their
+ * buffers, so they are never freed.
+ */
+struct abandoned_writes {
+    union {
+        std::vector<pending_write> writes;
+    };
+
+    abandoned_writes() noexcept
+        : writes() {}
+    ~abandoned_writes() {
+        if (writes.empty()) {
+            writes.~vector();
+        }
+    }
+};
+
+/// Each frame of a WAL is written as a header of this size, followed by the page
+constexpr int wal_frame_header_size = 24;
+
+/// Whether the given WAL frame header is that of a commit frame, which holds the size of the
+/// database after the commit in bytes 4..7 (the field is zero in other frames)
+bool is_commit_frame_header(const std::byte* header) noexcept {
+    return std::any_of(header + 4, header + 8, [](auto b) { return b != std::byte{0}; });
+}
+
+int write_errc(int err) noexcept { return err == ENOSPC ? SQLITE_FULL : SQLITE_IOERR_WRITE; }
+
+}  // namespace
+
+/**
+ * @brief The state of a file that is accelerated by a uring_vfs. Every method must be called with
+ * the mutex held.
+ */
+class neo::sqlite3::uring_file {
+public:
+    uring_vfs&            vfs;
+    std::mutex            mutex;
+    std::unique_ptr<ring> uring;
+    /// The descriptor of the file. See vfs_shim::file::posix_fd()
+    const int  fd;
+    const bool writable;
+    const bool is_wal;
+    const bool readahead_enabled;
+
+    /// Set once the file has been synced, after which writes are deferred
+    bool defer_writes = false;
+    /// Set if the ring failed. The file then passes every operation through
+    bool broken = false;
+    /// Set after the header of a commit frame is deferred. The writes are flushed with its page
+    bool committing = false;
+    /// An error from a flush that could not be reported to SQLite immediately
+    int deferred_rc = SQLITE_OK;
+
+    std::vector<pending_write> pending;
+    std::size_t                pending_bytes = 0;
+    abandoned_writes           abandoned;
+
+    std::int64_t                    next_sequential = -1;
+    int                             n_sequential    = 0;
+    std::array<readahead_window, 2> windows;
+
+    uring_file(uring_vfs&            v,
+               std::unique_ptr<ring> r,
+               int                   fd,
+               bool                  writable,
+               bool                  is_wal,
+               bool                  readahead)
+        : vfs(v)
+        , uring(std::move(r))
+        , fd(fd)
+        , writable(writable)
+        , is_wal(is_wal)
+        , readahead_enabled(readahead) {}
+
+    ~uring_file() {
+        if (!drain()) {
+            // The kernel may still write into the buffers of the windows
+            for (auto& w : windows) {
+                if (w.inflight) {
+                    static_cast<void>(w.buf.release());
+                }
+            }
+        }
+    }
+
+    struct ref : vfs_shim::file_state {
+        std::shared_ptr<uring_file> ptr;
+    };
+
+    static uring_file* of(vfs_shim::file& f) noexcept {
+        auto st = static_cast<ref*>(f.state());
+        return st ? st->ptr.get() : nullptr;
+    }
+
+    void on_completion(std::uint64_t user_data, int res) noexcept {
+        if (user_data & readahead_tag) {
+            auto& w    = windows[user_data & 1];
+            w.inflight = false;
+            w.valid    = !w.discard && res > 0;
+            w.size     = w.valid ? static_cast<std::size_t>(res) : 0;
+            w.discard  = false;
+        } else if (user_data < pending.size()) {
+            pending[user_data].done = true;
+            pending[user_data].res  = res;
+        }
+    }
+
+    /// Handle every available completion. Returns the number of completions
+    unsigned reap() noexcept {
+        unsigned n = 0;
+        uring->reap([&](auto user_data, auto res) {
+            ++n;
+            on_completion(user_data, res);
+        });
+        return n;
+    }
+
+    /// Whether a failure of io_uring_enter is transient, and the call should be repeated
+    static bool is_transient(int rc) noexcept {
+        // The kernel is short of resources, or the completion queue is full
+        return rc == -EAGAIN || rc == -EBUSY;
+    }
+
+    /// Submit the prepared entries without waiting. Returns false if the ring has failed
+    bool submit() noexcept {
+        while (!broken) {
+            const auto rc = uring->enter(0);
+            if (rc == 0) {
+                return true;
+            } else if (!is_transient(rc)) {
+                broken = true;
+            } else {
+                reap();
+                std::this_thread::yield();
+            }
+        }
+        return false;
+    }
+
+    /// Wait for one or more completions. Returns false if the ring has failed
+    bool wait_one() noexcept {
+        while (!broken) {
+            const auto rc = uring->enter(1);
+            if (rc == 0) {
+                reap();
+                return true;
+            } else if (!is_transient(rc)) {
+                broken = true;
+            } else if (reap() != 0) {
+                // Reaping to make room provided the completion that was waited for
+                return true;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+        return false;
+    }
+
+    /// Wait for every operation in flight
+    bool drain() noexcept {
+        while (uring->inflight() != 0) {
+            if (!wait_one()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /// Submit the deferred writes, and wait for them to complete
+    int flush() noexcept {
+        committing = false;
+        if (pending.empty()) {
+            return std::exchange(deferred_rc, SQLITE_OK);
+        }
+        std::size_t n_submitted = 0;
+        for (auto i = 0u; i < pending.size() && !broken; ++i) {
+            auto sqe = uring->next_sqe();
+            if (!sqe) {
+                break;
+            }
+            auto& w        = pending[i];
+            sqe->opcode    = IORING_OP_WRITE;
+            sqe->fd        = fd;
+            sqe->addr      = reinterpret_cast<std::uintptr_t>(w.data.data());
+            sqe->len       = static_cast<std::uint32_t>(w.data.size());
+            sqe->off       = static_cast<std::uint64_t>(w.offset);
+            sqe->user_data = i;
+            ++n_submitted;
+        }
+        if (n_submitted != 0) {
+            vfs._n_write_batches.fetch_add(1, std::memory_order_relaxed);
+            vfs._n_writes.fetch_add(n_submitted, std::memory_order_relaxed);
+        }
+        auto remaining = [&] {
+            for (auto i = 0u; i < n_submitted; ++i) {
+                if (!pending[i].done) {
+                    return true;
+                }
+            }
+            return false;
+        };
+        while (remaining() && wait_one()) {
+        }
+
+        auto writes = &pending;
+        if (remaining()) {
+            // The ring failed with writes in flight. The kernel may still read their buffers, so
+            // they are abandoned rather than freed. (The ring only fails once, after which
+            // nothing is submitted, so no writes have been abandoned before.)
+            abandoned.writes.swap(pending);
+            writes = &abandoned.writes;
+        }
+
+        int rc = std::exchange(deferred_rc, SQLITE_OK);
+        for (auto& w : *writes) {
+            if (!w.done) {
+                // Never submitted, or the ring failed. Write it synchronously
+                w.res = 0;
+            }
+            if (w.res < 0) {
+                rc = write_errc(-w.res);
+                continue;
+            }
+            // Finish a short write
+            auto done = static_cast<std::size_t>(w.res);
+            while (done < w.data.size()) {
+                auto n = ::pwrite(fd,
+                                  w.data.data() + done,
+                                  w.data.size() - done,
+                                  w.offset + static_cast<std::int64_t>(done));
+                if (n < 0 && errno == EINTR) {
+                    continue;
+                } else if (n <= 0) {
+                    rc = write_errc(errno);
+                    break;
+                }
+                done += static_cast<std::size_t>(n);
+            }
+        }
+        pending.clear();
+        pending_bytes = 0;
+        return rc;
+    }
+
+    void invalidate_readahead() noexcept {
+        for (auto& w : windows) {
+            w.valid   = false;
+            w.discard = w.inflight;
+        }
+        next_sequential = -1;
+        n_sequential    = 0;
+    }
+
+    void start_readahead(std::int64_t offset, std::size_t idx) noexcept {
+        for (auto& w : windows) {
+            if ((w.valid || (w.inflight && !w.discard)) && w.offset == offset) {
+                // Already read, or being read
+                return;
+            }
+        }
+        auto& w = windows[idx];
+        if (w.inflight) {
+            return;
+        }
+        const auto n_bytes = vfs.options().readahead_bytes;
+        if (!w.buf) {
+            w.buf.reset(new (std::nothrow) std::byte[n_bytes]);
+            if (!w.buf) {
+                return;
+            }
+        }
+        auto sqe = uring->next_sqe();
+        if (!sqe) {
+            return;
+        }
+        sqe->opcode    = IORING_OP_READ;
+        sqe->fd        = fd;
+        sqe->addr      = reinterpret_cast<std::uintptr_t>(w.buf.get());
+        sqe->len       = static_cast<std::uint32_t>(n_bytes);
+        sqe->off       = static_cast<std::uint64_t>(offset);
+        sqe->user_data = readahead_tag | idx;
+        w.inflight     = true;
+        w.valid        = false;
+        w.discard      = false;
+        w.offset       = offset;
+        w.requested    = n_bytes;
+        if (!submit()) {
+            return;
+        }
+        vfs._n_readahead_windows.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    int read(vfs_shim::file& f, void* buf, int amount, std::int64_t offset) noexcept {
+        if (auto rc = flush()) {
+            return rc;
+        }
+        if (!readahead_enabled || broken) {
+            return f.read(buf, amount, offset);
+        }
+        for (auto idx = 0u; idx < windows.size(); ++idx) {
+            auto& w = windows[idx];
+            if (!w.covers(offset, amount)) {
+                continue;
+            }
+            while (w.inflight && wait_one()) {
+            }
+            if (broken || w.inflight) {
+                // The ring failed before the window was filled
+                return f.read(buf, amount, offset);
+            }
+            if (!w.covers(offset, amount)) {
+                continue;
+            }
+            std::memcpy(buf, w.buf.get() + (offset - w.offset), static_cast<std::size_t>(amount));
+            vfs._n_readahead_hits.fetch_add(1, std::memory_order_relaxed);
+            next_sequential = offset + amount;
+            // Stay one window ahead of the reader
+            const auto w_end = w.offset + static_cast<std::int64_t>(w.size);
+            if (w.size == w.requested && offset + amount > w.offset + std::int64_t(w.size / 2)) {
+                start_readahead(w_end, idx ^ 1);
+            }
+            return SQLITE_OK;
+        }
+        auto rc = f.read(buf, amount, offset);
+        if (rc != SQLITE_OK) {
+            return rc;
+        }
+        n_sequential    = offset == next_sequential ? n_sequential + 1 : 0;
+        next_sequential = offset + amount;
+        if (n_sequential >= vfs.options().readahead_trigger) {
+            start_readahead(next_sequential, windows[0].inflight ? 1 : 0);
+        }
+        return rc;
+    }
+
+    int write(vfs_shim::file& f, const void* buf, int amount, std::int64_t offset) noexcept {
+        invalidate_readahead();
+        if (!defer_writes || broken || !writable) {
+            if (auto rc = flush()) {
+                return rc;
+            }
+            return f.write(buf, amount, offset);
+        }
+        // Writes in the same batch may complete in any order, so they must not overlap
+        const auto overlaps = std::ranges::any_of(pending, [&](auto& w) {
+            return offset < w.offset + std::int64_t(w.data.size()) && w.offset < offset + amount;
+        });
+        if (overlaps || pending.size() + windows.size() >= uring->capacity()) {
+            if (auto rc = flush()) {
+                return rc;
+            }
+        }
+        auto bytes = static_cast<const std::byte*>(buf);
+        // A commit must not be reported as successful before its frames are written, since other
+        // connections may read them as soon as SQLite publishes the new end of the WAL (which
+        // cannot fail). The writes of the transaction are flushed with the page of its commit
+        // frame, so that any error is returned by that write.
+        const bool is_frame_header = is_wal && amount == wal_frame_header_size;
+        const bool ends_commit     = committing && !is_frame_header;
+        if (is_frame_header) {
+            committing = is_commit_frame_header(bytes);
+        }
+        try {
+            if (!pending.empty()
+                && pending.back().offset + std::int64_t(pending.back().data.size()) == offset) {
+                // Merge with the preceding write
+                auto& data = pending.back().data;
+                data.insert(data.end(), bytes, bytes + amount);
+            } else {
+                pending.push_back(pending_write{offset, {bytes, bytes + amount}});
+            }
+        } catch (const std::bad_alloc&) {
+            if (auto rc = flush()) {
+                return rc;
+            }
+            return f.write(buf, amount, offset);
+        }
+        pending_bytes += static_cast<std::size_t>(amount);
+        if (ends_commit || pending_bytes >= vfs.options().max_pending_write_bytes) {
+            return flush();
+        }
+        return SQLITE_OK;
+    }
+};
+
+int uring_vfs::on_open(file& f) noexcept {
+    const auto kind = f.kind();
+    if (!_enabled || !f.path() || (kind != file_kind::main_db && kind != file_kind::wal)) {
+        return SQLITE_OK;
+    }
+    auto r  = ring::create(_opts.queue_depth);
+    auto fd = r ? f.posix_fd() : -1;
+    if (fd < 0) {
+        // Pass through instead
+        return SQLITE_OK;
+    }
+    const bool writable  = f.posix_fd_writable();
+    const bool is_wal    = kind == file_kind::wal;
+    const bool readahead = kind == file_kind::main_db && _opts.readahead_bytes != 0;
+    try {
+        auto ref = std::make_unique<uring_file::ref>();
+        ref->ptr
+            = std::make_shared<uring_file>(*this, std::move(r), fd, writable, is_wal, readahead);
+        f.set_state(std::move(ref));
+    } catch (const std::bad_alloc&) {
+        // Pass through instead
+    }
+    return SQLITE_OK;
+}
+
+int uring_vfs::close(file& f) noexcept {
+    auto uf = uring_file::of(f);
+    if (!uf) {
+        return f.close();
+    }
+    int rc = SQLITE_OK;
+    {
+        std::lock_guard lk{uf->mutex};
+        rc = uf->flush();
+        uf->invalidate_readahead();
+        uf->drain();
+    }
+    auto close_rc = f.close();
+    return rc ? rc : close_rc;
+}
+
+int uring_vfs::read(file& f, void* buf, int amount, std::int64_t offset) noexcept {
+    auto uf = uring_file::of(f);
+    if (!uf) {
+        return f.read(buf, amount, offset);
+    }
+    std::lock_guard lk{uf->mutex};
+    return uf->read(f, buf, amount, offset);
+}
+
+int uring_vfs::write(file& f, const void* buf, int amount, std::int64_t offset) noexcept {
+    auto uf = uring_file::of(f);
+    if (!uf) {
+        return f.write(buf, amount, offset);
+    }
+    std::lock_guard lk{uf->mutex};
+    return uf->write(f, buf, amount, offset);
+}
+
+int uring_vfs::truncate(file& f, std::int64_t size) noexcept {
+    auto uf = uring_file::of(f);
+    if (!uf) {
+        return f.truncate(size);
+    }
+    std::lock_guard lk{uf->mutex};
+    uf->invalidate_readahead();
+    if (auto rc = uf->flush()) {
+        return rc;
+    }
+    return f.truncate(size);
+}
+
+int uring_vfs::sync(file& f, int flags) noexcept {
+    auto uf = uring_file::of(f);
+    if (!uf) {
+        return f.sync(flags);
+    }
+    std::lock_guard lk{uf->mutex};
+    uf->defer_writes = true;
+    if (auto rc = uf->flush()) {
+        return rc;
+    }
+    return f.sync(flags);
+}
+
+int uring_vfs::file_size(file& f, std::int64_t& size) noexcept {
+    auto uf = uring_file::of(f);
+    if (!uf) {
+        return f.file_size(size);
+    }
+    std::lock_guard lk{uf->mutex};
+    if (auto rc = uf->flush()) {
+        return rc;
+    }
+    return f.file_size(size);
+}
+
+int uring_vfs::lock(file& f, int level) noexcept {
+    auto uf = uring_file::of(f);
+    if (!uf) {
+        return f.lock(level);
+    }
+    std::lock_guard lk{uf->mutex};
+    uf->invalidate_readahead();
+    if (auto rc = uf->flush()) {
+        return rc;
+    }
+    return f.lock(level);
+}
+
+int uring_vfs::unlock(file& f, int level) noexcept {
+    auto uf = uring_file::of(f);
+    if (!uf) {
+        return f.unlock(level);
+    }
+    std::lock_guard lk{uf->mutex};
+    uf->invalidate_readahead();
+    if (auto rc = uf->flush()) {
+        return rc;
+    }
+    return f.unlock(level);
+}
+
+int uring_vfs::file_control(file& f, int op, void* arg) noexcept {
+    auto uf = uring_file::of(f);
+    if (!uf) {
+        return f.file_control(op, arg);
+    }
+    std::lock_guard lk{uf->mutex};
+    if (auto rc = uf->flush()) {
+        return rc;
+    }
+    return f.file_control(op, arg);
+}
+
+int uring_vfs::fetch(file& f, std::int64_t offset, int amount, void** pp) noexcept {
+    auto uf = uring_file::of(f);
+    if (!uf) {
+        return f.fetch(offset, amount, pp);
+    }
+    std::lock_guard lk{uf->mutex};
+    if (auto rc = uf->flush()) {
+        return rc;
+    }
+    return f.fetch(offset, amount, pp);
+}
+
+int uring_vfs::shm_lock(file& f, int offset, int n, int flags) noexcept {
+    // Transactions begin and end with a lock on the shared memory, and other connections may have
+    // checkpointed into the database file in between
+    if (auto uf = uring_file::of(f)) {
+        std::lock_guard lk{uf->mutex};
+        uf->invalidate_readahead();
+    }
+    return f.shm_lock(offset, n, flags);
+}
+
+bool uring_vfs::supported() noexcept {
+    static const bool ret = [] {
+        auto r = ring::create(4);
+        return r && r->supports({IORING_OP_READ, IORING_OP_WRITE});
+    }();
+    return ret;
+}
+
+#else
+
+// io_uring is not available, so every operation passes through to the base VFS
+
+int uring_vfs::on_open(file&) noexcept { return SQLITE_OK; }
+int uring_vfs::close(file& f) noexcept { return f.close(); }
+
+int uring_vfs::read(file& f, void* buf, int amount, std::int64_t offset) noexcept {
+    return f.read(buf, amount, offset);
+}
+
+int uring_vfs::write(file& f, const void* buf, int amount, std::int64_t offset) noexcept {
+    return f.write(buf, amount, offset);
+}
+
+int uring_vfs::truncate(file& f, std::int64_t size) noexcept { return f.truncate(size); }
+int uring_vfs::sync(file& f, int flags) noexcept { return f.sync(flags); }
+int uring_vfs::file_size(file& f, std::int64_t& size) noexcept { return f.file_size(size); }
+int uring_vfs::lock(file& f, int level) noexcept { return f.lock(level); }
+int uring_vfs::unlock(file& f, int level) noexcept { return f.unlock(level); }
+
+int uring_vfs::file_control(file& f, int op, void* arg) noexcept {
+    return f.file_control(op, arg);
+}
+
+int uring_vfs::fetch(file& f, std::int64_t offset, int amount, void** pp) noexcept {
+    return f.fetch(offset, amount, pp);
+}
+
+int uring_vfs::shm_lock(file& f, int offset, int n, int flags) noexcept {
+    return f.shm_lock(offset, n, flags);
+}
+
+bool uring_vfs::supported() noexcept { return false; }
+
+#endif
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <neo/sqlite3/vfs.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace neo::sqlite3 {
+
+class uring_file;
+
+/**
+ * @brief Options for a uring_vfs
+ */
+struct uring_vfs_options {
+    /// The name with which to register the VFS
+    std::string name = "neo-uring";
+    /// The name of the VFS to wrap. If empty, wraps the default VFS
+    std::string base;
+    /// The number of entries in the submission queue of each file
+    unsigned queue_depth = 64;
+    /// The size of each read-ahead window, in bytes. Zero disables read-ahead
+    std::size_t readahead_bytes = 256 * 1024;
+    /// The number of consecutive sequential reads of a database file that start read-ahead
+    int readahead_trigger = 4;
+    /// Submit the deferred writes of a file once they total this many bytes
+    std::size_t max_pending_write_bytes = 4 * 1024 * 1024;
+};
+
+/**
+ * @brief Counters of the I/O submitted through io_uring by a uring_vfs
+ */
+struct uring_vfs_stats {
+    /// The number of batches of writes that were submitted
+    std::uint64_t n_write_batches = 0;
+    /// The number of writes that were submitted (after merging adjacent writes)
+    std::uint64_t n_writes = 0;
+    /// The number of read-ahead windows that were submitted
+    std::uint64_t n_readahead_windows = 0;
+    /// The number of reads that were served from a read-ahead window
+    std::uint64_t n_readahead_hits = 0;
+};
+
+/**
+ * @brief A Linux VFS that submits the page I/O of database and WAL files through io_uring.
+ *
+ * - The writes of a transaction are deferred and submitted as a single batch (merging adjacent
+ *   writes) when SQLite syncs the file, or before any other operation on it. This turns the
+ *   page-at-a-time writes of a WAL commit or a checkpoint into one system call.
+ * - When a database file is read sequentially (e.g. by a table scan), the following extent of
+ *   the file is read asynchronously into a read-ahead window while the current one is consumed.
+ *   Read-ahead windows are discarded at the end of each transaction, and whenever the file is
+ *   written.
+ *
+ * Writes are only deferred for files that have been synced at least once, so a connection with
+ * `PRAGMA synchronous = OFF` writes through directly. In WAL mode, the writes of a transaction are
+ * also submitted (and waited for) when its commit frame is written, so that a failure to write
+ * them fails the commit, even if the WAL is not synced.
+ *
+ * Other operations, and all other files (journals, temporary files), pass through to the wrapped
+ * VFS. If io_uring is not available (on other platforms, on kernels older than Linux 5.6 that
+ * lack its read and write operations, or when it is denied by a seccomp policy) every operation
+ * passes through, and enabled() returns `false`.
+ *
+ * The VFS submits I/O on a second descriptor of each file (see vfs_shim::file::posix_fd()),
+ * which stays open for as long as the file exists.
+ */
+class uring_vfs : public vfs_shim {
+    uring_vfs_options _opts;
+    bool              _enabled = false;
+
+    std::atomic<std::uint64_t> _n_write_batches{0};
+    std::atomic<std::uint64_t> _n_writes{0};
+    std::atomic<std::uint64_t> _n_readahead_windows{0};
+    std::atomic<std::uint64_t> _n_readahead_hits{0};
+
+    friend class uring_file;
+
+protected:
+    int on_open(file& f) noexcept override;
+    int close(file& f) noexcept override;
+    int read(file& f, void* buf, int amount, std::int64_t offset) noexcept override;
+    int write(file& f, const void* buf, int amount, std::int64_t offset) noexcept override;
+    int truncate(file& f, std::int64_t size) noexcept override;
+    int sync(file& f, int flags) noexcept override;
+    int file_size(file& f, std::int64_t& size) noexcept override;
+    int lock(file& f, int level) noexcept override;
+    int unlock(file& f, int level) noexcept override;
+    int file_control(file& f, int op, void* arg) noexcept override;
+    int fetch(file& f, std::int64_t offset, int amount, void** pp) noexcept override;
+    int shm_lock(file& f, int offset, int n, int flags) noexcept override;
+
+public:
+    explicit uring_vfs(uring_vfs_options opts = {});
+    ~uring_vfs();
+
+    /// Determine whether io_uring can be used by this process
+    [[nodiscard]] static bool supported() noexcept;
+
+    /// Whether the VFS uses io_uring. If `false`, every operation passes through
+    [[nodiscard]] bool enabled() const noexcept { return _enabled; }
+
+    [[nodiscard]] const uring_vfs_options& options() const noexcept { return _opts; }
+
+    [[nodiscard]] uring_vfs_stats stats() const noexcept;
+};
+
+}  // namespace neo::sqlite3
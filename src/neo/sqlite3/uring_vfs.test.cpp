@@ -0,0 +1,76 @@
+#include <neo/sqlite3/exec.hpp>
+#include <neo/sqlite3/open_options.hpp>
+#include <neo/sqlite3/uring_vfs.hpp>
+
+#include "./tests.inl"
+
+TEST_CASE_METHOD(sqlite3_temp_db_fixture, "Write and read a database through io_uring") {
+    neo::sqlite3::uring_vfs vfs{{.name = "neo-uring-test", .readahead_bytes = 64 * 1024}};
+    CHECK(vfs.enabled() == neo::sqlite3::uring_vfs::supported());
+
+    auto journal_mode = GENERATE("WAL", "DELETE");
+    {
+        auto db = *neo::sqlite3::connection::open(path.string(),
+                                                  neo::sqlite3::open_options{.vfs = vfs.name()});
+        db.exec(std::string("PRAGMA journal_mode = ") + journal_mode).throw_if_error();
+        db.exec("PRAGMA synchronous = FULL").throw_if_error();
+        db.exec("CREATE TABLE foo (a INTEGER PRIMARY KEY, b BLOB)").throw_if_error();
+        for (auto i = 0; i < 10; ++i) {
+            db.exec(R"(
+                WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < 100)
+                INSERT INTO foo (b) SELECT randomblob(1000) FROM n
+            )")
+                .throw_if_error();
+        }
+        // Another connection (not using the VFS) sees every commit
+        auto other = *neo::sqlite3::open(path.string());
+        CHECK(*neo::sqlite3::one_cell<int>(*other.prepare("SELECT count(*) FROM foo")) == 1000);
+        CHECK(*neo::sqlite3::one_cell<std::string>(*other.prepare("PRAGMA integrity_check"))
+              == "ok");
+        db.exec("PRAGMA wal_checkpoint(TRUNCATE)").throw_if_error();
+        if (vfs.enabled()) {
+            CHECK(vfs.stats().n_write_batches > 0);
+            // Adjacent writes are merged
+            CHECK(vfs.stats().n_writes < 1000);
+        }
+    }
+
+    // A cold scan of the table reads it sequentially
+    auto db = *neo::sqlite3::connection::open(path.string(),
+                                              neo::sqlite3::open_options{.vfs = vfs.name()});
+    auto total = *neo::sqlite3::one_cell<std::int64_t>(
+        *db.prepare("SELECT sum(length(b)) FROM foo"));
+    CHECK(total == 1000 * 1000);
+    CHECK(*neo::sqlite3::one_cell<std::string>(*db.prepare("PRAGMA integrity_check")) == "ok");
+    if (vfs.enabled()) {
+        CHECK(vfs.stats().n_readahead_windows > 0);
+        CHECK(vfs.stats().n_readahead_hits > 0);
+    }
+}
+
+TEST_CASE_METHOD(sqlite3_temp_db_fixture, "Commit to a WAL that is not synced through io_uring") {
+    neo::sqlite3::uring_vfs vfs{{.name = "neo-uring-wal-test"}};
+
+    auto db = *neo::sqlite3::connection::open(path.string(),
+                                              neo::sqlite3::open_options{.vfs = vfs.name()});
+    db.exec(R"(
+        PRAGMA journal_mode = WAL;
+        PRAGMA synchronous = NORMAL;
+        CREATE TABLE foo (a INTEGER PRIMARY KEY, b BLOB);
+        INSERT INTO foo (b) VALUES (randomblob(1000));
+        PRAGMA wal_checkpoint;
+    )")
+        .throw_if_error();
+    // The WAL was synced by the checkpoint, so its writes are now deferred. Commits do not sync
+    // it, so the writes of each transaction are flushed with its commit frame
+    const auto n_batches = vfs.stats().n_write_batches;
+    auto       other     = *neo::sqlite3::open(path.string());
+    auto       count     = *other.prepare("SELECT count(*) FROM foo");
+    for (auto i = 0; i < 5; ++i) {
+        db.exec("INSERT INTO foo (b) VALUES (randomblob(1000))").throw_if_error();
+        CHECK(*neo::sqlite3::one_cell<int>(count) == i + 2);
+    }
+    if (vfs.enabled()) {
+        CHECK(vfs.stats().n_write_batches >= n_batches + 5);
+    }
+}
@@ -0,0 +1,292 @@
+#include "./vector_functions.hpp"
+
+#include <neo/sqlite3/function.hpp>
+
+#include <neo/ufmt.hpp>
+
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <optional>
+#include <stdexcept>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define NEO_SQLITE3_VEC_X86 1
+#include <immintrin.h>
+#else
+#define NEO_SQLITE3_VEC_X86 0
+#endif
+
+using namespace neo::sqlite3;
+
+namespace {
+
+using detail::dot_norms_result;
+using detail::vec_kernels;
+
+/// Load a float from a possibly-misaligned address
+float load_float(const std::byte* p, std::size_t idx) noexcept {
+    float f;
+    std::memcpy(&f, p + idx * sizeof(float), sizeof f);
+    return f;
+}
+
+float dot_scalar(const std::byte* a, const std::byte* b, std::size_t n) noexcept {
+    float acc = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        acc += load_float(a, i) * load_float(b, i);
+    }
+    return acc;
+}
+
+float l2_squared_scalar(const std::byte* a, const std::byte* b, std::size_t n) noexcept {
+    float acc = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        auto d = load_float(a, i) - load_float(b, i);
+        acc += d * d;
+    }
+    return acc;
+}
+
+dot_norms_result dot_norms_scalar(const std::byte* a, const std::byte* b, std::size_t n) noexcept {
+    dot_norms_result r;
+    for (std::size_t i = 0; i < n; ++i) {
+        auto x = load_float(a, i);
+        auto y = load_float(b, i);
+        r.ab += x * y;
+        r.aa += x * x;
+        r.bb += y * y;
+    }
+    return r;
+}
+
+constexpr vec_kernels scalar_kernels = {
+    "scalar",
+    &dot_scalar,
+    &l2_squared_scalar,
+    &dot_norms_scalar,
+};
+
+#if NEO_SQLITE3_VEC_X86
+
+const float* as_floats(const std::byte* p) noexcept { return reinterpret_cast<const float*>(p); }
+
+__attribute__((target("sse2"))) float hsum_sse(__m128 v) noexcept {
+    auto shuf = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1));
+    auto sums = _mm_add_ps(v, shuf);
+    shuf      = _mm_movehl_ps(shuf, sums);
+    sums      = _mm_add_ss(sums, shuf);
+    return _mm_cvtss_f32(sums);
+}
+
+__attribute__((target("sse2"))) float
+dot_sse(const std::byte* a_, const std::byte* b_, std::size_t n) noexcept {
+    auto        a    = as_floats(a_);
+    auto        b    = as_floats(b_);
+    auto        acc0 = _mm_setzero_ps();
+    auto        acc1 = _mm_setzero_ps();
+    std::size_t i    = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+    }
+    auto acc = hsum_sse(_mm_add_ps(acc0, acc1));
+    return acc + dot_scalar(a_ + i * sizeof(float), b_ + i * sizeof(float), n - i);
+}
+
+__attribute__((target("sse2"))) float
+l2_squared_sse(const std::byte* a_, const std::byte* b_, std::size_t n) noexcept {
+    auto        a    = as_floats(a_);
+    auto        b    = as_floats(b_);
+    auto        acc0 = _mm_setzero_ps();
+    auto        acc1 = _mm_setzero_ps();
+    std::size_t i    = 0;
+    for (; i + 8 <= n; i += 8) {
+        auto d0 = _mm_sub_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i));
+        auto d1 = _mm_sub_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4));
+        acc0    = _mm_add_ps(acc0, _mm_mul_ps(d0, d0));
+        acc1    = _mm_add_ps(acc1, _mm_mul_ps(d1, d1));
+    }
+    auto acc = hsum_sse(_mm_add_ps(acc0, acc1));
+    return acc + l2_squared_scalar(a_ + i * sizeof(float), b_ + i * sizeof(float), n - i);
+}
+
+__attribute__((target("sse2"))) dot_norms_result
+dot_norms_sse(const std::byte* a_, const std::byte* b_, std::size_t n) noexcept {
+    auto        a  = as_floats(a_);
+    auto        b  = as_floats(b_);
+    auto        ab = _mm_setzero_ps();
+    auto        aa = _mm_setzero_ps();
+    auto        bb = _mm_setzero_ps();
+    std::size_t i  = 0;
+    for (; i + 4 <= n; i += 4) {
+        auto x = _mm_loadu_ps(a + i);
+        auto y = _mm_loadu_ps(b + i);
+        ab     = _mm_add_ps(ab, _mm_mul_ps(x, y));
+        aa     = _mm_add_ps(aa, _mm_mul_ps(x, x));
+        bb     = _mm_add_ps(bb, _mm_mul_ps(y, y));
+    }
+    auto tail = dot_norms_scalar(a_ + i * sizeof(float), b_ + i * sizeof(float), n - i);
+    return {hsum_sse(ab) + tail.ab, hsum_sse(aa) + tail.aa, hsum_sse(bb) + tail.bb};
+}
+
+constexpr vec_kernels sse_kernels = {
+    "sse",
+    &dot_sse,
+    &l2_squared_sse,
+    &dot_norms_sse,
+};
+
+__attribute__((target("avx2,fma"))) float hsum_avx(__m256 v) noexcept {
+    return hsum_sse(_mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1)));
+}
+
+__attribute__((target("avx2,fma"))) float
+dot_avx2(const std::byte* a_, const std::byte* b_, std::size_t n) noexcept {
+    auto        a    = as_floats(a_);
+    auto        b    = as_floats(b_);
+    auto        acc0 = _mm256_setzero_ps();
+    auto        acc1 = _mm256_setzero_ps();
+    std::size_t i    = 0;
+    for (; i + 16 <= n; i += 16) {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+        acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8), acc1);
+    }
+    auto acc = hsum_avx(_mm256_add_ps(acc0, acc1));
+    return acc + dot_sse(a_ + i * sizeof(float), b_ + i * sizeof(float), n - i);
+}
+
+__attribute__((target("avx2,fma"))) float
+l2_squared_avx2(const std::byte* a_, const std::byte* b_, std::size_t n) noexcept {
+    auto        a    = as_floats(a_);
+    auto        b    = as_floats(b_);
+    auto        acc0 = _mm256_setzero_ps();
+    auto        acc1 = _mm256_setzero_ps();
+    std::size_t i    = 0;
+    for (; i + 16 <= n; i += 16) {
+        auto d0 = _mm256_sub_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i));
+        auto d1 = _mm256_sub_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8));
+        acc0    = _mm256_fmadd_ps(d0, d0, acc0);
+        acc1    = _mm256_fmadd_ps(d1, d1, acc1);
+    }
+    auto acc = hsum_avx(_mm256_add_ps(acc0, acc1));
+    return acc + l2_squared_sse(a_ + i * sizeof(float), b_ + i * sizeof(float), n - i);
+}
+
+__attribute__((target("avx2,fma"))) dot_norms_result
+dot_norms_avx2(const std::byte* a_, const std::byte* b_, std::size_t n) noexcept {
+    auto        a  = as_floats(a_);
+    auto        b  = as_floats(b_);
+    auto        ab = _mm256_setzero_ps();
+    auto        aa = _mm256_setzero_ps();
+    auto        bb = _mm256_setzero_ps();
+    std::size_t i  = 0;
+    for (; i + 8 <= n; i += 8) {
+        auto x = _mm256_loadu_ps(a + i);
+        auto y = _mm256_loadu_ps(b + i);
+        ab     = _mm256_fmadd_ps(x, y, ab);
+        aa     = _mm256_fmadd_ps(x, x, aa);
+        bb     = _mm256_fmadd_ps(y, y, bb);
+    }
+    auto tail = dot_norms_sse(a_ + i * sizeof(float), b_ + i * sizeof(float), n - i);
+    return {hsum_avx(ab) + tail.ab, hsum_avx(aa) + tail.aa, hsum_avx(bb) + tail.bb};
+}
+
+constexpr vec_kernels avx2_kernels = {
+    "avx2",
+    &dot_avx2,
+    &l2_squared_avx2,
+    &dot_norms_avx2,
+};
+
+#endif
+
+const vec_kernels& kernels() noexcept {
+    static const vec_kernels& k = *detail::available_vec_kernels().back();
+    return k;
+}
+
+/// Check that the given BLOBs are packed float vectors of equal length, and return that length
+std::size_t check_vectors(blob_view a, blob_view b) {
+    if (a.size() % sizeof(float) != 0 || b.size() % sizeof(float) != 0) {
+        throw std::invalid_argument(
+            "Vector BLOBs must contain packed float32 values (size must be a multiple of four)");
+    }
+    if (a.size() != b.size()) {
+        throw std::invalid_argument(neo::ufmt("Vector dimensions do not match ({} vs. {})",
+                                              a.size() / sizeof(float),
+                                              b.size() / sizeof(float)));
+    }
+    return a.size() / sizeof(float);
+}
+
+/// Adapt a binary vector function to SQL, propagating NULL arguments
+template <float (*Func)(blob_view, blob_view)>
+auto sql_binary() {
+    return [](value_ref a, value_ref b) -> std::optional<double> {
+        if (a.is_null() || b.is_null()) {
+            return std::nullopt;
+        }
+        return Func(a.as_blob(), b.as_blob());
+    };
+}
+
+}  // namespace
+
+float neo::sqlite3::vec_dot(blob_view a, blob_view b) {
+    auto n = check_vectors(a, b);
+    return kernels().dot(a.data(), b.data(), n);
+}
+
+float neo::sqlite3::vec_l2_squared(blob_view a, blob_view b) {
+    auto n = check_vectors(a, b);
+    return kernels().l2_squared(a.data(), b.data(), n);
+}
+
+float neo::sqlite3::vec_l2(blob_view a, blob_view b) { return std::sqrt(vec_l2_squared(a, b)); }
+
+float neo::sqlite3::vec_cosine(blob_view a, blob_view b) {
+    auto n = check_vectors(a, b);
+    auto r = kernels().dot_norms(a.data(), b.data(), n);
+    if (r.aa == 0 || r.bb == 0) {
+        return 1;
+    }
+    return 1 - r.ab / (std::sqrt(r.aa) * std::sqrt(r.bb));
+}
+
+float neo::sqlite3::vec_norm(blob_view a) {
+    auto n = check_vectors(a, a);
+    return std::sqrt(kernels().dot(a.data(), a.data(), n));
+}
+
+std::string_view neo::sqlite3::vec_kernel_isa() noexcept { return kernels().isa; }
+
+std::span<const vec_kernels* const> neo::sqlite3::detail::available_vec_kernels() noexcept {
+    static const auto available = [] {
+        std::array<const vec_kernels*, 3> ret = {&scalar_kernels};
+        std::size_t                       n   = 1;
+#if NEO_SQLITE3_VEC_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("sse2")) {
+            ret[n++] = &sse_kernels;
+        }
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+            ret[n++] = &avx2_kernels;
+        }
+#endif
+        return std::pair{ret, n};
+    }();
+    return std::span(available.first.data(), available.second);
+}
+
+void neo::sqlite3::register_vector_functions(connection_ref db) {
+    db.register_function("vec_dot", sql_binary<&vec_dot>());
+    db.register_function("vec_l2", sql_binary<&vec_l2>());
+    db.register_function("vec_cosine", sql_binary<&vec_cosine>());
+    db.register_function("vec_norm", [](value_ref a) -> std::optional<double> {
+        if (a.is_null()) {
+            return std::nullopt;
+        }
+        return vec_norm(a.as_blob());
+    });
+}
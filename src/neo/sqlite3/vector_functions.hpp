@@ -0,0 +1,82 @@
+#pragma once
+
+#include <neo/sqlite3/blob_view.hpp>
+
+#include <cstddef>
+#include <span>
+#include <string_view>
+
+namespace neo::sqlite3 {
+
+class connection_ref;
+
+/**
+ * @brief Register the `vec_*` family of SQL functions, which operate on vectors stored as BLOBs of
+ * packed native-endian `float32` values:
+ *
+ * - `vec_dot(a, b)` - The dot product of `a` and `b`
+ * - `vec_l2(a, b)` - The Euclidean distance between `a` and `b`
+ * - `vec_cosine(a, b)` - The cosine distance (1 - cosine similarity) between `a` and `b`
+ * - `vec_norm(a)` - The Euclidean length of `a`
+ *
+ * If any argument is NULL, the result is NULL. If the vectors have differing lengths, or a BLOB's
+ * size is not a multiple of four, an error is raised.
+ *
+ * Example:
+ *
+ *      register_vector_functions(db);
+ *      db.prepare("SELECT id FROM docs ORDER BY vec_cosine(embedding, ?) LIMIT 10");
+ */
+void register_vector_functions(connection_ref db);
+
+/**
+ * @brief The dot product of two packed float32 vectors.
+ *
+ * These functions are the kernels that implement the `vec_*` SQL functions. They use the widest
+ * SIMD instruction set supported by the CPU (detected at runtime), with a portable fallback. The
+ * given BLOBs need not be aligned.
+ *
+ * @throws std::invalid_argument if the vectors are of differing lengths, or if their sizes are
+ * not a multiple of `sizeof(float)`.
+ */
+[[nodiscard]] float vec_dot(blob_view a, blob_view b);
+/// The Euclidean distance between two packed float32 vectors
+[[nodiscard]] float vec_l2(blob_view a, blob_view b);
+/// The squared Euclidean distance between two packed float32 vectors. Cheaper than `vec_l2`
+[[nodiscard]] float vec_l2_squared(blob_view a, blob_view b);
+/// The cosine distance between two packed float32 vectors. If either vector is zero, returns 1
+[[nodiscard]] float vec_cosine(blob_view a, blob_view b);
+/// The Euclidean length of a packed float32 vector
+[[nodiscard]] float vec_norm(blob_view a);
+
+/**
+ * @brief Get the name of the instruction set used by the vector kernels on this CPU. One of "avx2",
+ * "sse", or "scalar".
+ */
+[[nodiscard]] std::string_view vec_kernel_isa() noexcept;
+
+namespace detail {
+
+/// The dot product and the squared norms of a pair of vectors, computed in a single pass
+struct dot_norms_result {
+    float ab = 0;
+    float aa = 0;
+    float bb = 0;
+};
+
+/// A set of kernels for one instruction set. Pointers need not be aligned. 'n' is the number of
+/// floats in each vector.
+struct vec_kernels {
+    std::string_view isa;
+    float (*dot)(const std::byte* a, const std::byte* b, std::size_t n) noexcept;
+    float (*l2_squared)(const std::byte* a, const std::byte* b, std::size_t n) noexcept;
+    dot_norms_result (*dot_norms)(const std::byte* a, const std::byte* b, std::size_t n) noexcept;
+};
+
+/// The kernel sets that can run on this CPU, from the narrowest (always the scalar kernels) to the
+/// widest
+[[nodiscard]] std::span<const vec_kernels* const> available_vec_kernels() noexcept;
+
+}  // namespace detail
+
+}  // namespace neo::sqlite3
@@ -0,0 +1,113 @@
+#include <neo/sqlite3/exec.hpp>
+#include <neo/sqlite3/vector_functions.hpp>
+
+#include "./tests.inl"
+
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <vector>
+
+using namespace neo::sqlite3;
+
+TEST_CASE("Vector kernels") {
+    INFO("Kernel ISA: " << vec_kernel_isa());
+    // Use an odd size so that the SIMD kernels must handle a remainder
+    std::vector<float> a(37), b(37);
+    std::iota(a.begin(), a.end(), 1.0f);
+    std::iota(b.begin(), b.end(), -10.0f);
+
+    double dot = 0, l2 = 0, na = 0, nb = 0;
+    for (auto i = 0u; i < a.size(); ++i) {
+        dot += a[i] * b[i];
+        l2 += (a[i] - b[i]) * (a[i] - b[i]);
+        na += a[i] * a[i];
+        nb += b[i] * b[i];
+    }
+    CHECK(vec_dot(blob_view(a), blob_view(b)) == Approx(dot));
+    CHECK(vec_l2(blob_view(a), blob_view(b)) == Approx(std::sqrt(l2)));
+    CHECK(vec_norm(blob_view(a)) == Approx(std::sqrt(na)));
+    CHECK(vec_cosine(blob_view(a), blob_view(b))
+          == Approx(1 - dot / (std::sqrt(na) * std::sqrt(nb))));
+    CHECK(vec_cosine(blob_view(a), blob_view(a)) == Approx(0).margin(1e-6));
+
+    // Misaligned data must also work
+    std::vector<std::byte> buf(a.size() * sizeof(float) + 1);
+    std::memcpy(buf.data() + 1, a.data(), a.size() * sizeof(float));
+    std::span<const std::byte> misaligned(buf.data() + 1, a.size() * sizeof(float));
+    CHECK(vec_dot(blob_view(misaligned), blob_view(b)) == Approx(dot));
+
+    std::vector<float> short_vec(3);
+    CHECK_THROWS_AS(vec_dot(blob_view(a), blob_view(short_vec)), std::invalid_argument);
+}
+
+TEST_CASE("Every vector kernel set agrees with the scalar kernels") {
+    auto all = detail::available_vec_kernels();
+    REQUIRE(all.size() >= 1);
+    const auto& scalar = *all[0];
+    CHECK(scalar.isa == "scalar");
+    CHECK(all.back()->isa == vec_kernel_isa());
+
+    // Vectors of every length up to several SIMD widths, misaligned by one byte, so that each
+    // kernel's main loop and each remainder path are exercised
+    std::vector<float> a(67), b(67);
+    for (auto i = 0u; i < a.size(); ++i) {
+        a[i] = std::sin(static_cast<float>(i)) * 3;
+        b[i] = std::cos(static_cast<float>(i) * 0.7f) - 1;
+    }
+    std::vector<std::byte> buf_a(a.size() * sizeof(float) + 1), buf_b(buf_a.size());
+    std::memcpy(buf_a.data() + 1, a.data(), a.size() * sizeof(float));
+    std::memcpy(buf_b.data() + 1, b.data(), b.size() * sizeof(float));
+    const auto pa = buf_a.data() + 1;
+    const auto pb = buf_b.data() + 1;
+
+    for (auto k : all) {
+        for (std::size_t n = 0; n <= a.size(); ++n) {
+            INFO("Kernel ISA: " << k->isa << ", n = " << n);
+            CHECK(k->dot(pa, pb, n) == Approx(scalar.dot(pa, pb, n)).margin(1e-4));
+            CHECK(k->l2_squared(pa, pb, n)
+                  == Approx(scalar.l2_squared(pa, pb, n)).margin(1e-4));
+            auto r = k->dot_norms(pa, pb, n);
+            auto s = scalar.dot_norms(pa, pb, n);
+            CHECK(r.ab == Approx(s.ab).margin(1e-4));
+            CHECK(r.aa == Approx(s.aa).margin(1e-4));
+            CHECK(r.bb == Approx(s.bb).margin(1e-4));
+        }
+    }
+}
+
+TEST_CASE_METHOD(sqlite3_memory_db_fixture, "Rank embeddings in SQL") {
+    register_vector_functions(db);
+    db.exec("CREATE TABLE docs (id INTEGER PRIMARY KEY, emb BLOB)").throw_if_error();
+    auto insert = *db.prepare("INSERT INTO docs (id, emb) VALUES (?, ?)");
+
+    std::vector<std::vector<float>> embeddings = {
+        {1, 0, 0},
+        {0, 1, 0},
+        {0.9f, 0.1f, 0},
+        {-1, 0, 0},
+    };
+    for (auto i = 0u; i < embeddings.size(); ++i) {
+        exec(insert, static_cast<int>(i + 1), blob_view(embeddings[i])).throw_if_error();
+    }
+
+    std::vector<float> query = {1, 0, 0};
+
+    auto st = *db.prepare("SELECT id FROM docs ORDER BY vec_cosine(emb, ?) LIMIT 2");
+    std::vector<int> ids;
+    auto             rows = *exec_tuples<int>(st, blob_view(query));
+    for (auto [id] : rows) {
+        ids.push_back(id);
+    }
+    CHECK(ids == std::vector<int>{1, 3});
+
+    auto l2 = *db.prepare("SELECT vec_l2(emb, ?) FROM docs WHERE id = 4");
+    CHECK(*one_cell<double>(l2, blob_view(query)) == Approx(2));
+    auto norm = *db.prepare("SELECT vec_norm(?)");
+    CHECK(*one_cell<double>(norm, blob_view(query)) == Approx(1));
+    auto dot = *db.prepare("SELECT vec_dot(emb, ?) IS NULL FROM docs WHERE id = 1");
+    CHECK(*one_cell<int>(dot, null));
+
+    auto bad = *db.prepare("SELECT vec_dot(x'00112233', x'0011')");
+    CHECK(bad.step().is_error());
+}
@@ -0,0 +1,495 @@
+#include "./vfs.hpp"
+
+#include <neo/sqlite3/error.hpp>
+
+#include <sqlite3/sqlite3.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace neo::sqlite3;
+
+namespace neo::sqlite3 {
+
+/// A file descriptor that is shared by every vfs_shim::file for the same file. See posix_fd()
+struct shared_posix_fd {
+    int  fd       = -1;
+    bool writable = false;
+#ifndef _WIN32
+    ::dev_t dev = 0;
+    ::ino_t ino = 0;
+
+    ~shared_posix_fd() {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+#endif
+};
+
+/**
+ * @brief The sqlite3_file of a vfs_shim. The file of the underlying VFS is allocated immediately
+ * after this object.
+ */
+struct vfs_shim_file {
+    ::sqlite3_file  base;
+    vfs_shim*       shim;
+    vfs_shim::file* file;
+};
+
+/// Trampolines from the SQLite C API to the virtual methods of vfs_shim
+struct vfs_shim_access {
+    /// The offset of the underlying file in each vfs_shim_file allocation
+    static constexpr std::size_t real_align = alignof(std::max_align_t);
+    static constexpr std::size_t real_offset
+        = (sizeof(vfs_shim_file) + real_align - 1) & ~(real_align - 1);
+
+    static vfs_shim& shim_of(::sqlite3_vfs* vfs) noexcept {
+        return *static_cast<vfs_shim*>(vfs->pAppData);
+    }
+
+    static vfs_shim_file& self(::sqlite3_file* f) noexcept {
+        return *reinterpret_cast<vfs_shim_file*>(f);
+    }
+
+    static vfs_shim::file& file_of(::sqlite3_file* f) noexcept { return *self(f).file; }
+
+    static ::sqlite3_file* real_of(::sqlite3_file* f) noexcept {
+        return reinterpret_cast<::sqlite3_file*>(reinterpret_cast<char*>(f) + real_offset);
+    }
+
+    static const ::sqlite3_io_methods* methods_for_version(int version) noexcept;
+
+    static int open(::sqlite3_vfs* vfs,
+                    const char*    path,
+                    ::sqlite3_file* f,
+                    int            flags,
+                    int*           out_flags) noexcept {
+        auto& shim = shim_of(vfs);
+        auto& sf   = self(f);
+        auto  real = real_of(f);
+
+        sf.base.pMethods = nullptr;
+        real->pMethods   = nullptr;
+        auto rc          = shim._base->xOpen(shim._base, path, real, flags, out_flags);
+        if (real->pMethods == nullptr) {
+            // Nothing was opened, and nothing needs to be closed
+            return rc;
+        }
+        sf.shim = &shim;
+        sf.file = new (std::nothrow) vfs_shim::file(real, path, flags);
+        if (!sf.file) {
+            real->pMethods->xClose(real);
+            return SQLITE_NOMEM;
+        }
+        sf.base.pMethods = methods_for_version(real->pMethods->iVersion);
+        if (rc != SQLITE_OK) {
+            // SQLite will still call xClose() on the file
+            return rc;
+        }
+        rc = shim.on_open(*sf.file);
+        if (rc != SQLITE_OK) {
+            close(f);
+        }
+        return rc;
+    }
+
+    static int close(::sqlite3_file* f) noexcept {
+        auto& sf = self(f);
+        auto  rc = sf.shim->close(*sf.file);
+        delete sf.file;
+        sf.file          = nullptr;
+        sf.base.pMethods = nullptr;
+        return rc;
+    }
+
+    static int read(::sqlite3_file* f, void* buf, int amount, ::sqlite3_int64 offset) noexcept {
+        return self(f).shim->read(file_of(f), buf, amount, offset);
+    }
+
+    static int
+    write(::sqlite3_file* f, const void* buf, int amount, ::sqlite3_int64 offset) noexcept {
+        return self(f).shim->write(file_of(f), buf, amount, offset);
+    }
+
+    static int truncate(::sqlite3_file* f, ::sqlite3_int64 size) noexcept {
+        return self(f).shim->truncate(file_of(f), size);
+    }
+
+    static int sync(::sqlite3_file* f, int flags) noexcept {
+        return self(f).shim->sync(file_of(f), flags);
+    }
+
+    static int file_size(::sqlite3_file* f, ::sqlite3_int64* size) noexcept {
+        std::int64_t s  = 0;
+        auto         rc = self(f).shim->file_size(file_of(f), s);
+        *size           = s;
+        return rc;
+    }
+
+    static int lock(::sqlite3_file* f, int level) noexcept {
+        return self(f).shim->lock(file_of(f), level);
+    }
+
+    static int unlock(::sqlite3_file* f, int level) noexcept {
+        return self(f).shim->unlock(file_of(f), level);
+    }
+
+    static int check_reserved_lock(::sqlite3_file* f, int* out) noexcept {
+        auto real = real_of(f);
+        return real->pMethods->xCheckReservedLock(real, out);
+    }
+
+    static int file_control(::sqlite3_file* f, int op, void* arg) noexcept {
+        return self(f).shim->file_control(file_of(f), op, arg);
+    }
+
+    static int sector_size(::sqlite3_file* f) noexcept {
+        auto real = real_of(f);
+        return real->pMethods->xSectorSize(real);
+    }
+
+    static int device_characteristics(::sqlite3_file* f) noexcept {
+        auto real = real_of(f);
+        return real->pMethods->xDeviceCharacteristics(real);
+    }
+
+    static int shm_map(::sqlite3_file* f, int page, int page_size, int extend, void volatile** pp) {
+        auto real = real_of(f);
+        return real->pMethods->xShmMap(real, page, page_size, extend, pp);
+    }
+
+    static int shm_lock(::sqlite3_file* f, int offset, int n, int flags) noexcept {
+        return self(f).shim->shm_lock(file_of(f), offset, n, flags);
+    }
+
+    static void shm_barrier(::sqlite3_file* f) noexcept {
+        self(f).shim->shm_barrier(file_of(f));
+    }
+
+    static int shm_unmap(::sqlite3_file* f, int delete_flag) noexcept {
+        auto real = real_of(f);
+        return real->pMethods->xShmUnmap(real, delete_flag);
+    }
+
+    static int fetch(::sqlite3_file* f, ::sqlite3_int64 offset, int amount, void** pp) noexcept {
+        return self(f).shim->fetch(file_of(f), offset, amount, pp);
+    }
+
+    static int unfetch(::sqlite3_file* f, ::sqlite3_int64 offset, void* p) noexcept {
+        auto real = real_of(f);
+        return real->pMethods->xUnfetch(real, offset, p);
+    }
+
+    // The remaining VFS methods are passed directly through to the base VFS
+
+    static ::sqlite3_vfs* base_of(::sqlite3_vfs* vfs) noexcept { return shim_of(vfs)._base; }
+
+    static int remove(::sqlite3_vfs* vfs, const char* path, int sync_dir) noexcept {
+        return base_of(vfs)->xDelete(base_of(vfs), path, sync_dir);
+    }
+
+    static int access(::sqlite3_vfs* vfs, const char* path, int flags, int* out) noexcept {
+        return base_of(vfs)->xAccess(base_of(vfs), path, flags, out);
+    }
+
+    static int full_pathname(::sqlite3_vfs* vfs, const char* path, int n, char* out) noexcept {
+        return base_of(vfs)->xFullPathname(base_of(vfs), path, n, out);
+    }
+
+    static void* dl_open(::sqlite3_vfs* vfs, const char* path) noexcept {
+        return base_of(vfs)->xDlOpen(base_of(vfs), path);
+    }
+
+    static void dl_error(::sqlite3_vfs* vfs, int n, char* out) noexcept {
+        base_of(vfs)->xDlError(base_of(vfs), n, out);
+    }
+
+    static void (*dl_sym(::sqlite3_vfs* vfs, void* lib, const char* sym) noexcept)(void) {
+        return base_of(vfs)->xDlSym(base_of(vfs), lib, sym);
+    }
+
+    static void dl_close(::sqlite3_vfs* vfs, void* lib) noexcept {
+        base_of(vfs)->xDlClose(base_of(vfs), lib);
+    }
+
+    static int randomness(::sqlite3_vfs* vfs, int n, char* out) noexcept {
+        return base_of(vfs)->xRandomness(base_of(vfs), n, out);
+    }
+
+    static int sleep(::sqlite3_vfs* vfs, int usec) noexcept {
+        return base_of(vfs)->xSleep(base_of(vfs), usec);
+    }
+
+    static int current_time(::sqlite3_vfs* vfs, double* out) noexcept {
+        return base_of(vfs)->xCurrentTime(base_of(vfs), out);
+    }
+
+    static int get_last_error(::sqlite3_vfs* vfs, int n, char* out) noexcept {
+        return base_of(vfs)->xGetLastError(base_of(vfs), n, out);
+    }
+
+    static int current_time_int64(::sqlite3_vfs* vfs, ::sqlite3_int64* out) noexcept {
+        return base_of(vfs)->xCurrentTimeInt64(base_of(vfs), out);
+    }
+
+    static int
+    set_system_call(::sqlite3_vfs* vfs, const char* name, ::sqlite3_syscall_ptr fn) noexcept {
+        return base_of(vfs)->xSetSystemCall(base_of(vfs), name, fn);
+    }
+
+    static ::sqlite3_syscall_ptr get_system_call(::sqlite3_vfs* vfs, const char* name) noexcept {
+        return base_of(vfs)->xGetSystemCall(base_of(vfs), name);
+    }
+
+    static const char* next_system_call(::sqlite3_vfs* vfs, const char* name) noexcept {
+        return base_of(vfs)->xNextSystemCall(base_of(vfs), name);
+    }
+};
+
+}  // namespace neo::sqlite3
+
+namespace {
+
+using access = neo::sqlite3::vfs_shim_access;
+
+constexpr ::sqlite3_io_methods make_io_methods(int version) {
+    return {
+        version,
+        &access::close,
+        &access::read,
+        &access::write,
+        &access::truncate,
+        &access::sync,
+        &access::file_size,
+        &access::lock,
+        &access::unlock,
+        &access::check_reserved_lock,
+        &access::file_control,
+        &access::sector_size,
+        &access::device_characteristics,
+        version >= 2 ? &access::shm_map : nullptr,
+        version >= 2 ? &access::shm_lock : nullptr,
+        version >= 2 ? &access::shm_barrier : nullptr,
+        version >= 2 ? &access::shm_unmap : nullptr,
+        version >= 3 ? &access::fetch : nullptr,
+        version >= 3 ? &access::unfetch : nullptr,
+    };
+}
+
+// The io_methods of a shim file must have the same version as those of the underlying file, so
+// that SQLite does not use shared memory or memory-mapping where the underlying file cannot
+constexpr ::sqlite3_io_methods io_methods_v1 = make_io_methods(1);
+constexpr ::sqlite3_io_methods io_methods_v2 = make_io_methods(2);
+constexpr ::sqlite3_io_methods io_methods_v3 = make_io_methods(3);
+
+}  // namespace
+
+const ::sqlite3_io_methods* vfs_shim_access::methods_for_version(int version) noexcept {
+    if (version <= 1) {
+        return &io_methods_v1;
+    } else if (version == 2) {
+        return &io_methods_v2;
+    } else {
+        return &io_methods_v3;
+    }
+}
+
+std::string_view neo::sqlite3::to_string(file_kind k) noexcept {
+    switch (k) {
+    case file_kind::main_db:
+        return "main_db";
+    case file_kind::wal:
+        return "wal";
+    case file_kind::journal:
+        return "journal";
+    case file_kind::temp:
+        return "temp";
+    case file_kind::other:
+        return "other";
+    }
+    return "<invalid file_kind>";
+}
+
+file_kind neo::sqlite3::file_kind_of_open_flags(int flags) noexcept {
+    if (flags & SQLITE_OPEN_MAIN_DB) {
+        return file_kind::main_db;
+    } else if (flags & SQLITE_OPEN_WAL) {
+        return file_kind::wal;
+    } else if (flags & (SQLITE_OPEN_MAIN_JOURNAL | SQLITE_OPEN_SUBJOURNAL
+                        | SQLITE_OPEN_SUPER_JOURNAL)) {
+        return file_kind::journal;
+    } else if (flags & (SQLITE_OPEN_TEMP_DB | SQLITE_OPEN_TEMP_JOURNAL
+                        | SQLITE_OPEN_TRANSIENT_DB)) {
+        return file_kind::temp;
+    }
+    return file_kind::other;
+}
+
+vfs_shim::vfs_shim(std::string_view name, std::string_view base)
+    : _name(name)
+    , _vfs(std::make_unique<::sqlite3_vfs>()) {
+    _base = ::sqlite3_vfs_find(base.empty() ? nullptr : std::string(base).data());
+    if (!_base) {
+        throw_error(make_error_code(errc::error), "No such VFS", std::string(base));
+    }
+    auto& v = *_vfs;
+    // Do not advertise methods that the base VFS does not have
+    v.iVersion      = std::min(_base->iVersion, 3);
+    v.szOsFile      = static_cast<int>(access::real_offset) + _base->szOsFile;
+    v.mxPathname    = _base->mxPathname;
+    v.zName         = _name.data();
+    v.pAppData      = this;
+    v.xOpen         = &access::open;
+    v.xDelete       = &access::remove;
+    v.xAccess       = &access::access;
+    v.xFullPathname = &access::full_pathname;
+    v.xDlOpen       = &access::dl_open;
+    v.xDlError      = &access::dl_error;
+    v.xDlSym        = &access::dl_sym;
+    v.xDlClose      = &access::dl_close;
+    v.xRandomness   = &access::randomness;
+    v.xSleep        = &access::sleep;
+    v.xCurrentTime  = &access::current_time;
+    v.xGetLastError = &access::get_last_error;
+    if (v.iVersion >= 2) {
+        v.xCurrentTimeInt64 = &access::current_time_int64;
+    }
+    if (v.iVersion >= 3) {
+        v.xSetSystemCall  = &access::set_system_call;
+        v.xGetSystemCall  = &access::get_system_call;
+        v.xNextSystemCall = &access::next_system_call;
+    }
+    auto rc = ::sqlite3_vfs_register(_vfs.get(), 0);
+    if (rc != SQLITE_OK) {
+        throw_error(to_error_code(rc), "Failed to register a VFS", _name);
+    }
+}
+
+vfs_shim::~vfs_shim() { ::sqlite3_vfs_unregister(_vfs.get()); }
+
+int vfs_shim::file::close() noexcept { return _real->pMethods->xClose(_real); }
+
+int vfs_shim::file::read(void* buf, int amount, std::int64_t offset) noexcept {
+    return _real->pMethods->xRead(_real, buf, amount, offset);
+}
+
+int vfs_shim::file::write(const void* buf, int amount, std::int64_t offset) noexcept {
+    return _real->pMethods->xWrite(_real, buf, amount, offset);
+}
+
+int vfs_shim::file::truncate(std::int64_t size) noexcept {
+    return _real->pMethods->xTruncate(_real, size);
+}
+
+int vfs_shim::file::sync(int flags) noexcept { return _real->pMethods->xSync(_real, flags); }
+
+int vfs_shim::file::file_size(std::int64_t& size) noexcept {
+    ::sqlite3_int64 s  = 0;
+    auto            rc = _real->pMethods->xFileSize(_real, &s);
+    size               = s;
+    return rc;
+}
+
+int vfs_shim::file::lock(int level) noexcept { return _real->pMethods->xLock(_real, level); }
+
+int vfs_shim::file::unlock(int level) noexcept { return _real->pMethods->xUnlock(_real, level); }
+
+int vfs_shim::file::file_control(int op, void* arg) noexcept {
+    return _real->pMethods->xFileControl(_real, op, arg);
+}
+
+int vfs_shim::file::fetch(std::int64_t offset, int amount, void** pp) noexcept {
+    return _real->pMethods->xFetch(_real, offset, amount, pp);
+}
+
+int vfs_shim::file::shm_lock(int offset, int n, int flags) noexcept {
+    return _real->pMethods->xShmLock(_real, offset, n, flags);
+}
+
+void vfs_shim::file::shm_barrier() noexcept { _real->pMethods->xShmBarrier(_real); }
+
+vfs_shim::file* vfs_shim::file::database_file() const noexcept {
+    if (!_path || (_kind != file_kind::wal && _kind != file_kind::journal)) {
+        return nullptr;
+    }
+    auto db = ::sqlite3_database_file_object(_path);
+    if (!db || !db->pMethods) {
+        return nullptr;
+    }
+    // The database is opened through the same VFS, so it is also a file of this shim
+    for (int version = 1; version <= 3; ++version) {
+        if (db->pMethods == vfs_shim_access::methods_for_version(version)) {
+            return &vfs_shim_access::file_of(db);
+        }
+    }
+    return nullptr;
+}
+
+#ifndef _WIN32
+
+int vfs_shim::file::posix_fd() noexcept {
+    if (_fd) {
+        return _fd->fd;
+    }
+    if (!_path) {
+        return -1;
+    }
+    // Closing a descriptor releases every POSIX lock that the process holds on the file,
+    // including those of connections that do not use a vfs_shim. Like the unix VFS of SQLite,
+    // descriptors are therefore kept open after the last file that uses them is closed, and are
+    // only closed once their file has been deleted (when no connection can be using it).
+    static std::mutex                                    mutex;
+    static std::vector<std::shared_ptr<shared_posix_fd>> fds;
+
+    struct ::stat st;
+    if (::stat(_path, &st) != 0) {
+        return -1;
+    }
+    std::lock_guard lk{mutex};
+    std::erase_if(fds, [](auto& fd) {
+        struct ::stat fd_st;
+        return fd.use_count() == 1 && ::fstat(fd->fd, &fd_st) == 0 && fd_st.st_nlink == 0;
+    });
+    for (auto& fd : fds) {
+        if (fd->dev == st.st_dev && fd->ino == st.st_ino) {
+            _fd = fd;
+            return _fd->fd;
+        }
+    }
+    try {
+        auto fd      = std::make_shared<shared_posix_fd>();
+        fd->fd       = ::open(_path, O_RDWR | O_CLOEXEC);
+        fd->writable = fd->fd >= 0;
+        if (fd->fd < 0) {
+            fd->fd = ::open(_path, O_RDONLY | O_CLOEXEC);
+        }
+        if (fd->fd < 0 || ::fstat(fd->fd, &st) != 0) {
+            return -1;
+        }
+        fd->dev = st.st_dev;
+        fd->ino = st.st_ino;
+        fds.push_back(fd);
+        _fd = std::move(fd);
+        return _fd->fd;
+    } catch (const std::bad_alloc&) {
+        return -1;
+    }
+}
+
+#else
+
+int vfs_shim::file::posix_fd() noexcept { return -1; }
+
+#endif
+
+bool vfs_shim::file::posix_fd_writable() const noexcept { return _fd && _fd->writable; }
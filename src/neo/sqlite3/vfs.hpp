@@ -0,0 +1,202 @@
+#pragma once
+
+#include "./errable_fwd.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+struct sqlite3_vfs;
+struct sqlite3_file;
+
+namespace neo::sqlite3 {
+
+struct shared_posix_fd;
+
+/**
+ * @brief The kinds of files that SQLite opens, as determined by the flags given to xOpen.
+ */
+enum class file_kind {
+    /// The main database file, or an attached database file
+    main_db,
+    /// The write-ahead log of a database
+    wal,
+    /// The rollback journal, statement sub-journal, or super-journal of a database
+    journal,
+    /// Temporary databases, their journals, and transient files (e.g. for sorting)
+    temp,
+    /// Any other file
+    other,
+};
+
+/// The number of enumerators of file_kind
+constexpr inline std::size_t n_file_kinds = 5;
+
+[[nodiscard]] std::string_view to_string(file_kind k) noexcept;
+
+/// Determine the kind of a file from the SQLITE_OPEN_* flags with which it was opened
+[[nodiscard]] file_kind file_kind_of_open_flags(int flags) noexcept;
+
+/**
+ * @brief Base class for "shim" VFSes, which wrap another VFS and intercept some of the I/O
+ * operations on the files opened through it.
+ *
+ * Every operation is passed through to the underlying VFS by default. A derived class overrides
+ * the virtual methods for the operations that it wants to observe or change, and calls the
+ * methods of the given vfs_shim::file to perform the underlying operation. Return values are
+ * SQLite result codes (SQLITE_OK, SQLITE_IOERR_*, etc).
+ *
+ * The VFS is registered with SQLite when the shim is constructed, and unregistered when it is
+ * destroyed. Select it by name when opening a connection (see open_options::vfs). Every
+ * connection using the VFS must be closed before the shim is destroyed.
+ */
+class vfs_shim {
+public:
+    /**
+     * @brief Extra per-file state of a derived shim. See file::set_state().
+     */
+    struct file_state {
+        virtual ~file_state() = default;
+    };
+
+    /**
+     * @brief A file opened through a vfs_shim. The methods perform the operation on the file of
+     * the underlying VFS.
+     */
+    class file {
+        ::sqlite3_file*                  _real;
+        const char*                      _path;
+        int                              _flags;
+        file_kind                        _kind;
+        std::shared_ptr<shared_posix_fd> _fd;
+        std::unique_ptr<file_state>      _state;
+
+    public:
+        file(::sqlite3_file* real, const char* path, int flags) noexcept
+            : _real(real)
+            , _path(path)
+            , _flags(flags)
+            , _kind(file_kind_of_open_flags(flags)) {}
+
+        /// The file of the underlying VFS
+        [[nodiscard]] ::sqlite3_file* real() const noexcept { return _real; }
+        /// The path to the file, or null for a temporary file with no name
+        [[nodiscard]] const char* path() const noexcept { return _path; }
+        /// The SQLITE_OPEN_* flags with which the file was opened
+        [[nodiscard]] int       open_flags() const noexcept { return _flags; }
+        [[nodiscard]] file_kind kind() const noexcept { return _kind; }
+
+        /**
+         * @brief For a WAL or rollback journal, the file of the database that it belongs to (which
+         * was opened through the same VFS by the same connection). Returns null for other files.
+         */
+        [[nodiscard]] file* database_file() const noexcept;
+
+        /// Attach extra state to the file, which is destroyed when the file is closed
+        void set_state(std::unique_ptr<file_state> st) noexcept { _state = std::move(st); }
+        [[nodiscard]] file_state* state() const noexcept { return _state.get(); }
+
+        /**
+         * @brief Get a POSIX file descriptor for the file, for operations that SQLite's VFS
+         * interface does not provide. Returns -1 if the file has no path, or cannot be opened, or
+         * on Windows.
+         *
+         * The descriptor is opened on first use, and is shared by every file opened through a
+         * vfs_shim in the process that refers to the same file. Closing any descriptor of a file
+         * releases every POSIX lock that the process holds on it (including the locks of
+         * connections that do not use a vfs_shim), so the descriptor is kept open for as long as
+         * the file exists, even after every shim file that used it has been closed.
+         */
+        [[nodiscard]] int posix_fd() noexcept;
+        /// Whether the descriptor returned by posix_fd() was opened for writing
+        [[nodiscard]] bool posix_fd_writable() const noexcept;
+
+        int close() noexcept;
+        int read(void* buf, int amount, std::int64_t offset) noexcept;
+        int write(const void* buf, int amount, std::int64_t offset) noexcept;
+        int truncate(std::int64_t size) noexcept;
+        int sync(int flags) noexcept;
+        int file_size(std::int64_t& size) noexcept;
+        int lock(int level) noexcept;
+        int unlock(int level) noexcept;
+        int file_control(int op, void* arg) noexcept;
+        int fetch(std::int64_t offset, int amount, void** pp) noexcept;
+
+        // The shared memory of a main database file in WAL mode
+        int  shm_lock(int offset, int n, int flags) noexcept;
+        void shm_barrier() noexcept;
+    };
+
+private:
+    std::string                    _name;
+    std::unique_ptr<::sqlite3_vfs> _vfs;
+    ::sqlite3_vfs*                 _base = nullptr;
+
+    friend struct vfs_shim_access;
+
+protected:
+    /**
+     * @brief Register a new VFS with the given name, wrapping the named VFS (or the default VFS,
+     * if `base` is empty).
+     *
+     * @throws neo::sqlite3::error if the base VFS does not exist, or registration fails
+     */
+    explicit vfs_shim(std::string_view name, std::string_view base = {});
+
+    /// Called after a file is opened successfully. If this fails, the file is closed again
+    virtual int on_open(file&) noexcept { return 0; }
+    /// Called when a file is closed. The default calls f.close()
+    virtual int close(file& f) noexcept { return f.close(); }
+
+    virtual int read(file& f, void* buf, int amount, std::int64_t offset) noexcept {
+        return f.read(buf, amount, offset);
+    }
+    virtual int write(file& f, const void* buf, int amount, std::int64_t offset) noexcept {
+        return f.write(buf, amount, offset);
+    }
+    virtual int truncate(file& f, std::int64_t size) noexcept { return f.truncate(size); }
+    virtual int sync(file& f, int flags) noexcept { return f.sync(flags); }
+    virtual int file_size(file& f, std::int64_t& size) noexcept { return f.file_size(size); }
+    virtual int lock(file& f, int level) noexcept { return f.lock(level); }
+    virtual int unlock(file& f, int level) noexcept { return f.unlock(level); }
+    virtual int file_control(file& f, int op, void* arg) noexcept {
+        return f.file_control(op, arg);
+    }
+    /**
+     * @brief Obtain a pointer to memory-mapped file content (only used if mmap_size is non-zero).
+     * Reads through the returned pointer bypass read(). To disable memory-mapped I/O for the
+     * file, set `*pp` to null and return SQLITE_OK.
+     */
+    virtual int fetch(file& f, std::int64_t offset, int amount, void** pp) noexcept {
+        return f.fetch(offset, amount, pp);
+    }
+    /**
+     * @brief Acquire or release a lock on the shared memory of a database in WAL mode. SQLite uses
+     * these locks to begin and end read and write transactions.
+     */
+    virtual int shm_lock(file& f, int offset, int n, int flags) noexcept {
+        return f.shm_lock(offset, n, flags);
+    }
+    /**
+     * @brief A memory barrier on the shared memory of a database in WAL mode. SQLite calls this
+     * immediately before it publishes a new WAL index header, i.e. before a commit or checkpoint
+     * becomes visible to other connections.
+     */
+    virtual void shm_barrier(file& f) noexcept { f.shm_barrier(); }
+
+public:
+    virtual ~vfs_shim();
+
+    vfs_shim(const vfs_shim&) = delete;
+    vfs_shim& operator=(const vfs_shim&) = delete;
+
+    /// The name with which the VFS is registered
+    [[nodiscard]] const std::string& name() const noexcept { return _name; }
+    /// The VFS object that is registered with SQLite
+    [[nodiscard]] ::sqlite3_vfs* c_ptr() const noexcept { return _vfs.get(); }
+    /// The VFS that is wrapped by this shim
+    [[nodiscard]] ::sqlite3_vfs* base() const noexcept { return _base; }
+};
+
+}  // namespace neo::sqlite3
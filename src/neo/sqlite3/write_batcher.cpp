@@ -0,0 +1,159 @@
+#include "./write_batcher.hpp"
+
+#include <neo/event.hpp>
+
+#include <stdexcept>
+
+using namespace neo::sqlite3;
+
+namespace {
+
+using clock = std::chrono::steady_clock;
+
+/// Reverse a list of operations that was taken from the stack, restoring submission order
+detail::write_op_base* reverse(detail::write_op_base* op) noexcept {
+    detail::write_op_base* prev = nullptr;
+    while (op) {
+        auto next = op->next;
+        op->next  = prev;
+        prev      = op;
+        op        = next;
+    }
+    return prev;
+}
+
+}  // namespace
+
+write_batcher::write_batcher(connection&& db, write_batcher_options opts)
+    : _db(std::move(db))
+    , _opts(opts) {
+    if (_opts.max_batch_size == 0) {
+        _opts.max_batch_size = 1;
+    }
+    _writer = std::thread{[this] { _run_writer(); }};
+}
+
+write_batcher::~write_batcher() {
+    {
+        std::unique_lock lk{_mutex};
+        _stopping = true;
+    }
+    _cv.notify_one();
+    _writer.join();
+}
+
+void write_batcher::_push(detail::write_op_base* op) noexcept {
+    auto head = _head.load(std::memory_order_relaxed);
+    do {
+        op->next = head;
+    } while (!_head.compare_exchange_weak(head,
+                                          op,
+                                          std::memory_order_release,
+                                          std::memory_order_relaxed));
+    if (head == nullptr) {
+        // The queue was empty, so the writer thread may be asleep. Taking the lock ensures that
+        // the writer is either waiting or has not yet checked the queue.
+        _mutex.lock();
+        _mutex.unlock();
+        _cv.notify_one();
+    }
+}
+
+void write_batcher::_run_writer() noexcept {
+    // Operations taken from the queue that have not yet been executed, in submission order
+    detail::write_op_base* pending      = nullptr;
+    detail::write_op_base* pending_tail = nullptr;
+    std::size_t            n_pending    = 0;
+
+    auto take_queued = [&] {
+        auto ops = reverse(_head.exchange(nullptr, std::memory_order_acquire));
+        for (; ops; ops = ops->next) {
+            if (pending_tail) {
+                pending_tail->next = ops;
+            } else {
+                pending = ops;
+            }
+            pending_tail = ops;
+            ++n_pending;
+        }
+    };
+    auto has_queued = [&] { return _head.load(std::memory_order_relaxed) != nullptr; };
+
+    while (true) {
+        if (n_pending == 0) {
+            std::unique_lock lk{_mutex};
+            _cv.wait(lk, [&] { return _stopping || has_queued(); });
+            if (!has_queued()) {
+                // We are stopping, and there is no more work
+                return;
+            }
+        }
+        take_queued();
+        // Wait a short time for more operations to join the batch
+        const auto deadline = clock::now() + _opts.max_delay;
+        while (n_pending < _opts.max_batch_size) {
+            std::unique_lock lk{_mutex};
+            if (!_cv.wait_until(lk, deadline, [&] { return _stopping || has_queued(); })
+                || _stopping) {
+                break;
+            }
+            lk.unlock();
+            take_queued();
+        }
+        take_queued();
+
+        // Split off the batch from the pending operations
+        auto batch      = pending;
+        auto batch_size = std::min(n_pending, _opts.max_batch_size);
+        auto last       = batch;
+        for (auto i = 1u; i < batch_size; ++i) {
+            last = last->next;
+        }
+        pending = last->next;
+        if (!pending) {
+            pending_tail = nullptr;
+        }
+        last->next = nullptr;
+        n_pending -= batch_size;
+
+        _flush(batch, batch_size);
+    }
+}
+
+void write_batcher::_flush(detail::write_op_base* ops, std::size_t count) noexcept {
+    const auto start = clock::now();
+    try {
+        transaction_guard tr{_db, _opts.mode};
+        for (auto op = ops; op; op = op->next) {
+            if (!_db.is_transaction_active()) {
+                // Some errors cause SQLite to roll back the entire transaction. Executing the
+                // remaining operations would commit each of them individually.
+                throw std::runtime_error(
+                    "The transaction of a write batch was rolled back by an earlier write");
+            }
+            op->run(_db);
+        }
+        tr.commit();
+    } catch (...) {
+        auto err = std::current_exception();
+        while (ops) {
+            auto next = ops->next;
+            ops->fail(err);
+            delete ops;
+            ops = next;
+        }
+        return;
+    }
+
+    while (ops) {
+        auto next = ops->next;
+        ops->complete();
+        delete ops;
+        ops = next;
+    }
+    try {
+        neo::emit(event::write_batch_commit{_db, count, clock::now() - start});
+    } catch (...) {
+        // There is nobody to report the error to
+    }
+}
@@ -0,0 +1,190 @@
+#pragma once
+
+#include <neo/sqlite3/connection.hpp>
+#include <neo/sqlite3/transaction.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+
+namespace neo::sqlite3 {
+
+namespace event {
+
+/**
+ * @brief Fired by the writer thread of a write_batcher after a batch has been committed
+ */
+struct write_batch_commit {
+    connection_ref& db;
+    /// The number of write operations in the batch, including those that failed
+    std::size_t size;
+    /// The time taken to execute and commit the batch
+    std::chrono::nanoseconds duration;
+};
+
+}  // namespace event
+
+/**
+ * @brief Options for a write_batcher
+ */
+struct write_batcher_options {
+    /// The maximum number of write operations that are committed together
+    std::size_t max_batch_size = 256;
+    /**
+     * @brief The maximum time to wait for more writes to arrive after the first write of a batch.
+     * Zero will only batch writes that were queued while the previous batch was being committed.
+     */
+    std::chrono::microseconds max_delay{1000};
+    /// The mode of the transaction for each batch
+    transaction_mode mode = transaction_mode::immediate;
+};
+
+namespace detail {
+
+/**
+ * @brief A queued write operation of a write_batcher
+ */
+class write_op_base {
+public:
+    /// Intrusive link to the next operation in the queue
+    write_op_base* next = nullptr;
+
+    virtual ~write_op_base() = default;
+
+    /// Execute the operation. Errors are kept until complete() is called
+    virtual void run(connection_ref db) noexcept = 0;
+    /// Resolve the future of the operation with the outcome of run()
+    virtual void complete() noexcept = 0;
+    /// Resolve the future with the given error, unless run() already failed with its own
+    virtual void fail(std::exception_ptr) noexcept = 0;
+};
+
+template <typename Func>
+class write_op final : public write_op_base {
+public:
+    using result_type = std::invoke_result_t<Func&, connection_ref>;
+
+private:
+    using stored_type = std::conditional_t<std::is_void_v<result_type>, bool, result_type>;
+
+    Func                       _fn;
+    std::promise<result_type>  _promise;
+    std::optional<stored_type> _result;
+    std::exception_ptr         _error;
+
+public:
+    template <typename F>
+    explicit write_op(F&& fn)
+        : _fn(std::forward<F>(fn)) {}
+
+    [[nodiscard]] std::future<result_type> get_future() { return _promise.get_future(); }
+
+    void run(connection_ref db) noexcept override {
+        try {
+            savepoint_guard sp{db};
+            try {
+                if constexpr (std::is_void_v<result_type>) {
+                    std::invoke(_fn, db);
+                    _result.emplace(true);
+                } else {
+                    _result.emplace(std::invoke(_fn, db));
+                }
+            } catch (...) {
+                _error = std::current_exception();
+                sp.rollback();
+                return;
+            }
+            sp.release();
+        } catch (...) {
+            // The savepoint itself failed. The batch will most likely fail to commit.
+            if (!_error) {
+                _error = std::current_exception();
+            }
+        }
+    }
+
+    void complete() noexcept override {
+        if (_error) {
+            _promise.set_exception(_error);
+        } else if constexpr (std::is_void_v<result_type>) {
+            _promise.set_value();
+        } else {
+            _promise.set_value(std::move(*_result));
+        }
+    }
+
+    void fail(std::exception_ptr e) noexcept override {
+        _promise.set_exception(_error ? _error : e);
+    }
+};
+
+}  // namespace detail
+
+/**
+ * @brief Group-commits small write operations from many threads.
+ *
+ * A write_batcher owns a connection and a writer thread. Write operations may be submitted from
+ * any thread, and the writer thread executes the queued operations in batches, each within a
+ * single transaction. This amortizes the cost of committing (and syncing) a transaction over many
+ * writes.
+ *
+ * Each operation is executed within a savepoint_guard, so an operation that throws an exception
+ * discards only its own changes, and the exception is delivered through its future. If a batch
+ * fails to commit, every operation in the batch fails with the exception from the commit.
+ *
+ * The future returned by submit() is resolved once the batch containing the operation has been
+ * committed, so the write is as durable as the `synchronous` setting of the connection allows.
+ *
+ * When destroyed, the write_batcher commits all operations that were already submitted, then
+ * joins the writer thread and closes the connection.
+ */
+class write_batcher {
+    connection            _db;
+    write_batcher_options _opts;
+
+    /// Lock-free stack of submitted operations, in reverse order of submission
+    std::atomic<detail::write_op_base*> _head{nullptr};
+    /// Used only to put the writer thread to sleep while there is no work
+    std::mutex              _mutex;
+    std::condition_variable _cv;
+    bool                    _stopping = false;
+
+    std::thread _writer;
+
+    void _push(detail::write_op_base* op) noexcept;
+    void _run_writer() noexcept;
+    void _flush(detail::write_op_base* ops, std::size_t count) noexcept;
+
+public:
+    explicit write_batcher(connection&& db, write_batcher_options opts = {});
+    ~write_batcher();
+
+    write_batcher(const write_batcher&) = delete;
+    write_batcher& operator=(const write_batcher&) = delete;
+
+    /**
+     * @brief Queue a write operation to be executed on the writer thread.
+     *
+     * @param fn An invocable that accepts a connection_ref. It MUST NOT begin or end transactions
+     * itself, and must not use statements that were prepared on other connections.
+     * @return A future that is resolved with the return value of `fn` (or its exception) once the
+     * batch containing the operation has been committed.
+     */
+    template <typename Func>
+    auto submit(Func&& fn) {
+        auto op  = new detail::write_op<std::decay_t<Func>>(std::forward<Func>(fn));
+        auto fut = op->get_future();
+        _push(op);
+        return fut;
+    }
+};
+
+}  // namespace neo::sqlite3
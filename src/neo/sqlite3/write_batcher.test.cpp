@@ -0,0 +1,81 @@
+#include <neo/sqlite3/exec.hpp>
+#include <neo/sqlite3/write_batcher.hpp>
+
+#include "./tests.inl"
+
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct batcher_fixture : sqlite3_temp_db_fixture {
+    batcher_fixture() {
+        auto db = *neo::sqlite3::open(path.string());
+        db.exec("CREATE TABLE foo (bar INTEGER)").throw_if_error();
+    }
+
+    int count_rows() {
+        auto db = *neo::sqlite3::open(path.string());
+        return *neo::sqlite3::one_cell<int>(*db.prepare("SELECT count(*) FROM foo"));
+    }
+};
+
+}  // namespace
+
+TEST_CASE_METHOD(batcher_fixture, "Submit writes from many threads") {
+    {
+        neo::sqlite3::write_batcher batcher{*neo::sqlite3::open(path.string())};
+        std::vector<std::thread>    threads;
+        for (auto i = 0; i < 8; ++i) {
+            threads.emplace_back([&] {
+                for (auto j = 0; j < 25; ++j) {
+                    auto fut = batcher.submit([](neo::sqlite3::connection_ref db) {
+                        db.exec("INSERT INTO foo VALUES (1)").throw_if_error();
+                        return db.last_insert_rowid();
+                    });
+                    CHECK(fut.get() > 0);
+                }
+            });
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+    }
+    CHECK(count_rows() == 200);
+}
+
+TEST_CASE_METHOD(batcher_fixture, "A failing write does not affect the rest of its batch") {
+    neo::sqlite3::write_batcher batcher{*neo::sqlite3::open(path.string()),
+                                        {.max_delay = std::chrono::milliseconds{50}}};
+    auto insert = [](neo::sqlite3::connection_ref db) {
+        db.exec("INSERT INTO foo VALUES (1)").throw_if_error();
+    };
+    auto f1 = batcher.submit(insert);
+    auto f2 = batcher.submit([&](neo::sqlite3::connection_ref db) {
+        insert(db);
+        throw std::runtime_error("oops");
+    });
+    auto f3 = batcher.submit(insert);
+    CHECK_NOTHROW(f1.get());
+    CHECK_THROWS_AS(f2.get(), std::runtime_error);
+    CHECK_NOTHROW(f3.get());
+    CHECK(count_rows() == 2);
+}
+
+TEST_CASE_METHOD(batcher_fixture, "Pending writes are committed on destruction") {
+    std::vector<std::future<void>> futures;
+    {
+        neo::sqlite3::write_batcher batcher{*neo::sqlite3::open(path.string()),
+                                            {.max_batch_size = 3}};
+        for (auto i = 0; i < 10; ++i) {
+            futures.push_back(batcher.submit([](neo::sqlite3::connection_ref db) {
+                db.exec("INSERT INTO foo VALUES (1)").throw_if_error();
+            }));
+        }
+    }
+    for (auto& fut : futures) {
+        CHECK_NOTHROW(fut.get());
+    }
+    CHECK(count_rows() == 10);
+}